@@ -234,6 +234,8 @@ struct SCXTApplicationWindow : juce::DocumentWindow, juce::Button::Listener
                                               int numOutputChannels, int numSamples,
                                               const AudioIODeviceCallbackContext &context) override
         {
+            // Before the midi below starts any voices, so the memory pool never grows here
+            scxt::engine::MemoryPool::isRealtimeThread = true;
             auto &main = window.engine->getPatch()->busses.mainBus.output;
 
             for (auto s = 0U; s < numSamples; ++s)
@@ -25,8 +25,10 @@
  * https://github.com/surge-synthesizer/shortcircuit-xt
  */
 
+#include <array>
 #include <cassert>
 #include <chrono>
+#include <cstring>
 
 #include "scxt-plugin.h"
 #include "version.h"
@@ -224,6 +226,9 @@ clap_process_status SCXTPlugin::process(const clap_process *process) noexcept
 #if BUILD_IS_DEBUG
     engine->getMessageController()->threadingChecker.registerAsAudioThread();
 #endif
+    // Before any events; a note on here starts processors, and the pool mustn't grow
+    scxt::engine::MemoryPool::isRealtimeThread = true;
+
     float **out = process->audio_outputs[0].data32;
     auto chans = process->audio_outputs->channel_count;
     if (chans != 2)
@@ -279,13 +284,43 @@ clap_process_status SCXTPlugin::process(const clap_process *process) noexcept
         nextEvent = ev->get(ev, nextEventIndex);
     }
 
-    for (auto s = 0U; s < process->frames_count; ++s)
+    /*
+     * Non-main outputs which nothing routes to are silent for the whole call, so
+     * clear them once and mark them constant rather than copying zeros each block.
+     */
+    auto nOutputPorts = std::min((uint32_t)process->audio_outputs_count,
+                                 (uint32_t)scxt::numNonMainPluginOutputs + 1);
+    std::array<bool, scxt::numNonMainPluginOutputs> outputInUse{};
+    for (uint32_t i = 0; i + 1 < nOutputPorts; ++i)
+    {
+        auto &ob = process->audio_outputs[i + 1];
+        outputInUse[i] = ptch->usesOutputBus(i + 1);
+        if (!outputInUse[i] && ob.data32)
+        {
+            for (uint32_t c = 0; c < ob.channel_count; ++c)
+                memset(ob.data32[c], 0, process->frames_count * sizeof(float));
+            ob.constant_mask = (1ULL << ob.channel_count) - 1;
+        }
+        else
+        {
+            ob.constant_mask = 0;
+        }
+    }
+
+    /*
+     * We walk the host buffer in chunks which end either at the end of an engine block
+     * or at the end of the host buffer. The engine renders in fixed blockSize blocks, so
+     * events are dispatched just before rendering the block which contains them, with
+     * their offset into it so new voices start on the right sample.
+     */
+    uint32_t s{0};
+    while (s < process->frames_count)
     {
         if (blockPos == 0)
         {
-            // Only realy need to run events when we do the block process
-            while (nextEvent && nextEvent->time <= s)
+            while (nextEvent && nextEvent->time < s + scxt::blockSize)
             {
+                engine->setEventSampleOffset((int32_t)nextEvent->time - (int32_t)s);
                 handleEvent(nextEvent);
                 nextEventIndex++;
                 if (nextEventIndex < sz)
@@ -359,29 +394,22 @@ clap_process_status SCXTPlugin::process(const clap_process *process) noexcept
             }
         }
 
-        // TODO: this can be way more efficient and block wise and stuff
-        out[0][s] = main[0][blockPos];
-        out[1][s] = main[1][blockPos];
-        for (int i = 0; i < scxt::numNonMainPluginOutputs; ++i)
+        auto chunk = std::min((uint32_t)(scxt::blockSize - blockPos), process->frames_count - s);
+        memcpy(out[0] + s, main[0] + blockPos, chunk * sizeof(float));
+        memcpy(out[1] + s, main[1] + blockPos, chunk * sizeof(float));
+        for (uint32_t i = 0; i + 1 < nOutputPorts; ++i)
         {
             float **pout = process->audio_outputs[i + 1].data32;
+            if (!pout || !outputInUse[i])
+                continue;
 
-            if (pout)
-            {
-                pout[0][s] = 0.f;
-                pout[1][s] = 0.f;
-            }
-            if (engine->getPatch()->usesOutputBus(i + 1))
-            {
-                if (pout)
-                {
-                    pout[0][s] = engine->getPatch()->busses.pluginNonMainOutputs[i][0][blockPos];
-                    pout[1][s] = engine->getPatch()->busses.pluginNonMainOutputs[i][0][blockPos];
-                }
-            }
+            auto &po = ptch->busses.pluginNonMainOutputs[i];
+            memcpy(pout[0] + s, po[0] + blockPos, chunk * sizeof(float));
+            memcpy(pout[1] + s, po[1] + blockPos, chunk * sizeof(float));
         }
 
-        blockPos = (blockPos + 1) & (scxt::blockSize - 1);
+        s += chunk;
+        blockPos = (blockPos + chunk) & (scxt::blockSize - 1);
     }
 
     // CLean up past-last-process events since we only sweep when processing in main loop to avoid
@@ -432,6 +460,7 @@ bool SCXTPlugin::handleEvent(const clap_event_header_t *nextEvent)
             engine->voiceManager.processNoteOffEvent(nevt->port_index, nevt->channel, nevt->key,
                                                      nevt->note_id, nevt->velocity);
         }
+        break;
 
         case CLAP_EVENT_PARAM_VALUE:
         {
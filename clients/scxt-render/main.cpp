@@ -0,0 +1,763 @@
+/*
+ * Shortcircuit XT - a Surge Synth Team product
+ *
+ * A fully featured creative sampler, available as a standalone
+ * and plugin for multiple platforms.
+ *
+ * Copyright 2019 - 2024, Various authors, as described in the github
+ * transaction log.
+ *
+ * ShortcircuitXT is released under the Gnu General Public Licence
+ * V3 or later (GPL-3.0-or-later). The license is found in the file
+ * "LICENSE" in the root of this repository or at
+ * https://www.gnu.org/licenses/gpl-3.0.en.html
+ *
+ * Individual sections of code which comprises ShortcircuitXT in this
+ * repository may also be used under an MIT license. Please see the
+ * section  "Licensing" in "README.md" for details.
+ *
+ * ShortcircuitXT is inspired by, and shares code with, the
+ * commercial product Shortcircuit 1 and 2, released by VemberTech
+ * in the mid 2000s. The code for Shortcircuit 2 was opensourced in
+ * 2020 at the outset of this project.
+ *
+ * All source for ShortcircuitXT is available at
+ * https://github.com/surge-synthesizer/shortcircuit-xt
+ */
+
+/*
+ * scxt-render: run the engine headless and faster than real time. Load a multi or
+ * anything the engine can import (sfz, sf2, a single sample, ...), play a standard
+ * midi file or a synthetic note pattern through it, write the main bus to a wav and
+ * report per block timing. We use this both to batch render and to keep an eye on
+ * performance regressions.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <ctime>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "engine/engine.h"
+#include "messaging/messaging.h"
+#include "modulation/voice_matrix.h"
+#include "patch_io/patch_io.h"
+#include "sst/voicemanager/midi1_to_voicemanager.h"
+
+namespace
+{
+struct RenderEvent
+{
+    double time{0}; // seconds
+    uint8_t data[3]{0, 0, 0};
+    double tempo{0}; // a tempo change, in bpm, rather than midi data if non-zero
+};
+
+struct Options
+{
+    fs::path patch;
+    fs::path midi;
+    fs::path output{"scxt-render.wav"};
+    bool writeWav{true};
+    std::string pattern{"scale"};
+    double sampleRate{48000};
+    double length{8};
+    double tail{2};
+    int polyphony{16};
+    bool benchModMatrix{false};
+};
+
+void usage(const char *argv0)
+{
+    std::cout
+        << "Usage: " << argv0 << " [options] (patch)\n\n"
+        << "  (patch)              a .scm multi or anything the engine imports (sfz, sf2, wav...)\n"
+        << "  -m, --midi FILE      play a standard midi file (otherwise a synthetic pattern)\n"
+        << "  -p, --pattern NAME   synthetic pattern: scale, chords or stress (default scale)\n"
+        << "  -l, --length SEC     length of the synthetic pattern (default 8)\n"
+        << "  -n, --polyphony N    notes held at once by the stress pattern (default 16)\n"
+        << "  -o, --output FILE    wav file to write (default scxt-render.wav)\n"
+        << "      --no-output      render and time only, do not write a wav\n"
+        << "  -r, --sample-rate SR sample rate (default 48000)\n"
+        << "  -t, --tail SEC       keep rendering this long after the last event (default 2)\n"
+        << "      --bench-mod-matrix  time the voice mod matrix and curves, no patch needed\n"
+        << std::endl;
+}
+
+bool parseArgs(int argc, char **argv, Options &o)
+{
+    for (int i = 1; i < argc; ++i)
+    {
+        auto a = std::string(argv[i]);
+        auto next = [&]() -> const char * {
+            if (i + 1 >= argc)
+            {
+                std::cerr << "Missing value for " << a << std::endl;
+                return nullptr;
+            }
+            return argv[++i];
+        };
+        const char *v{nullptr};
+
+        if (a == "-h" || a == "--help")
+            return false;
+        else if (a == "--no-output")
+            o.writeWav = false;
+        else if (a == "--bench-mod-matrix")
+            o.benchModMatrix = true;
+        else if (a == "-m" || a == "--midi")
+        {
+            if (!(v = next()))
+                return false;
+            o.midi = fs::path{v};
+        }
+        else if (a == "-p" || a == "--pattern")
+        {
+            if (!(v = next()))
+                return false;
+            o.pattern = v;
+        }
+        else if (a == "-l" || a == "--length")
+        {
+            if (!(v = next()))
+                return false;
+            o.length = std::atof(v);
+        }
+        else if (a == "-n" || a == "--polyphony")
+        {
+            if (!(v = next()))
+                return false;
+            o.polyphony = std::max(1, std::atoi(v));
+        }
+        else if (a == "-o" || a == "--output")
+        {
+            if (!(v = next()))
+                return false;
+            o.output = fs::path{v};
+        }
+        else if (a == "-r" || a == "--sample-rate")
+        {
+            if (!(v = next()))
+                return false;
+            o.sampleRate = std::atof(v);
+        }
+        else if (a == "-t" || a == "--tail")
+        {
+            if (!(v = next()))
+                return false;
+            o.tail = std::max(0.0, std::atof(v));
+        }
+        else if (!a.empty() && a[0] == '-')
+        {
+            std::cerr << "Unknown option " << a << std::endl;
+            return false;
+        }
+        else
+        {
+            o.patch = fs::path{a};
+        }
+    }
+    if (o.patch.empty() && !o.benchModMatrix)
+    {
+        std::cerr << "No patch given" << std::endl;
+        return false;
+    }
+    if (o.sampleRate < 8000)
+    {
+        std::cerr << "Unreasonable sample rate " << o.sampleRate << std::endl;
+        return false;
+    }
+    return true;
+}
+
+/*
+ * Just enough standard midi file support to render: format 0 and 1, running status,
+ * tempo changes, and channel voice messages. Sysex and other meta events are skipped.
+ */
+bool readMidiFile(const fs::path &p, std::vector<RenderEvent> &events)
+{
+    std::ifstream in(p, std::ios::binary);
+    if (!in)
+    {
+        std::cerr << "Unable to open midi file " << p.u8string() << std::endl;
+        return false;
+    }
+    std::vector<uint8_t> d((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+
+    size_t pos{0};
+    auto need = [&](size_t n) { return pos + n <= d.size(); };
+    auto be16 = [&]() {
+        uint32_t r = (d[pos] << 8) | d[pos + 1];
+        pos += 2;
+        return r;
+    };
+    auto be32 = [&]() {
+        uint32_t r = (d[pos] << 24) | (d[pos + 1] << 16) | (d[pos + 2] << 8) | d[pos + 3];
+        pos += 4;
+        return r;
+    };
+    auto vlq = [&](size_t end) {
+        uint32_t r{0};
+        while (pos < end)
+        {
+            auto b = d[pos++];
+            r = (r << 7) | (b & 0x7F);
+            if (!(b & 0x80))
+                break;
+        }
+        return r;
+    };
+
+    if (!need(14) || std::memcmp(d.data(), "MThd", 4) != 0)
+    {
+        std::cerr << "Not a standard midi file " << p.u8string() << std::endl;
+        return false;
+    }
+    pos = 4;
+    auto headerLen = be32();
+    be16(); // format; 0 and 1 both merge fine
+    auto ntracks = be16();
+    auto division = be16();
+    pos = 8 + headerLen;
+
+    if (division & 0x8000)
+    {
+        std::cerr << "SMPTE time division midi files are not supported" << std::endl;
+        return false;
+    }
+
+    struct TickEvent
+    {
+        uint64_t tick;
+        size_t order;
+        bool isTempo;
+        uint32_t tempo;
+        uint8_t data[3];
+    };
+    std::vector<TickEvent> tevs;
+
+    for (uint32_t t = 0; t < ntracks && need(8); ++t)
+    {
+        if (std::memcmp(d.data() + pos, "MTrk", 4) != 0)
+        {
+            // skip unknown chunks
+            pos += 4;
+            pos += be32();
+            --t;
+            continue;
+        }
+        pos += 4;
+        auto len = be32();
+        auto end = std::min(d.size(), pos + len);
+        uint64_t tick{0};
+        uint8_t status{0};
+        while (pos < end)
+        {
+            tick += vlq(end);
+            if (pos >= end)
+                break;
+            auto b = d[pos];
+            if (b == 0xFF)
+            {
+                pos++;
+                if (pos >= end)
+                    break;
+                auto type = d[pos++];
+                auto mlen = vlq(end);
+                if (type == 0x51 && mlen == 3 && pos + 3 <= end)
+                {
+                    uint32_t tempo = (d[pos] << 16) | (d[pos + 1] << 8) | d[pos + 2];
+                    tevs.push_back({tick, tevs.size(), true, tempo, {0, 0, 0}});
+                }
+                pos += mlen;
+                continue;
+            }
+            if (b == 0xF0 || b == 0xF7)
+            {
+                pos++;
+                pos += vlq(end);
+                continue;
+            }
+            if (b & 0x80)
+            {
+                status = b;
+                pos++;
+            }
+            if (!(status & 0x80))
+            {
+                std::cerr << "Corrupt midi track " << t << std::endl;
+                return false;
+            }
+            auto kind = status & 0xF0;
+            auto nbytes = (kind == 0xC0 || kind == 0xD0) ? 1 : 2;
+            if (pos + nbytes > end)
+                break;
+            TickEvent te{tick, tevs.size(), false, 0, {status, d[pos], 0}};
+            if (nbytes == 2)
+                te.data[2] = d[pos + 1];
+            pos += nbytes;
+            tevs.push_back(te);
+        }
+        pos = end;
+    }
+
+    std::stable_sort(tevs.begin(), tevs.end(), [](const auto &a, const auto &b) {
+        return a.tick < b.tick || (a.tick == b.tick && a.order < b.order);
+    });
+
+    double secondsPerTick = 0.5 / division; // 120bpm until told otherwise
+    double now{0};
+    uint64_t lastTick{0};
+    for (const auto &te : tevs)
+    {
+        now += (te.tick - lastTick) * secondsPerTick;
+        lastTick = te.tick;
+        if (te.isTempo)
+        {
+            secondsPerTick = te.tempo * 1e-6 / division;
+            RenderEvent re;
+            re.time = now;
+            re.tempo = 60e6 / std::max(te.tempo, 1u);
+            events.push_back(re);
+            continue;
+        }
+        RenderEvent re;
+        re.time = now;
+        std::memcpy(re.data, te.data, 3);
+        events.push_back(re);
+    }
+    return true;
+}
+
+void makePattern(const Options &o, std::vector<RenderEvent> &events)
+{
+    auto note = [&](double start, double dur, uint8_t key, uint8_t vel) {
+        events.push_back({start, {0x90, key, vel}});
+        events.push_back({start + dur, {0x80, key, 0}});
+    };
+
+    if (o.pattern == "chords")
+    {
+        static constexpr uint8_t chord[4]{0, 4, 7, 11};
+        uint8_t roots[4]{48, 53, 55, 50};
+        int c{0};
+        for (double t = 0; t < o.length; t += 1.0, ++c)
+            for (auto iv : chord)
+                note(t, 0.9, roots[c % 4] + iv, 100);
+    }
+    else if (o.pattern == "stress")
+    {
+        // Keep polyphony notes sounding, retriggering one every so often so voices
+        // continually start and stop. A fixed LCG keeps runs comparable.
+        uint32_t seed{0x5C47};
+        auto rnd = [&seed]() {
+            seed = seed * 1664525u + 1013904223u;
+            return seed >> 8;
+        };
+        auto spacing = 0.25 / o.polyphony;
+        auto dur = spacing * o.polyphony;
+        for (double t = 0; t < o.length; t += spacing)
+            note(t, dur, 36 + rnd() % 60, 40 + rnd() % 87);
+    }
+    else
+    {
+        if (o.pattern != "scale")
+            std::cerr << "Unknown pattern '" << o.pattern << "'; using scale" << std::endl;
+        static constexpr uint8_t major[7]{0, 2, 4, 5, 7, 9, 11};
+        int i{0};
+        for (double t = 0; t < o.length; t += 0.25, ++i)
+        {
+            auto oct = (i / 7) % 3;
+            note(t, 0.2, 48 + 12 * oct + major[i % 7], 90 + (i % 4) * 10);
+        }
+    }
+
+    std::stable_sort(events.begin(), events.end(),
+                     [](const auto &a, const auto &b) { return a.time < b.time; });
+}
+
+struct WavWriter
+{
+    std::ofstream out;
+    uint32_t frames{0};
+
+    bool open(const fs::path &p, uint32_t sampleRate)
+    {
+        out.open(p, std::ios::binary);
+        if (!out)
+            return false;
+        writeHeader(sampleRate);
+        return true;
+    }
+
+    void writeHeader(uint32_t sampleRate)
+    {
+        auto u32 = [this](uint32_t v) { out.write((const char *)&v, 4); };
+        auto u16 = [this](uint16_t v) { out.write((const char *)&v, 2); };
+        uint32_t dataBytes = frames * 2 * sizeof(float);
+
+        out.write("RIFF", 4);
+        u32(4 + 24 + 12 + 8 + dataBytes);
+        out.write("WAVE", 4);
+        out.write("fmt ", 4);
+        u32(16);
+        u16(3); // WAVE_FORMAT_IEEE_FLOAT
+        u16(2);
+        u32(sampleRate);
+        u32(sampleRate * 2 * sizeof(float));
+        u16(2 * sizeof(float));
+        u16(32);
+        out.write("fact", 4);
+        u32(4);
+        u32(frames);
+        out.write("data", 4);
+        u32(dataBytes);
+    }
+
+    void write(const float L[scxt::blockSize], const float R[scxt::blockSize])
+    {
+        float interleaved[scxt::blockSize * 2];
+        for (int i = 0; i < scxt::blockSize; ++i)
+        {
+            interleaved[2 * i] = L[i];
+            interleaved[2 * i + 1] = R[i];
+        }
+        out.write((const char *)interleaved, sizeof(interleaved));
+        frames += scxt::blockSize;
+    }
+
+    void close(uint32_t sampleRate)
+    {
+        out.seekp(0);
+        writeHeader(sampleRate);
+        out.close();
+    }
+};
+
+size_t countZones(const scxt::engine::Engine &engine)
+{
+    size_t res{0};
+    for (const auto &part : *engine.getPatch())
+        for (const auto &group : part->getGroups())
+            res += group->getZones().size();
+    return res;
+}
+
+double percentile(const std::vector<double> &sorted, double pct)
+{
+    if (sorted.empty())
+        return 0;
+    auto idx = (size_t)std::clamp(pct / 100.0 * (sorted.size() - 1), 0.0,
+                                  (double)(sorted.size() - 1));
+    return sorted[idx];
+}
+
+/*
+ * --bench-mod-matrix: a full engine worth of voice matrices, every row routed, timed
+ * through process() with a curve on each row and with none, plus the raw cost of
+ * evaluating a curve through std::function versus the table dispatch.
+ */
+int benchModMatrix()
+{
+    namespace vm = scxt::voice::modulation;
+    using MC = scxt::modulation::ModulationCurves;
+    using SR = vm::MatrixConfig::SourceIdentifier;
+    using TG = vm::MatrixConfig::TargetIdentifier;
+    MC::initializeCurves();
+
+    constexpr size_t numVoices{scxt::maxVoices};
+    constexpr size_t numRows{vm::MatrixConfig::FixedMatrixSize};
+    constexpr size_t numSources{4};
+    constexpr int numBlocks{2000};
+
+    struct BenchVoice
+    {
+        vm::Matrix matrix;
+        float sources[numSources]{};
+        float bases[numRows]{};
+    };
+    std::vector<std::unique_ptr<BenchVoice>> voices;
+
+    auto runMatrix = [&](bool withCurves) {
+        voices.clear();
+        for (size_t v = 0; v < numVoices; ++v)
+        {
+            auto bv = std::make_unique<BenchVoice>();
+            vm::Matrix::RoutingTable rt;
+            for (size_t r = 0; r < numRows; ++r)
+            {
+                auto &row = rt.routes[r];
+                row.active = true;
+                row.source = SR{'bnch', 'src ', (uint32_t)(r % numSources)};
+                row.target = TG{'bnch', 'tgt ', (uint32_t)r};
+                row.depth = 0.5f;
+                if (withCurves)
+                    row.curve = MC::allCurves[(r + v) % MC::allCurves.size()];
+            }
+            for (uint32_t i = 0; i < numSources; ++i)
+                bv->matrix.bindSourceValue(SR{'bnch', 'src ', i}, bv->sources[i]);
+            bv->matrix.prepare(rt);
+            for (uint32_t r = 0; r < numRows; ++r)
+                bv->matrix.bindTargetBaseValue(TG{'bnch', 'tgt ', r}, bv->bases[r]);
+            voices.push_back(std::move(bv));
+        }
+
+        auto st = std::chrono::steady_clock::now();
+        for (int b = 0; b < numBlocks; ++b)
+        {
+            for (auto &bv : voices)
+            {
+                for (size_t i = 0; i < numSources; ++i)
+                    bv->sources[i] = ((b + i) % 64) / 32.f - 1.f;
+                bv->matrix.process();
+            }
+        }
+        auto us = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - st);
+        return us.count() / numBlocks;
+    };
+
+    auto withCurves = runMatrix(true);
+    auto noCurves = runMatrix(false);
+
+    // The curve evaluation on its own, over the values a block of matrices would produce
+    std::vector<float> values(numVoices * numRows);
+    auto fillValues = [&values](int b) {
+        for (size_t i = 0; i < values.size(); ++i)
+            values[i] = ((b + i) % 64) / 32.f - 1.f;
+    };
+    std::function<float(float)> viaFunction = [](float x) { return std::sin(2.0 * M_PI * x); };
+    volatile float sink{0};
+    double fnNs{0}, tableNs{0};
+    for (int b = 0; b < numBlocks; ++b)
+    {
+        fillValues(b);
+        auto s0 = std::chrono::steady_clock::now();
+        for (auto &v : values)
+            v = viaFunction(v);
+        auto s1 = std::chrono::steady_clock::now();
+        sink = values[b % values.size()];
+
+        fillValues(b);
+        auto s2 = std::chrono::steady_clock::now();
+        MC::evaluateBlock(MC::SINX, values.data(), values.size());
+        auto s3 = std::chrono::steady_clock::now();
+        sink = values[b % values.size()];
+
+        fnNs += std::chrono::duration<double, std::nano>(s1 - s0).count();
+        tableNs += std::chrono::duration<double, std::nano>(s3 - s2).count();
+    }
+    auto perValue = 1.0 / ((double)numBlocks * values.size());
+
+    auto budgetMicros = scxt::blockSize / 48000.0 * 1e6;
+    std::cout << std::fixed << std::setprecision(2);
+    std::cout << "mod matrix:       " << numVoices << " voices x " << numRows << " rows, "
+              << numBlocks << " blocks\n"
+              << "process us/block: with curves " << withCurves << " no curves " << noCurves
+              << " (budget " << budgetMicros << " at 48k)\n"
+              << "per voice ns:     with curves " << 1000.0 * withCurves / numVoices
+              << " no curves " << 1000.0 * noCurves / numVoices << "\n"
+              << "sin curve ns/val: std::function " << fnNs * perValue << " table "
+              << tableNs * perValue << std::endl;
+    return 0;
+}
+} // namespace
+
+int main(int argc, char **argv)
+{
+    Options opts;
+    if (!parseArgs(argc, argv, opts))
+    {
+        usage(argv[0]);
+        return 1;
+    }
+
+    if (opts.benchModMatrix)
+        return benchModMatrix();
+
+    std::vector<RenderEvent> events;
+    if (!opts.midi.empty())
+    {
+        if (!readMidiFile(opts.midi, events))
+            return 2;
+    }
+    else
+    {
+        makePattern(opts, events);
+    }
+
+    auto engine = std::make_unique<scxt::engine::Engine>();
+    engine->runningEnvironment = "scxt-render";
+    engine->prepareToPlay(opts.sampleRate);
+
+    /*
+     * The loaders expect to run on the serialization thread. With no client and no
+     * audio running, the simplest way to load synchronously is to park that thread,
+     * stand in for it, and start it again once the patch is in place.
+     */
+    auto &cont = engine->getMessageController();
+    cont->stop();
+    cont->threadingChecker.registerAsSerialThread();
+
+    auto loadStart = std::chrono::steady_clock::now();
+    if (scxt::extensionMatches(opts.patch, ".scm"))
+    {
+        if (!scxt::patch_io::loadMulti(opts.patch, *engine))
+        {
+            std::cerr << "Unable to load multi " << opts.patch.u8string() << std::endl;
+            return 3;
+        }
+    }
+    else
+    {
+        engine->loadSampleIntoSelectedPartAndGroup(opts.patch, 60, {0, 127}, {0, 127});
+    }
+    auto loadTime = std::chrono::duration<double>(std::chrono::steady_clock::now() - loadStart);
+
+    cont->start();
+    cont->threadingChecker.registerAsAudioThread();
+    // From here this thread plays the audio thread, note ons included
+    scxt::engine::MemoryPool::isRealtimeThread = true;
+
+    auto zones = countZones(*engine);
+    if (zones == 0)
+    {
+        std::cerr << "Nothing loaded from " << opts.patch.u8string() << std::endl;
+        return 3;
+    }
+
+    engine->transport.tempo = 120;
+    engine->transport.signature.numerator = 4;
+    engine->transport.signature.denominator = 4;
+    engine->onTransportUpdated();
+
+    WavWriter wav;
+    if (opts.writeWav && !wav.open(opts.output, (uint32_t)opts.sampleRate))
+    {
+        std::cerr << "Unable to open " << opts.output.u8string() << " for writing" << std::endl;
+        return 4;
+    }
+
+    auto lastEvent = events.empty() ? 0.0 : events.back().time;
+    auto totalBlocks = (size_t)std::ceil((lastEvent + opts.tail) * opts.sampleRate / scxt::blockSize);
+    auto blockSeconds = scxt::blockSize / opts.sampleRate;
+
+    std::vector<double> blockMicros;
+    blockMicros.reserve(totalBlocks);
+    // Time to hand each note on / off to the voice manager, which covers zone lookup,
+    // voice allocation and release
+    std::vector<double> noteOnMicros, noteOffMicros;
+    uint32_t peakVoices{0};
+    double voiceBlocks{0};
+
+    const auto &mainBus = engine->getPatch()->busses.mainBus;
+    size_t nextEvent{0};
+
+    auto cpuStart = std::clock();
+    auto wallStart = std::chrono::steady_clock::now();
+    for (size_t b = 0; b < totalBlocks; ++b)
+    {
+        // Events are dispatched at the top of the block which contains them, with their
+        // offset into it so new voices start on the right sample
+        auto blockStart = b * blockSeconds;
+        auto blockEnd = (b + 1) * blockSeconds;
+        while (nextEvent < events.size() && events[nextEvent].time < blockEnd)
+        {
+            const auto &ev = events[nextEvent];
+            if (ev.tempo > 0)
+            {
+                engine->transport.tempo = ev.tempo;
+                nextEvent++;
+                continue;
+            }
+
+            engine->setEventSampleOffset(
+                (int32_t)std::floor((ev.time - blockStart) * opts.sampleRate));
+            auto es = std::chrono::steady_clock::now();
+            sst::voicemanager::applyMidi1Message(engine->voiceManager, 0, ev.data);
+            auto ee = std::chrono::steady_clock::now();
+
+            auto status = ev.data[0] & 0xF0;
+            auto us = std::chrono::duration<double, std::micro>(ee - es).count();
+            if (status == 0x90 && ev.data[2] > 0)
+                noteOnMicros.push_back(us);
+            else if (status == 0x80 || status == 0x90)
+                noteOffMicros.push_back(us);
+            nextEvent++;
+        }
+
+        // Run the transport as a playing host would, so tempo synced modulators move
+        engine->onTransportUpdated();
+
+        auto s = std::chrono::steady_clock::now();
+        engine->processAudio();
+        auto e = std::chrono::steady_clock::now();
+        blockMicros.push_back(std::chrono::duration<double, std::micro>(e - s).count());
+
+        engine->transport.timeInBeats +=
+            (double)scxt::blockSize * engine->transport.tempo * engine->getSampleRateInv() / 60.f;
+
+        uint32_t av = engine->activeVoices;
+        peakVoices = std::max(peakVoices, av);
+        voiceBlocks += av;
+
+        if (opts.writeWav)
+            wav.write(mainBus.output[0], mainBus.output[1]);
+    }
+    auto wallTime = std::chrono::duration<double>(std::chrono::steady_clock::now() - wallStart);
+    auto cpuTime = (double)(std::clock() - cpuStart) / CLOCKS_PER_SEC;
+
+    if (opts.writeWav)
+        wav.close((uint32_t)opts.sampleRate);
+
+    std::sort(blockMicros.begin(), blockMicros.end());
+    std::sort(noteOnMicros.begin(), noteOnMicros.end());
+    std::sort(noteOffMicros.begin(), noteOffMicros.end());
+    auto budgetMicros = blockSeconds * 1e6;
+    auto renderedSeconds = totalBlocks * blockSeconds;
+
+    std::cout << std::fixed << std::setprecision(2);
+    std::cout << "patch:            " << opts.patch.u8string() << " (" << zones << " zones, load "
+              << loadTime.count() << "s)\n"
+              << "zone memory:      " << zones * sizeof(scxt::engine::Zone) / 1024.0 << "kb ("
+              << sizeof(scxt::engine::Zone) << " bytes per zone)\n"
+              << "events:           " << events.size() << "\n"
+              << "blocks:           " << totalBlocks << " x " << scxt::blockSize << " @ "
+              << opts.sampleRate << "Hz (" << renderedSeconds << "s)\n"
+              << "wall:             " << wallTime.count() << "s (" << std::setprecision(1)
+              << (wallTime.count() > 0 ? renderedSeconds / wallTime.count() : 0.0)
+              << "x real time)\n"
+              << std::setprecision(2) << "process cpu:      " << cpuTime << "s ("
+              << (wallTime.count() > 0 ? 100.0 * cpuTime / wallTime.count() : 0.0)
+              << "% of wall, all threads)\n"
+              << "block us:         p50 " << percentile(blockMicros, 50) << " p90 "
+              << percentile(blockMicros, 90) << " p99 " << percentile(blockMicros, 99) << " p99.9 "
+              << percentile(blockMicros, 99.9) << " max "
+              << (blockMicros.empty() ? 0.0 : blockMicros.back()) << " (budget " << budgetMicros
+              << ")\n"
+              << "block % budget:   p50 " << 100.0 * percentile(blockMicros, 50) / budgetMicros
+              << " p99 " << 100.0 * percentile(blockMicros, 99) / budgetMicros << "\n"
+              << "voices:           peak " << peakVoices << " mean "
+              << (totalBlocks ? voiceBlocks / totalBlocks : 0.0) << "\n"
+              << "note on us:       p50 " << percentile(noteOnMicros, 50) << " p99 "
+              << percentile(noteOnMicros, 99) << " max "
+              << (noteOnMicros.empty() ? 0.0 : noteOnMicros.back()) << " ("
+              << noteOnMicros.size() << ")\n"
+              << "note off us:      p50 " << percentile(noteOffMicros, 50) << " p99 "
+              << percentile(noteOffMicros, 99) << " max "
+              << (noteOffMicros.empty() ? 0.0 : noteOffMicros.back()) << " ("
+              << noteOffMicros.size() << ")\n"
+              << "stream underruns: " << engine->sharedUIMemoryState.diskStreamUnderruns << "\n";
+    if (opts.writeWav)
+        std::cout << "output:           " << opts.output.u8string() << std::endl;
+
+    engine.reset();
+    return 0;
+}
@@ -159,6 +159,10 @@ void SampleWaveform::rebuildEnvelopePaths()
     auto startSample = std::clamp((int)std::floor(l * pctStart) - samplePad, 0, (int)l);
     auto numSamples = (int)std::ceil(1.f * l / zoomFactor);
     auto endSample = std::clamp(startSample + numSamples + 2 * samplePad, 0, (int)l);
+    // Disk streamed samples only have their head in memory, so only draw that. The audio
+    // thread can swap what is resident, so take the data and its length together.
+    auto rd = samp->getResidentSnapshot();
+    endSample = std::min(endSample, (int)rd.frames);
     auto fac = std::max(1.0 * numSamples / r.getWidth(), 1.0);
 
     for (int ch = 0; ch < usedChannels; ++ch)
@@ -166,7 +170,16 @@ void SampleWaveform::rebuildEnvelopePaths()
         std::vector<std::pair<size_t, float>> topLine, bottomLine;
 
         auto downSampleForUI = [startSample, endSample, fac, &topLine, &bottomLine](auto *data) {
-            using T = std::remove_pointer_t<decltype(data)>;
+            // Packed 24 bit samples are scanned as the int32 they widen to
+            using D = std::remove_const_t<std::remove_pointer_t<decltype(data)>>;
+            static constexpr bool isI24 = std::is_same_v<D, dsp::PackedI24>;
+            using T = std::conditional_t<isI24, int32_t, D>;
+            auto value = [data](int s) -> T {
+                if constexpr (isI24)
+                    return data[s].toInt();
+                else
+                    return data[s];
+            };
             double c = startSample;
             int ct = 0;
             auto seedmx = std::numeric_limits<T>::min();
@@ -185,6 +198,10 @@ void SampleWaveform::rebuildEnvelopePaths()
             {
                 normFactor = std::numeric_limits<T>::max();
             }
+            if constexpr (isI24)
+            {
+                normFactor = (1 << 23) - 1;
+            }
             for (int s = startSample; s < endSample; ++s)
             {
                 if (c + fac < s)
@@ -200,19 +217,24 @@ void SampleWaveform::rebuildEnvelopePaths()
                     mx = seedmx;
                     mn = seedmn;
                 }
-                mx = std::max(data[s], mx);
-                mn = std::min(data[s], mn);
+                mx = std::max(value(s), mx);
+                mn = std::min(value(s), mn);
             }
         };
 
         if (samp->bitDepth == sample::Sample::BD_I16)
         {
-            auto d = samp->GetSamplePtrI16(ch);
+            auto d = rd.channel<int16_t>(ch);
             downSampleForUI(d);
         }
         else if (samp->bitDepth == sample::Sample::BD_F32)
         {
-            auto d = samp->GetSamplePtrF32(ch);
+            auto d = rd.channel<float>(ch);
+            downSampleForUI(d);
+        }
+        else if (samp->bitDepth == sample::Sample::BD_I24)
+        {
+            auto d = rd.channel<dsp::PackedI24>(ch);
             downSampleForUI(d);
         }
         else
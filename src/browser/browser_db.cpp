@@ -239,7 +239,7 @@ struct TxnGuard
 struct WriterWorker
 {
     static constexpr const char *schema_version =
-        "1003"; // I will rebuild if this is not my version
+        "1004"; // I will rebuild if this is not my version
 
     static constexpr const char *setup_sql = R"SQL(
 DROP TABLE IF EXISTS "DebugJunk";
@@ -257,6 +257,12 @@ CREATE TABLE DebugJunk (
 CREATE TABLE IF NOT EXISTS DeviceLocations (
     id integer primary key,
     path varchar(2048)
+);
+CREATE TABLE IF NOT EXISTS SampleMD5Cache (
+    path varchar(2048) primary key,
+    size integer,
+    mtime integer,
+    md5 varchar(64)
 );
     )SQL";
     struct EnQAble
@@ -279,6 +285,19 @@ CREATE TABLE IF NOT EXISTS DeviceLocations (
         void go(WriterWorker &w) override { w.addDeviceLocation(path); }
     };
 
+    struct EnQMD5 : public EnQAble
+    {
+        fs::path path;
+        uint64_t size;
+        int64_t mtime;
+        std::string md5;
+        EnQMD5(const fs::path &p, uint64_t s, int64_t m, const std::string &md5)
+            : path(p), size(s), mtime(m), md5(md5)
+        {
+        }
+        void go(WriterWorker &w) override { w.addMD5(path, size, mtime, md5); }
+    };
+
     void openDb()
     {
 #if TRACE_DB
@@ -593,6 +612,29 @@ CREATE TABLE IF NOT EXISTS DeviceLocations (
         }
     }
 
+    void addMD5(const fs::path &p, uint64_t size, int64_t mtime, const std::string &md5)
+    {
+        try
+        {
+            auto there = SQL::Statement(dbh, "INSERT OR REPLACE INTO SampleMD5Cache (\"path\", "
+                                             "\"size\", \"mtime\", \"md5\") VALUES (?1, ?2, ?3, ?4)");
+
+            // bind is SQLITE_STATIC so keep the string alive through the step
+            auto ps = p.u8string();
+            there.bind(1, ps);
+            there.bindi64(2, (int64_t)size);
+            there.bindi64(3, mtime);
+            there.bind(4, md5);
+
+            there.step();
+            there.finalize();
+        }
+        catch (const SQL::Exception &e)
+        {
+            SCLOG(e.what());
+        }
+    }
+
     // FIXME for now I am coding this with a locked vector but probably a
     // thread safe queue is the way to go
     std::thread qThread;
@@ -689,6 +731,40 @@ std::vector<fs::path> BrowserDB::getDeviceLocations()
     return res;
 }
 
+std::optional<std::string> BrowserDB::getCachedMD5(const fs::path &p, uint64_t size,
+                                                   int64_t mtime)
+{
+    std::lock_guard<std::mutex> g(md5ReadMutex);
+    auto conn = writerWorker->getReadOnlyConn();
+    if (!conn)
+        return std::nullopt;
+
+    std::optional<std::string> res;
+    // language=SQL
+    std::string query = "SELECT size, mtime, md5 FROM SampleMD5Cache WHERE path = ?1;";
+    try
+    {
+        auto q = SQL::Statement(conn, query);
+        auto ps = p.u8string();
+        q.bind(1, ps);
+        if (q.step() && (uint64_t)q.col_int64(0) == size && q.col_int64(1) == mtime)
+        {
+            res = q.col_str(2);
+        }
+        q.finalize();
+    }
+    catch (SQL::Exception &e)
+    {
+        SCLOG(e.what());
+    }
+    return res;
+}
+
+void BrowserDB::cacheMD5(const fs::path &p, uint64_t size, int64_t mtime, const std::string &md5)
+{
+    writerWorker->enqueueWorkItem(new WriterWorker::EnQMD5(p, size, mtime, md5));
+}
+
 int BrowserDB::numberOfJobsOutstanding() const
 {
     std::lock_guard<std::mutex> guard(writerWorker->qLock);
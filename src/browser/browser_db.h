@@ -29,7 +29,11 @@
 #define SCXT_SRC_BROWSER_BROWSER_DB_H
 
 #include "filesystem/import.h"
+#include <cstdint>
 #include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
 #include <vector>
 
 namespace scxt::browser
@@ -45,11 +49,21 @@ struct BrowserDB
 
     std::vector<fs::path> getDeviceLocations();
 
+    /*
+     * A cache of file content md5s keyed by path, size and modification time so
+     * we only hash a sample file again when it changes. Both are safe to call
+     * from any thread; the store is written on the db worker thread.
+     */
+    std::optional<std::string> getCachedMD5(const fs::path &, uint64_t size, int64_t mtime);
+    void cacheMD5(const fs::path &, uint64_t size, int64_t mtime, const std::string &md5);
+
     int numberOfJobsOutstanding() const;
     int waitForJobsOutstandingComplete(int maxWaitInMS) const;
 
   private:
     std::unique_ptr<WriterWorker> writerWorker;
+    // the read only connection is opened without sqlite's mutex so serialize our reads
+    std::mutex md5ReadMutex;
 };
 } // namespace scxt::browser
 #endif // SHORTCIRCUITXT_BROWSER_DB_H
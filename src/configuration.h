@@ -54,6 +54,8 @@ static constexpr uint16_t numPluginOutputs{numNonMainPluginOutputs + 1};
 static constexpr size_t numTransportPhasors{7}; // double whole -> 32
 
 static constexpr uint16_t maxVoices{256};
+// voices of a zone whose output stage is mixed together in one pass. SSE4.2 is our target
+static constexpr uint16_t voiceLaneWidth{4};
 
 // some battles are not worth it
 static constexpr uint16_t BLOCK_SIZE{blockSize};
@@ -41,7 +41,7 @@
 
 /*
  * This is the Generator, the core class which moves from the sample data to an output
- * stream. It handles looping, fades, interpolation methods, f32 vs i16 and more.
+ * stream. It handles looping, fades, interpolation methods, f32 vs i16 vs packed i24 and more.
  *
  * There's three "big ideas" you need to udnerstand it
  *
@@ -101,6 +101,31 @@ constexpr float I16InvScale = (1.f / (16384.f * 32768.f));
 constexpr float I16InvScale2 = (1.f / (32768.f));
 const __m128 I16InvScale_m128 = _mm_set1_ps(I16InvScale);
 
+/*
+ * Packed 24 bit data is converted as we interpolate. We widen four samples at a time into
+ * the top three bytes of each int32 lane (so the sign comes along for free), run the float
+ * sinc on those and scale the result back down. Since both scales are powers of two this
+ * is bit identical to running the float kernel on data promoted by load_data_i24.
+ */
+constexpr float I24TopAlignedInvScale = (1.f / 2147483648.f);
+const __m128i I24UnpackLow = _mm_setr_epi8(-1, 0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11);
+const __m128i I24UnpackHigh =
+    _mm_setr_epi8(-1, 4, 5, 6, -1, 7, 8, 9, -1, 10, 11, 12, -1, 13, 14, 15);
+
+// Widen the FIRipol_N packed samples at d into four float vectors, top aligned
+inline void unpackI24ForSinc(const PackedI24 *d, __m128 s[4])
+{
+    auto p = (const uint8_t *)d;
+    s[0] = _mm_cvtepi32_ps(_mm_shuffle_epi8(_mm_loadu_si128((const __m128i *)p), I24UnpackLow));
+    s[1] = _mm_cvtepi32_ps(
+        _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *)(p + 12)), I24UnpackLow));
+    s[2] = _mm_cvtepi32_ps(
+        _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *)(p + 24)), I24UnpackLow));
+    // The last four load from 4 bytes early so we never read past the 48 byte window
+    s[3] = _mm_cvtepi32_ps(
+        _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *)(p + 32)), I24UnpackHigh));
+}
+
 inline float getFadeGainToAmp(float g)
 {
     // return std::cbrt(g);
@@ -153,6 +178,14 @@ template <> struct KernelOp<InterpolationTypes::Sinc, int16_t>
             KernelProcessor<InterpolationTypes::Sinc, int16_t, NUM_CHANNELS, LOOP_ACTIVE> &ks);
 };
 
+template <> struct KernelOp<InterpolationTypes::Sinc, PackedI24>
+{
+    template <int NUM_CHANNELS, bool LOOP_ACTIVE>
+    static void
+    Process(GeneratorState *__restrict GD,
+            KernelProcessor<InterpolationTypes::Sinc, PackedI24, NUM_CHANNELS, LOOP_ACTIVE> &ks);
+};
+
 template <InterpolationTypes KT, typename T, int NUM_CHANNELS, bool LOOP_ACTIVE>
 struct KernelProcessor
 {
@@ -179,6 +212,8 @@ float NormalizeSampleToF32(float val) { return val; }
 
 float NormalizeSampleToF32(int16_t val) { return val * I16InvScale2; }
 
+float NormalizeSampleToF32(PackedI24 val) { return val.toInt() * I24InvScale; }
+
 template <typename T>
 template <int NUM_CHANNELS, bool LOOP_ACTIVE>
 void KernelOp<InterpolationTypes::ZeroOrderHold, T>::Process(
@@ -523,23 +558,243 @@ void KernelOp<InterpolationTypes::Sinc, int16_t>::Process(
     }
 }
 
+template <int NUM_CHANNELS, bool LOOP_ACTIVE>
+void KernelOp<InterpolationTypes::Sinc, PackedI24>::Process(
+    GeneratorState *__restrict GD,
+    KernelProcessor<InterpolationTypes::Sinc, PackedI24, NUM_CHANNELS, LOOP_ACTIVE> &ks)
+{
+    auto m0{ks.m0};
+    auto i{ks.i};
+
+    // packed i24 path (SSSE3); the same coefficients as the float path
+    __m128 lipol0, tmp[4];
+    lipol0 = _mm_set1_ps((float)(ks.SampleSubPos & 0xffff));
+    for (int j = 0; j < 4; ++j)
+    {
+        tmp[j] = _mm_add_ps(_mm_mul_ps(*((__m128 *)&sincTable.SincOffsetF32[m0 + 4 * j]), lipol0),
+                            *((__m128 *)&sincTable.SincTableF32[m0 + 4 * j]));
+    }
+
+    auto sinc = [&tmp](const PackedI24 *d) {
+        __m128 s[4];
+        unpackI24ForSinc(d, s);
+        auto s4 = _mm_mul_ps(tmp[0], s[0]);
+        s4 = _mm_add_ps(s4, _mm_mul_ps(tmp[1], s[1]));
+        s4 = _mm_add_ps(s4, _mm_mul_ps(tmp[2], s[2]));
+        s4 = _mm_add_ps(s4, _mm_mul_ps(tmp[3], s[3]));
+        s4 = _mm_hadd_ps(s4, s4);
+        s4 = _mm_hadd_ps(s4, s4);
+        return _mm_cvtss_f32(s4) * I24TopAlignedInvScale;
+    };
+
+    for (int c = 0; c < NUM_CHANNELS; ++c)
+    {
+        auto Output{ks.Output[c]};
+        Output[i] = sinc(ks.ReadSample[c]);
+
+        if constexpr (LOOP_ACTIVE)
+        {
+            if (ks.fadeActive)
+            {
+                auto fadeVal = sinc(ks.ReadFadeSample[c]);
+                auto fadeGain(getFadeGain(ks.SamplePos, GD->loopUpperBound - ks.loopFade,
+                                          GD->loopUpperBound));
+                auto aOut = getFadeGainToAmp(1.f - fadeGain);
+                fadeGain = getFadeGainToAmp(fadeGain);
+
+                Output[i] = Output[i] * aOut + fadeVal * fadeGain;
+            }
+        }
+    }
+}
+
+/*
+ * The block kernels compute generatorKernelFrames output frames in one go for the common
+ * case where none of those frames touch a loop or playback boundary or a crossfade. The
+ * harness in GeneratorSample works out the positions and subpositions for each frame
+ * (exactly as the per-sample path would advance them) and only calls in here when it has
+ * proven the whole run is in free-running territory. The results are bit identical to
+ * calling KernelOp frame by frame; the win is sharing the horizontal reductions across
+ * frames and writing the outputs with a single store.
+ *
+ * Unlike KernelOp these index the sample data directly by absolute position, since in
+ * the free running region readSample is always just data + pos - FIRoffset.
+ */
+static constexpr int generatorKernelFrames{4};
+
+template <InterpolationTypes KT, typename T> struct KernelBlockOp
+{
+};
+
+template <typename T> struct KernelBlockOp<InterpolationTypes::Linear, T>
+{
+    template <int NUM_CHANNELS>
+    static void Process(T *const *__restrict data, const int32_t *__restrict pos,
+                        const int32_t *__restrict subPos, float *const *__restrict output, int i)
+    {
+        static constexpr float subScale{1.f / (1 << 24)};
+        auto fsub = _mm_mul_ps(_mm_cvtepi32_ps(_mm_loadu_si128((__m128i *)subPos)),
+                               _mm_set1_ps(subScale));
+        auto fsubInv = _mm_sub_ps(_mm_set1_ps(1.f), fsub);
+
+        for (int c = 0; c < NUM_CHANNELS; ++c)
+        {
+            auto d = data[c];
+            // KernelOp reads FIRoffset - 1 and FIRoffset from data + pos - FIRoffset
+            auto y0 = _mm_setr_ps(
+                NormalizeSampleToF32(d[pos[0] - 1]), NormalizeSampleToF32(d[pos[1] - 1]),
+                NormalizeSampleToF32(d[pos[2] - 1]), NormalizeSampleToF32(d[pos[3] - 1]));
+            auto y1 = _mm_setr_ps(NormalizeSampleToF32(d[pos[0]]), NormalizeSampleToF32(d[pos[1]]),
+                                  NormalizeSampleToF32(d[pos[2]]), NormalizeSampleToF32(d[pos[3]]));
+            _mm_storeu_ps(output[c] + i,
+                          _mm_add_ps(_mm_mul_ps(y0, fsubInv), _mm_mul_ps(y1, fsub)));
+        }
+    }
+};
+
+template <> struct KernelBlockOp<InterpolationTypes::Sinc, float>
+{
+    template <int NUM_CHANNELS>
+    static void Process(float *const *__restrict data, const int32_t *__restrict pos,
+                        const int32_t *__restrict subPos, float *const *__restrict output, int i)
+    {
+        __m128 acc[NUM_CHANNELS][generatorKernelFrames];
+        for (int k = 0; k < generatorKernelFrames; ++k)
+        {
+            auto m0 = (subPos[k] >> 12) & 0xff0;
+            auto lipol0 = _mm_set1_ps((float)(subPos[k] & 0xffff));
+
+            __m128 tmp[4];
+            for (int j = 0; j < 4; ++j)
+            {
+                tmp[j] =
+                    _mm_add_ps(_mm_mul_ps(*((__m128 *)&sincTable.SincOffsetF32[m0 + 4 * j]), lipol0),
+                               *((__m128 *)&sincTable.SincTableF32[m0 + 4 * j]));
+            }
+
+            for (int c = 0; c < NUM_CHANNELS; ++c)
+            {
+                auto rs = data[c] + pos[k] - FIRoffset;
+                auto s4 = _mm_mul_ps(tmp[0], _mm_loadu_ps(rs));
+                s4 = _mm_add_ps(s4, _mm_mul_ps(tmp[1], _mm_loadu_ps(rs + 4)));
+                s4 = _mm_add_ps(s4, _mm_mul_ps(tmp[2], _mm_loadu_ps(rs + 8)));
+                s4 = _mm_add_ps(s4, _mm_mul_ps(tmp[3], _mm_loadu_ps(rs + 12)));
+                acc[c][k] = s4;
+            }
+        }
+
+        // Three hadds reduce all four frames, summing in the same order as the scalar path
+        for (int c = 0; c < NUM_CHANNELS; ++c)
+        {
+            auto r = _mm_hadd_ps(_mm_hadd_ps(acc[c][0], acc[c][1]), _mm_hadd_ps(acc[c][2], acc[c][3]));
+            _mm_storeu_ps(output[c] + i, r);
+        }
+    }
+};
+
+template <> struct KernelBlockOp<InterpolationTypes::Sinc, int16_t>
+{
+    template <int NUM_CHANNELS>
+    static void Process(int16_t *const *__restrict data, const int32_t *__restrict pos,
+                        const int32_t *__restrict subPos, float *const *__restrict output, int i)
+    {
+        __m128i acc[NUM_CHANNELS][generatorKernelFrames];
+        for (int k = 0; k < generatorKernelFrames; ++k)
+        {
+            auto m0 = (subPos[k] >> 12) & 0xff0;
+            auto lipol0 = _mm_set1_epi16(subPos[k] & 0xffff);
+
+            auto tmp =
+                _mm_add_epi16(_mm_mulhi_epi16(*((__m128i *)&sincTable.SincOffsetI16[m0]), lipol0),
+                              *((__m128i *)&sincTable.SincTableI16[m0]));
+            auto tmp2 = _mm_add_epi16(
+                _mm_mulhi_epi16(*((__m128i *)&sincTable.SincOffsetI16[m0 + 8]), lipol0),
+                *((__m128i *)&sincTable.SincTableI16[m0 + 8]));
+
+            for (int c = 0; c < NUM_CHANNELS; ++c)
+            {
+                auto rs = data[c] + pos[k] - FIRoffset;
+                auto sA = _mm_madd_epi16(tmp, _mm_loadu_si128((__m128i *)rs));
+                auto sB = _mm_madd_epi16(tmp2, _mm_loadu_si128((__m128i *)(rs + 8)));
+                acc[c][k] = _mm_add_epi32(sA, sB);
+            }
+        }
+
+        for (int c = 0; c < NUM_CHANNELS; ++c)
+        {
+            auto r = _mm_hadd_epi32(_mm_hadd_epi32(acc[c][0], acc[c][1]),
+                                    _mm_hadd_epi32(acc[c][2], acc[c][3]));
+            _mm_storeu_ps(output[c] + i, _mm_mul_ps(_mm_cvtepi32_ps(r), I16InvScale_m128));
+        }
+    }
+};
+
+template <> struct KernelBlockOp<InterpolationTypes::Sinc, PackedI24>
+{
+    template <int NUM_CHANNELS>
+    static void Process(PackedI24 *const *__restrict data, const int32_t *__restrict pos,
+                        const int32_t *__restrict subPos, float *const *__restrict output, int i)
+    {
+        __m128 acc[NUM_CHANNELS][generatorKernelFrames];
+        for (int k = 0; k < generatorKernelFrames; ++k)
+        {
+            auto m0 = (subPos[k] >> 12) & 0xff0;
+            auto lipol0 = _mm_set1_ps((float)(subPos[k] & 0xffff));
+
+            __m128 tmp[4];
+            for (int j = 0; j < 4; ++j)
+            {
+                tmp[j] =
+                    _mm_add_ps(_mm_mul_ps(*((__m128 *)&sincTable.SincOffsetF32[m0 + 4 * j]), lipol0),
+                               *((__m128 *)&sincTable.SincTableF32[m0 + 4 * j]));
+            }
+
+            for (int c = 0; c < NUM_CHANNELS; ++c)
+            {
+                __m128 s[4];
+                unpackI24ForSinc(data[c] + pos[k] - FIRoffset, s);
+                auto s4 = _mm_mul_ps(tmp[0], s[0]);
+                s4 = _mm_add_ps(s4, _mm_mul_ps(tmp[1], s[1]));
+                s4 = _mm_add_ps(s4, _mm_mul_ps(tmp[2], s[2]));
+                s4 = _mm_add_ps(s4, _mm_mul_ps(tmp[3], s[3]));
+                acc[c][k] = s4;
+            }
+        }
+
+        for (int c = 0; c < NUM_CHANNELS; ++c)
+        {
+            auto r = _mm_hadd_ps(_mm_hadd_ps(acc[c][0], acc[c][1]), _mm_hadd_ps(acc[c][2], acc[c][3]));
+            _mm_storeu_ps(output[c] + i, _mm_mul_ps(r, _mm_set1_ps(I24TopAlignedInvScale)));
+        }
+    }
+};
+
+template <InterpolationTypes KT, typename T, int NUM_CHANNELS>
+void ProcessKernelBlock(T *const *data, const int32_t *pos, const int32_t *subPos,
+                        float *const *output, int i)
+{
+    KernelBlockOp<KT, T>::template Process<NUM_CHANNELS>(data, pos, subPos, output, i);
+}
+
 template <int compoundConfig>
 void GeneratorSample(GeneratorState *__restrict GD, GeneratorIO *__restrict IO);
 
-int toLoopValue(bool active, bool forward, bool whileGated, bool isFloat, bool isStereo)
+int toLoopValue(bool active, bool forward, bool whileGated, bool isStereo,
+                GeneratorSampleFormat format)
 {
-    return ((isStereo * 1) << 4) + ((isFloat * 1) << 3) + ((active * 1) << 2) +
+    return (((int)format) << 4) + ((isStereo * 1) << 3) + ((active * 1) << 2) +
            ((forward * 1) << 1) + (whileGated * 1);
 }
 
-constexpr std::array<bool, 5> fromLoopValue(int lv)
+constexpr std::array<bool, 6> fromLoopValue(int lv)
 {
     bool whileGated = (lv & (1 << 0));
     bool forward = (lv & (1 << 1));
     bool active = (lv & (1 << 2));
-    bool isfl = (lv & (1 << 3));
-    bool stereo = (lv & (1 << 4));
-    return {active, forward, whileGated, isfl, stereo};
+    bool stereo = (lv & (1 << 3));
+    bool isfl = (lv >> 4) == GSF_F32;
+    bool isi24 = (lv >> 4) == GSF_I24;
+    return {active, forward, whileGated, isfl, stereo, isi24};
 }
 
 namespace detail
@@ -554,12 +809,31 @@ template <size_t... Is> auto generatorGet(size_t ft, std::index_sequence<Is...>)
 }
 } // namespace detail
 
-GeneratorFPtr GetFPtrGeneratorSample(bool Stereo, bool Float, bool loopActive, bool loopForward,
-                                     bool loopWhileGated)
+GeneratorFPtr GetFPtrGeneratorSample(bool Stereo, GeneratorSampleFormat format, bool loopActive,
+                                     bool loopForward, bool loopWhileGated)
+{
+    static constexpr size_t nLoopValues{nGeneratorSampleFormats << 4};
+    auto loopValue = toLoopValue(loopActive, loopForward, loopWhileGated, Stereo, format);
+    assert(loopValue >= 0 && loopValue < nLoopValues);
+    return detail::generatorGet(loopValue, std::make_index_sequence<nLoopValues>());
+}
+
+int framesBeforeLoopWrap(const GeneratorState *GD, int frames)
 {
-    auto loopValue = toLoopValue(loopActive, loopForward, loopWhileGated, Float, Stereo);
-    assert(loopValue >= 0 && loopValue < (1 << 5));
-    return detail::generatorGet(loopValue, std::make_index_sequence<(1 << 5)>());
+    int64_t ratio = std::abs((int64_t)GD->ratio);
+    if (ratio == 0)
+        return frames;
+
+    // The per sample advance below moves us by ratio in the 24 bit sub position and wraps
+    // once we are past the bound, so count the positions before that
+    int64_t pos = GD->samplePos, sub = GD->sampleSubPos;
+    int direction = GD->direction * (GD->ratio < 0 ? -1 : 1);
+    int64_t before{1};
+    if (direction > 0 && pos <= GD->loopUpperBound)
+        before = ((((int64_t)GD->loopUpperBound - pos + 1) << 24) - sub - 1) / ratio + 1;
+    else if (direction < 0 && pos >= GD->loopLowerBound)
+        before = (((pos - GD->loopLowerBound) << 24) + sub) / ratio + 1;
+    return (int)std::clamp(before, (int64_t)1, (int64_t)frames);
 }
 
 template <int loopValue>
@@ -571,6 +845,10 @@ void GeneratorSample(GeneratorState *__restrict GD, GeneratorIO *__restrict IO)
     static constexpr auto loopWhileGated = std::get<2>(mode);
     static constexpr auto fp = std::get<3>(mode);
     static constexpr auto stereo = std::get<4>(mode);
+    static constexpr auto packedI24 = std::get<5>(mode);
+
+    // The integer formats share a path; everything below just indexes by frame
+    using int_t = typename std::conditional<packedI24, PackedI24, int16_t>::type;
 
     int SamplePos = GD->samplePos;
     int SampleSubPos = GD->sampleSubPos;
@@ -581,10 +859,13 @@ void GeneratorSample(GeneratorState *__restrict GD, GeneratorIO *__restrict IO)
     int RatioSign = Ratio < 0 ? -1 : 1;
     Ratio = std::abs(Ratio);
     int Direction = GD->direction * RatioSign;
-    int16_t *__restrict SampleDataL;
-    int16_t *__restrict SampleDataR;
+    int_t *__restrict SampleDataL;
+    int_t *__restrict SampleDataR;
     float *__restrict SampleDataFL;
     float *__restrict SampleDataFR;
+    // These may alias the above, but we only ever read them
+    int_t *WrapDataL, *WrapDataR;
+    float *WrapDataFL, *WrapDataFR;
     float *__restrict OutputL;
     float *__restrict OutputR;
 
@@ -597,25 +878,37 @@ void GeneratorSample(GeneratorState *__restrict GD, GeneratorIO *__restrict IO)
     GD->positionWithinLoop = 0.f;
     GD->isInLoop = false;
 
+    auto *wrapL = IO->loopWrapDataL ? IO->loopWrapDataL : IO->sampleDataL;
+    auto *wrapR = IO->loopWrapDataL ? IO->loopWrapDataR : IO->sampleDataR;
     if (fp)
+    {
         SampleDataFL = (float *)IO->sampleDataL;
+        WrapDataFL = (float *)wrapL;
+    }
     else
-        SampleDataL = (short *)IO->sampleDataL;
+    {
+        SampleDataL = (int_t *)IO->sampleDataL;
+        WrapDataL = (int_t *)wrapL;
+    }
     OutputL = IO->outputL;
     if (stereo)
     {
         if (fp)
+        {
             SampleDataFR = (float *)IO->sampleDataR;
-        SampleDataR = (short *)IO->sampleDataR;
+            WrapDataFR = (float *)wrapR;
+        }
+        SampleDataR = (int_t *)IO->sampleDataR;
+        WrapDataR = (int_t *)wrapR;
         OutputR = IO->outputR;
     }
 
     static constexpr int resampFIRSize{16};
-    int16_t *__restrict readSampleL = nullptr;
-    int16_t *__restrict readSampleR = nullptr;
-    int16_t *__restrict readFadeSampleL = nullptr;
-    int16_t *__restrict readFadeSampleR = nullptr;
-    int16_t loopEndBufferL[resampFIRSize], loopEndBufferR[resampFIRSize];
+    int_t *__restrict readSampleL = nullptr;
+    int_t *__restrict readSampleR = nullptr;
+    int_t *__restrict readFadeSampleL = nullptr;
+    int_t *__restrict readFadeSampleR = nullptr;
+    int_t loopEndBufferL[resampFIRSize], loopEndBufferR[resampFIRSize];
     float *__restrict readSampleLF32 = nullptr;
     float *__restrict readSampleRF32 = nullptr;
     float *__restrict readFadeSampleLF32 = nullptr;
@@ -634,9 +927,9 @@ void GeneratorSample(GeneratorState *__restrict GD, GeneratorIO *__restrict IO)
             if (fadeActive)
             {
                 auto fadeSamplePos{GD->loopLowerBound - (GD->loopUpperBound - SamplePos)};
-                readFadeSampleLF32 = SampleDataFL + fadeSamplePos - FIRoffset;
+                readFadeSampleLF32 = WrapDataFL + fadeSamplePos - FIRoffset;
                 if (stereo)
-                    readFadeSampleRF32 = SampleDataFR + fadeSamplePos - FIRoffset;
+                    readFadeSampleRF32 = WrapDataFR + fadeSamplePos - FIRoffset;
             }
 
             if (SamplePos >= WaveSize - resampFIRSize && SamplePos <= GD->loopUpperBound)
@@ -644,11 +937,12 @@ void GeneratorSample(GeneratorState *__restrict GD, GeneratorIO *__restrict IO)
                 for (int k = 0; k < resampFIRSize; ++k)
                 {
                     auto q = k + SamplePos - FIRoffset;
-                    if (q >= GD->loopUpperBound || q >= WaveSize)
+                    auto wrapped = q >= GD->loopUpperBound || q >= WaveSize;
+                    if (wrapped)
                         q -= LoopOffset;
-                    loopEndBufferLF32[k] = SampleDataFL[q];
+                    loopEndBufferLF32[k] = wrapped ? WrapDataFL[q] : SampleDataFL[q];
                     if (stereo)
-                        loopEndBufferRF32[k] = SampleDataFR[q];
+                        loopEndBufferRF32[k] = wrapped ? WrapDataFR[q] : SampleDataFR[q];
                 }
                 readSampleLF32 = loopEndBufferLF32;
                 if (stereo)
@@ -667,9 +961,9 @@ void GeneratorSample(GeneratorState *__restrict GD, GeneratorIO *__restrict IO)
             if (fadeActive)
             {
                 auto fadeSamplePos{GD->loopLowerBound - (GD->loopUpperBound - SamplePos)};
-                readFadeSampleL = SampleDataL + fadeSamplePos - FIRoffset;
+                readFadeSampleL = WrapDataL + fadeSamplePos - FIRoffset;
                 if (stereo)
-                    readFadeSampleR = SampleDataR + fadeSamplePos - FIRoffset;
+                    readFadeSampleR = WrapDataR + fadeSamplePos - FIRoffset;
             }
 
             if (SamplePos >= WaveSize - resampFIRSize && SamplePos <= GD->loopUpperBound)
@@ -677,12 +971,13 @@ void GeneratorSample(GeneratorState *__restrict GD, GeneratorIO *__restrict IO)
                 for (int k = 0; k < resampFIRSize; ++k)
                 {
                     auto q = k + SamplePos - FIRoffset;
-                    if (q >= GD->loopUpperBound || q >= WaveSize)
+                    auto wrapped = q >= GD->loopUpperBound || q >= WaveSize;
+                    if (wrapped)
                         q -= LoopOffset;
 
-                    loopEndBufferL[k] = SampleDataL[q];
+                    loopEndBufferL[k] = wrapped ? WrapDataL[q] : SampleDataL[q];
                     if (stereo)
-                        loopEndBufferR[k] = SampleDataR[q];
+                        loopEndBufferR[k] = wrapped ? WrapDataR[q] : SampleDataR[q];
                 }
                 readSampleL = loopEndBufferL;
                 if (stereo)
@@ -693,9 +988,111 @@ void GeneratorSample(GeneratorState *__restrict GD, GeneratorIO *__restrict IO)
 
     int NSamples = GD->blockSize;
 
+    /*
+     * Work out the range of positions where the per-sample advance below is a no-op
+     * apart from moving forward, that is no wrap, bounce, clamp, finish or loop end
+     * padding. While the next generatorKernelFrames positions all sit in here (and there
+     * is no crossfade, which only ever turns off within a block) we use the block kernels.
+     */
+    int freeRunLower{0}, freeRunUpper{-1};
+    {
+        bool looping{loopActive};
+        if constexpr (loopActive && loopWhileGated)
+        {
+            if constexpr (loopForward)
+                looping = GD->gated;
+            else
+                looping = GD->gated || (GD->direction != GD->directionAtOutset);
+        }
+        if (looping)
+        {
+            freeRunLower = GD->loopLowerBound + 1;
+            freeRunUpper = GD->loopUpperBound - 1;
+        }
+        else
+        {
+            freeRunLower = GD->playbackLowerBound;
+            freeRunUpper = GD->playbackUpperBound;
+        }
+        if constexpr (loopActive)
+        {
+            freeRunLower = std::max(freeRunLower, 0);
+            freeRunUpper = std::min(freeRunUpper, WaveSize - resampFIRSize - 1);
+        }
+        if (IO->unpadded)
+        {
+            // The block kernels read FIRoffset either side of each position
+            freeRunLower = std::max(freeRunLower, (int)FIRoffset);
+            freeRunUpper = std::min(freeRunUpper, WaveSize - (int)FIRoffset);
+        }
+    }
+    bool blockKernelAvailable = GD->interpolationType == InterpolationTypes::Sinc ||
+                                GD->interpolationType == InterpolationTypes::Linear;
+
     int i{0};
     for (i = 0; i < NSamples && !IsFinished; i++)
     {
+        if (blockKernelAvailable && !fadeActive && i + generatorKernelFrames <= NSamples &&
+            SamplePos >= freeRunLower && SamplePos <= freeRunUpper)
+        {
+            int32_t bPos[generatorKernelFrames + 1], bSub[generatorKernelFrames + 1];
+            bPos[0] = SamplePos;
+            bSub[0] = SampleSubPos;
+            for (int k = 1; k <= generatorKernelFrames; ++k)
+            {
+                auto sub = bSub[k - 1] + Ratio * Direction;
+                auto incr = sub >> 24;
+                bPos[k] = bPos[k - 1] + incr;
+                bSub[k] = sub - (incr << 24);
+            }
+
+            // Movement is monotonic across a run so the end points bound it
+            auto endPos = bPos[generatorKernelFrames];
+            if (endPos >= freeRunLower && endPos <= freeRunUpper)
+            {
+                using type_from_cond = typename std::conditional<fp, float, int_t>::type;
+                type_from_cond *data[2];
+                if constexpr (fp)
+                {
+                    data[0] = SampleDataFL;
+                    data[1] = stereo ? SampleDataFR : nullptr;
+                }
+                else
+                {
+                    data[0] = SampleDataL;
+                    data[1] = stereo ? SampleDataR : nullptr;
+                }
+                float *outs[2]{OutputL, stereo ? OutputR : nullptr};
+                static constexpr int nc = stereo ? 2 : 1;
+
+                if (GD->interpolationType == InterpolationTypes::Sinc)
+                    ProcessKernelBlock<InterpolationTypes::Sinc, type_from_cond, nc>(data, bPos,
+                                                                                     bSub, outs, i);
+                else
+                    ProcessKernelBlock<InterpolationTypes::Linear, type_from_cond, nc>(
+                        data, bPos, bSub, outs, i);
+
+                SamplePos = endPos;
+                SampleSubPos = bSub[generatorKernelFrames];
+                if constexpr (fp)
+                {
+                    readSampleLF32 = SampleDataFL + SamplePos - FIRoffset;
+                    if (stereo)
+                        readSampleRF32 = SampleDataFR + SamplePos - FIRoffset;
+                }
+                else
+                {
+                    readSampleL = SampleDataL + SamplePos - FIRoffset;
+                    if (stereo)
+                        readSampleR = SampleDataR + SamplePos - FIRoffset;
+                }
+
+                // the loop increment supplies the last one
+                i += generatorKernelFrames - 1;
+                continue;
+            }
+        }
+
 #define KPStereo(E, T, C, dataL, dataR, fadeL, fadeR)                                              \
     KernelProcessor<E, T, C, loopActive> kp{                                                       \
         SamplePos,  SampleSubPos, int32_t(m0),        i, {dataL, dataR}, {fadeL, fadeR},           \
@@ -708,7 +1105,7 @@ void GeneratorSample(GeneratorState *__restrict GD, GeneratorIO *__restrict IO)
         {fade},    fadeActive,   loopFade,    {OutputL}, IO};                                      \
     ks.ProcessKernel(GD);
 
-        using type_from_cond = typename std::conditional<fp, float, int16_t>::type;
+        using type_from_cond = typename std::conditional<fp, float, int_t>::type;
         type_from_cond *readL, *readFadeL, *readR, *readFadeR;
         if constexpr (fp)
         {
@@ -725,6 +1122,62 @@ void GeneratorSample(GeneratorState *__restrict GD, GeneratorIO *__restrict IO)
             readFadeR = readFadeSampleR;
         }
 
+        /*
+         * Unpadded data has no zeros either side of the sample for the kernel to read
+         * near the ends, so there we hand it a zero padded copy of its window instead.
+         * The loop end buffer is already built from in-range frames.
+         */
+        type_from_cond edgeBuffer[4][resampFIRSize];
+        if (IO->unpadded)
+        {
+            type_from_cond *baseL, *baseR, *wrapBaseL, *wrapBaseR, *loopEndL, *loopEndR;
+            if constexpr (fp)
+            {
+                baseL = SampleDataFL;
+                baseR = stereo ? SampleDataFR : nullptr;
+                wrapBaseL = WrapDataFL;
+                wrapBaseR = stereo ? WrapDataFR : nullptr;
+                loopEndL = loopEndBufferLF32;
+                loopEndR = loopEndBufferRF32;
+            }
+            else
+            {
+                baseL = SampleDataL;
+                baseR = stereo ? SampleDataR : nullptr;
+                wrapBaseL = WrapDataL;
+                wrapBaseR = stereo ? WrapDataR : nullptr;
+                loopEndL = loopEndBufferL;
+                loopEndR = loopEndBufferR;
+            }
+
+            auto padEdge = [WaveSize](type_from_cond *&read, type_from_cond *base,
+                                      type_from_cond *buffer) {
+                auto start = read - base;
+                if (start >= 0 && start + resampFIRSize <= WaveSize)
+                    return;
+                for (int k = 0; k < resampFIRSize; ++k)
+                {
+                    auto q = start + k;
+                    buffer[k] = (q >= 0 && q < WaveSize) ? base[q] : type_from_cond{};
+                }
+                read = buffer;
+            };
+
+            if (readL != loopEndL)
+                padEdge(readL, baseL, edgeBuffer[0]);
+            if (stereo && readR != loopEndR)
+                padEdge(readR, baseR, edgeBuffer[1]);
+            if constexpr (loopActive)
+            {
+                if (fadeActive && readFadeL)
+                {
+                    padEdge(readFadeL, wrapBaseL, edgeBuffer[2]);
+                    if (stereo)
+                        padEdge(readFadeR, wrapBaseR, edgeBuffer[3]);
+                }
+            }
+        }
+
         // 2. Resample
         unsigned int m0 = ((SampleSubPos >> 12) & 0xff0);
         if (stereo)
@@ -955,11 +1408,12 @@ void GeneratorSample(GeneratorState *__restrict GD, GeneratorIO *__restrict IO)
                     for (int k = 0; k < resampFIRSize; ++k)
                     {
                         auto q = k + SamplePos - FIRoffset;
-                        if (q >= GD->loopUpperBound || q >= WaveSize)
+                        auto wrapped = q >= GD->loopUpperBound || q >= WaveSize;
+                        if (wrapped)
                             q -= LoopOffset;
-                        loopEndBufferLF32[k] = SampleDataFL[q];
+                        loopEndBufferLF32[k] = wrapped ? WrapDataFL[q] : SampleDataFL[q];
                         if (stereo)
-                            loopEndBufferRF32[k] = SampleDataFR[q];
+                            loopEndBufferRF32[k] = wrapped ? WrapDataFR[q] : SampleDataFR[q];
                     }
                     readSampleLF32 = loopEndBufferLF32;
                     if (stereo)
@@ -974,9 +1428,9 @@ void GeneratorSample(GeneratorState *__restrict GD, GeneratorIO *__restrict IO)
                     if (fadeActive)
                     {
                         auto fadeSamplePos{GD->loopLowerBound - (GD->loopUpperBound - SamplePos)};
-                        readFadeSampleLF32 = SampleDataFL + fadeSamplePos - FIRoffset;
+                        readFadeSampleLF32 = WrapDataFL + fadeSamplePos - FIRoffset;
                         if (stereo)
-                            readFadeSampleRF32 = SampleDataFR + fadeSamplePos - FIRoffset;
+                            readFadeSampleRF32 = WrapDataFR + fadeSamplePos - FIRoffset;
                     }
                 }
             }
@@ -989,11 +1443,12 @@ void GeneratorSample(GeneratorState *__restrict GD, GeneratorIO *__restrict IO)
                     for (int k = 0; k < resampFIRSize; ++k)
                     {
                         auto q = k + SamplePos - FIRoffset;
-                        if (q >= GD->loopUpperBound || q >= WaveSize)
+                        auto wrapped = q >= GD->loopUpperBound || q >= WaveSize;
+                        if (wrapped)
                             q -= LoopOffset;
-                        loopEndBufferL[k] = SampleDataL[q];
+                        loopEndBufferL[k] = wrapped ? WrapDataL[q] : SampleDataL[q];
                         if (stereo)
-                            loopEndBufferR[k] = SampleDataR[q];
+                            loopEndBufferR[k] = wrapped ? WrapDataR[q] : SampleDataR[q];
                     }
                     readSampleL = loopEndBufferL;
                     if (stereo)
@@ -1008,9 +1463,9 @@ void GeneratorSample(GeneratorState *__restrict GD, GeneratorIO *__restrict IO)
                     if (fadeActive)
                     {
                         auto fadeSamplePos{GD->loopLowerBound - (GD->loopUpperBound - SamplePos)};
-                        readFadeSampleL = SampleDataL + fadeSamplePos - FIRoffset;
+                        readFadeSampleL = WrapDataL + fadeSamplePos - FIRoffset;
                         if (stereo)
-                            readFadeSampleR = SampleDataR + fadeSamplePos - FIRoffset;
+                            readFadeSampleR = WrapDataR + fadeSamplePos - FIRoffset;
                     }
                 }
             }
@@ -105,12 +105,40 @@ struct GeneratorIO
     void *__restrict sampleDataL{nullptr};
     void *__restrict sampleDataR{nullptr};
     int waveSize{0};
+    // If set, the sample data has no zero padding either side (as with a memory mapped
+    // sample) so the generator must not read outside [0, waveSize)
+    bool unpadded{false};
+    /*
+     * If set, reads which wrap back to the start of a forward loop (the loop crossfade and
+     * the loop end padding) come from here rather than sampleData. It is indexed the same
+     * way, by absolute sample position. A disk streamed voice uses this to play the loop
+     * end from one source while the crossfade reads the loop start from another.
+     */
+    void *loopWrapDataL{nullptr};
+    void *loopWrapDataR{nullptr};
+};
+
+// The in-memory formats a generator can read; these follow sample::Sample::BitDepth
+enum GeneratorSampleFormat
+{
+    GSF_I16,
+    GSF_F32,
+    GSF_I24, // packed, see PackedI24 in resampling.h
+    nGeneratorSampleFormats
 };
 
 typedef void (*GeneratorFPtr)(GeneratorState *__restrict, GeneratorIO *__restrict);
+
+/*
+ * How many of the next frames outputs a forward looping generator makes before it steps
+ * past the loop bound in its direction of play and wraps. At least one (if we are already
+ * past the bound the first step wraps) and at most frames.
+ */
+int framesBeforeLoopWrap(const GeneratorState *GD, int frames);
+
 // TODO Loop Mode should be an enum
-GeneratorFPtr GetFPtrGeneratorSample(bool isStereo, bool isFloat, bool loopActive, bool loopForward,
-                                     bool loopWhileGated);
+GeneratorFPtr GetFPtrGeneratorSample(bool isStereo, GeneratorSampleFormat format, bool loopActive,
+                                     bool loopForward, bool loopWhileGated);
 
 } // namespace scxt::dsp
 #endif // SCXT_SRC_DSP_GENERATOR_H
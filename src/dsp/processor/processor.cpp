@@ -295,9 +295,63 @@ void unspawnProcessor(Processor *f)
     if (!f)
         return;
 
+    f->releaseHeldBlocks();
     f->~Processor();
 }
 
+void preReserveProcessorMemory(ProcessorType id, engine::MemoryPool *mp)
+{
+    if (id == proct_none || !mp)
+        return;
+
+    alignas(16) uint8_t memory[processorMemoryBufferSize];
+    ProcessorStorage ps;
+    ps.type = id;
+    float f[maxProcessorFloatParams]{};
+    int i[maxProcessorIntParams]{};
+
+    // Processors reserve their blocks as they construct
+    for (auto os : {false, true})
+    {
+        auto *p =
+            spawnProcessorInPlace(id, mp, memory, processorMemoryBufferSize, ps, f, i, os, false);
+        unspawnProcessor(p);
+    }
+}
+
+bool Processor::holdReservedBlocks()
+{
+    if (!memoryPool)
+        return true;
+
+    for (int i = 0; i < 16 && preReserveSize[i] > 0; ++i)
+    {
+        if (heldBlocks[i])
+            continue;
+
+        heldBlocks[i] = memoryPool->checkoutBlock(preReserveSize[i]);
+        if (!heldBlocks[i])
+        {
+            memoryShortfall = true;
+            releaseHeldBlocks();
+            return false;
+        }
+    }
+    return true;
+}
+
+void Processor::releaseHeldBlocks()
+{
+    for (int i = 0; i < 16; ++i)
+    {
+        if (heldBlocks[i])
+        {
+            memoryPool->returnBlock(heldBlocks[i], preReserveSize[i]);
+            heldBlocks[i] = nullptr;
+        }
+    }
+}
+
 ProcessorControlDescription Processor::getControlDescription() const
 {
     ProcessorControlDescription res;
@@ -243,6 +243,18 @@ struct Processor : MoveableOnly<Processor>, SampleRateSupport
   public:
     size_t preReserveSize[16]{0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0};
 
+    /*
+     * The pool can't grow on the audio thread, so before init a voice or group takes a
+     * block for each size the processor reserved. If the pool is dry it gets false back
+     * and runs the slot bypassed rather than have init find a null block half way
+     * through. SCXTVFXConfig::checkoutBlock hands the held blocks out; any checkout the
+     * pool can't satisfy after that sets memoryShortfall.
+     */
+    uint8_t *heldBlocks[16]{};
+    bool memoryShortfall{false};
+    bool holdReservedBlocks();
+    void releaseHeldBlocks();
+
     ProcessorType getType() const { return myType; }
     std::string getName() const { return getProcessorName(getType()); }
 
@@ -337,6 +349,13 @@ Processor *spawnProcessorInPlace(ProcessorType id, engine::MemoryPool *mp, uint8
  */
 void unspawnProcessor(Processor *f);
 
+/**
+ * Make sure the memory pool holds the blocks a processor of this type reserves, plain
+ * or oversampled, by spawning throwaway ones. The pool can't grow on the audio thread,
+ * so call this before handing a new type to the audio thread.
+ */
+void preReserveProcessorMemory(ProcessorType id, engine::MemoryPool *mp);
+
 typedef uint8_t unimpl_t;
 template <ProcessorType ft> struct ProcessorImplementor
 {
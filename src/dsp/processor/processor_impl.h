@@ -50,6 +50,8 @@ template <int OSFactor> struct SCXTVFXConfig
         }
         else
         {
+            // Still constructing. setupProcessor reserves these, and holdReservedBlocks
+            // takes a block of each before init
             for (int i = 0; i < 16; ++i)
             {
                 if (b->preReserveSize[i] == 0)
@@ -64,7 +66,20 @@ template <int OSFactor> struct SCXTVFXConfig
     static uint8_t *checkoutBlock(BaseClass *b, size_t s)
     {
         assert(b->memoryPool);
-        return b->memoryPool->checkoutBlock(s);
+        for (int i = 0; i < 16; ++i)
+        {
+            if (b->heldBlocks[i] && b->preReserveSize[i] == s)
+            {
+                auto res = b->heldBlocks[i];
+                b->heldBlocks[i] = nullptr;
+                return res;
+            }
+        }
+
+        auto res = b->memoryPool->checkoutBlock(s);
+        if (!res)
+            b->memoryShortfall = true;
+        return res;
     }
 
     static void returnBlock(BaseClass *b, uint8_t *d, size_t s)
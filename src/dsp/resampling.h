@@ -37,5 +37,26 @@ static constexpr uint32_t FIRipol_M = 256;
 static constexpr uint32_t FIRipol_N = 16;
 static constexpr uint32_t FIRipolI16_N = 16;
 static constexpr uint32_t FIRoffset = 8;
+
+/*
+ * A packed 24 bit sample, as stored for Sample::BD_I24. These are three little endian
+ * bytes with no padding, so a PackedI24 * walks frames just like the short and float
+ * sample pointers do and the generator can index all three the same way.
+ */
+struct PackedI24
+{
+    uint8_t b[3];
+
+    // The value in the top 24 bits of an int32, which keeps the sign without a shift
+    int32_t toTopAlignedInt() const
+    {
+        return (int32_t)(((uint32_t)b[2] << 24) | ((uint32_t)b[1] << 16) | ((uint32_t)b[0] << 8));
+    }
+    int32_t toInt() const { return toTopAlignedInt() >> 8; }
+};
+static_assert(sizeof(PackedI24) == 3, "PackedI24 must not be padded");
+
+// Matches the scale load_data_i24 uses when it promotes to float
+static constexpr float I24InvScale = 1.f / (1 << 23);
 } // namespace scxt::dsp
 #endif // SCXT_SRC_DSP_RESAMPLING_H
@@ -26,65 +26,83 @@
  */
 
 #include "sample_analytics.h"
+#include <algorithm>
 #include <limits>
 #include <cmath>
+#include <vector>
 
 namespace scxt::dsp::sample_analytics
 {
-float computePeak(const std::shared_ptr<sample::Sample> &s)
+namespace
 {
-    float peak = 0.0f;
-    for (size_t i = 0; i < s->getSampleLength(); i++)
+float sampleValue(sample::Sample::BitDepth bd, const void *data, size_t i)
+{
+    switch (bd)
     {
-        for (int chan = 0; chan < s->channels; chan++)
-        {
-            float sample = 0.0;
-            switch (s->bitDepth)
-            {
-            case sample::Sample::BD_I16:
-                sample = static_cast<float>(s->GetSamplePtrI16(chan)[i]) /
-                         std::numeric_limits<int16_t>::max();
-                break;
-            case sample::Sample::BD_F32:
-                sample = s->GetSamplePtrF32(chan)[i];
-                break;
-            }
-            peak = std::max(peak, std::abs(sample));
-        }
+    case sample::Sample::BD_I16:
+        return static_cast<float>(((const int16_t *)data)[i]) /
+               std::numeric_limits<int16_t>::max();
+    case sample::Sample::BD_F32:
+        return ((const float *)data)[i];
+    case sample::Sample::BD_I24:
+        return ((const PackedI24 *)data)[i].toInt() * dsp::I24InvScale;
     }
-    return peak;
+    return 0.f;
 }
 
-float computeRMS(const std::shared_ptr<sample::Sample> &s)
+/*
+ * Call f with every sample of every channel. A disk streamed (or evicted) sample only
+ * holds its head in memory so we decode the rest from the file a chunk at a time. The
+ * audio thread can swap the resident data under us, so read it through a snapshot.
+ */
+template <typename F> void forEachSample(const sample::Sample &s, F &&f)
 {
-    float ms = 0.0f;
-    const float divisor_recip =
-        1.0f / (static_cast<float>(s->channels) * static_cast<float>(s->getSampleLength()));
-    for (size_t i = 0; i < s->getSampleLength(); i++)
+    static constexpr uint32_t chunkFrames{1 << 14};
+    auto bytes = sample::Sample::bitDepthByteSize(s.bitDepth);
+    auto rd = s.getResidentSnapshot();
+    auto streamed = rd.frames < s.getSampleLength();
+    std::vector<uint8_t> chunk;
+    if (streamed)
+        chunk.resize(chunkFrames * bytes);
+
+    for (int c = 0; c < s.channels; c++)
     {
-        for (int chan = 0; chan < s->channels; chan++)
+        // sampleData is padded by FIRoffset either side
+        auto *data = (const uint8_t *)rd.data[c] + FIRoffset * bytes;
+        for (size_t i = 0; i < rd.frames; i++)
+            f(sampleValue(s.bitDepth, data, i));
+
+        if (!streamed)
+            continue;
+        for (size_t p = rd.frames; p < s.getSampleLength(); p += chunkFrames)
         {
-            float sample = 0.0;
-            switch (s->bitDepth)
-            {
-            case sample::Sample::BD_I16:
-                sample = static_cast<float>(s->GetSamplePtrI16(chan)[i]) /
-                         std::numeric_limits<int16_t>::max();
-                break;
-            case sample::Sample::BD_F32:
-                sample = s->GetSamplePtrF32(chan)[i];
-                break;
-            }
-            ms += std::pow(sample, 2.0f) * divisor_recip;
+            auto n = (uint32_t)std::min((size_t)chunkFrames, s.getSampleLength() - p);
+            s.decodeStreamedFrames(c, p, n, chunk.data());
+            for (size_t i = 0; i < n; i++)
+                f(sampleValue(s.bitDepth, chunk.data(), i));
         }
     }
+}
+} // namespace
+
+float computePeak(const std::shared_ptr<sample::Sample> &s)
+{
+    float peak = 0.0f;
+    forEachSample(*s, [&peak](float sample) { peak = std::max(peak, std::abs(sample)); });
+    return peak;
+}
 
-    if (s->getSampleLength() > 0)
+float computeRMS(const std::shared_ptr<sample::Sample> &s)
+{
+    if (s->getSampleLength() == 0 || s->channels == 0)
     {
-        return std::sqrt(ms);
+        // What should the RMS of an empty sample be?
+        return 0.0f;
     }
 
-    // What should the RMS of an empty sample be?
-    return 0.0f;
+    // Long samples have a lot of terms, so sum them in double
+    double ms = 0.0;
+    forEachSample(*s, [&ms](float sample) { ms += (double)sample * sample; });
+    return (float)std::sqrt(ms / (static_cast<double>(s->channels) * s->getSampleLength()));
 }
 } // namespace scxt::dsp::sample_analytics
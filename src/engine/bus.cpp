@@ -27,6 +27,8 @@
 
 #include "bus.h"
 
+#include <limits>
+
 #include "configuration.h"
 
 #include "dsp/data_tables.h"
@@ -126,6 +128,32 @@ struct Config
     static inline float dbToLinear(GlobalStorage *s, float f) { return dsp::dbTable.dbToLinear(f); }
 };
 
+// Effects which report a ringout use it; others get a conservative default by type
+template <typename T, typename = void> struct HasRingoutDecay : std::false_type
+{
+};
+template <typename T>
+struct HasRingoutDecay<T, std::void_t<decltype(std::declval<T &>().getRingoutDecay())>>
+    : std::true_type
+{
+};
+
+inline float defaultTailSeconds(AvailableBusEffects t)
+{
+    switch (t)
+    {
+    case none:
+        return 0.f;
+    case reverb1:
+    case reverb2:
+    case nimbus:
+    case delay:
+        return 10.f;
+    default:
+        return 1.f;
+    }
+}
+
 template <typename T> struct Impl : T
 {
     static_assert(T::numParams <= BusEffectStorage::maxBusEffectParams);
@@ -152,6 +180,17 @@ template <typename T> struct Impl : T
     int numParams() const override { return T::numParams; }
 
     void onSampleRateChanged() override { T::onSampleRateChanged(); }
+
+    int tailLength() override
+    {
+        if constexpr (HasRingoutDecay<T>::value)
+        {
+            // ringout decay is in blocks, with -1 meaning it never rings out
+            auto r = T::getRingoutDecay();
+            return r < 0 ? -1 : r * blockSize;
+        }
+        return (int)(defaultTailSeconds(pes ? pes->type : none) * engine->getSampleRate());
+    }
 };
 
 } // namespace dtl
@@ -200,12 +239,14 @@ void Bus::setBusEffectType(Engine &e, int idx, scxt::engine::AvailableBusEffects
 {
     assert(idx >= 0 && idx < maxEffectsPerBus);
     busEffects[idx] = createEffect(t, &e, &busEffectStorage[idx]);
+    effectSleep[idx] = EffectSleepState();
     if (busEffects[idx])
         busEffects[idx]->init(true);
 }
 
 void Bus::initializeAfterUnstream(Engine &e)
 {
+    wakeAllEffects();
     for (int idx = 0; idx < maxEffectsPerBus; ++idx)
     {
         busEffects[idx] = createEffect(busEffectStorage[idx].type, &e, &busEffectStorage[idx]);
@@ -235,12 +276,40 @@ void Bus::process()
         memcpy(auxoutputPreFX, output, sizeof(output));
     }
 
+    auto isSilent = [this]() {
+        return mech::blockAbsMax<blockSize>(output[0]) < effectSleepThreshold &&
+               mech::blockAbsMax<blockSize>(output[1]) < effectSleepThreshold;
+    };
+
     int idx{0};
     for (auto &fx : busEffects)
     {
         if (fx && busEffectStorage[idx].isActive)
         {
-            fx->process(output[0], output[1]);
+            auto &sl = effectSleep[idx];
+            auto inputSilent = isSilent();
+            // Only count towards sleep while awake, and saturate so an effect whose tail
+            // never ends can sit on a silent bus indefinitely without wrapping
+            if (inputSilent)
+            {
+                if (!sl.asleep &&
+                    sl.silentInputSamples <= std::numeric_limits<int32_t>::max() - blockSize)
+                    sl.silentInputSamples += blockSize;
+            }
+            else
+                sl.silentInputSamples = 0;
+
+            if (!sl.asleep || !inputSilent)
+            {
+                sl.asleep = false;
+                fx->process(output[0], output[1]);
+
+                if (inputSilent)
+                {
+                    auto tl = fx->tailLength();
+                    sl.asleep = tl >= 0 && sl.silentInputSamples >= tl && isSilent();
+                }
+            }
         }
         idx++;
     }
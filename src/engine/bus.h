@@ -118,6 +118,8 @@ struct BusEffect
     virtual datamodel::pmd paramAt(int i) const = 0;
     virtual int numParams() const = 0;
     virtual void onSampleRateChanged() = 0;
+    // How long this effect rings after its input goes silent, in samples. -1 is forever
+    virtual int tailLength() = 0;
 };
 
 std::unique_ptr<BusEffect> createEffect(AvailableBusEffects p, Engine *e, BusEffectStorage *s);
@@ -142,6 +144,7 @@ struct Bus : MoveableOnly<Bus>, SampleRateSupport
             busEffectStorage[i] = BusEffectStorage();
             busEffects[i].reset();
         }
+        wakeAllEffects();
     }
 
     float output alignas(16)[2][blockSize];
@@ -163,6 +166,31 @@ struct Bus : MoveableOnly<Bus>, SampleRateSupport
 
     void process();
 
+    /*
+     * Bus effects go to sleep once their input has been silent for longer than their
+     * tailLength and their output has decayed to silence, and wake on the first block
+     * with signal at their input. A sleeping effect passes its (silent) input through.
+     */
+    static constexpr float effectSleepThreshold{1e-6f};
+    struct EffectSleepState
+    {
+        bool asleep{false};
+        int32_t silentInputSamples{0};
+    };
+    std::array<EffectSleepState, maxEffectsPerBus> effectSleep{};
+    void wakeAllEffects()
+    {
+        for (auto &s : effectSleep)
+            s = EffectSleepState();
+    }
+    int32_t sleepingEffectCount() const
+    {
+        int32_t res{0};
+        for (const auto &s : effectSleep)
+            res += s.asleep;
+        return res;
+    }
+
     void setAuxSendLevel(int idx, float slevel)
     {
         assert(idx >= 0 && idx < maxSendsPerBus);
@@ -75,6 +75,7 @@ Engine::Engine()
     sampleManager = std::make_unique<sample::SampleManager>(messageController->threadingChecker);
     patch = std::make_unique<Patch>();
     patch->parentEngine = this;
+    patch->seedPartRandom();
 
     auto tdp = setupUserStorageDirectory();
     if (tdp.has_value())
@@ -86,7 +87,65 @@ Engine::Engine()
                 SCLOG("Defaults Parse Error :" << em << " " << t << std::endl);
             });
 
+        if (defaults->getUserDefaultValue(infrastructure::DefaultKeys::useDiskStreaming, 0) == 1)
+        {
+            sampleManager->enableDiskStreaming();
+        }
+        sampleManager->packI24Samples =
+            defaults->getUserDefaultValue(infrastructure::DefaultKeys::packI24Samples, 0) == 1;
+        sampleManager->mapWavSamples =
+            defaults->getUserDefaultValue(infrastructure::DefaultKeys::useMemoryMappedSamples,
+                                          0) == 1;
+        sampleManager->useSharedSampleStore =
+            defaults->getUserDefaultValue(infrastructure::DefaultKeys::shareSamplesAcrossInstances,
+                                          0) == 1;
+
+        // 0 means no budget. This needs disk streaming, enabled above.
+        auto budgetMB =
+            defaults->getUserDefaultValue(infrastructure::DefaultKeys::sampleMemoryBudgetMB, 0);
+        if (budgetMB > 0)
+        {
+            sampleManager->setMemoryBudget((uint64_t)budgetMB << 20);
+        }
+
+        auto cacheMB =
+            defaults->getUserDefaultValue(infrastructure::DefaultKeys::decodedSampleCacheMB, 0);
+        if (cacheMB > 0)
+        {
+            sampleManager->enableDecodedSampleCache(*tdp / "DecodedSampleCache",
+                                                    (uint64_t)cacheMB << 20);
+        }
+
+        auto renderThreads =
+            defaults->getUserDefaultValue(infrastructure::DefaultKeys::partRenderThreads, 0);
+        if (renderThreads > 0)
+        {
+            partRenderPool = std::make_unique<PartRenderPool>(*this, renderThreads);
+        }
+
+        polyphony.engineVoiceLimit = std::clamp(
+            defaults->getUserDefaultValue(infrastructure::DefaultKeys::voiceLimit,
+                                          (int)polyphony.engineVoiceLimit),
+            1, (int)maxVoices);
+        polyphony.stealingMode = (VoiceStealingMode)std::clamp(
+            defaults->getUserDefaultValue(infrastructure::DefaultKeys::voiceStealingMode,
+                                          (int)polyphony.stealingMode),
+            (int)STEAL_OLDEST, (int)STEAL_RELEASED_FIRST);
+        setVoiceSilenceThresholdDb(defaults->getUserDefaultValue(
+            infrastructure::DefaultKeys::voiceSilenceThresholdDb, -96));
+        polyphony.cpuGovernorTarget = std::clamp(
+            defaults->getUserDefaultValue(infrastructure::DefaultKeys::cpuGovernorTarget, 0), 0,
+            100);
+
         browserDb = std::make_unique<browser::BrowserDB>(*tdp);
+        sampleManager->md5CacheLookup = [db = browserDb.get()](const auto &p, auto size,
+                                                               auto mtime) {
+            return db->getCachedMD5(p, size, mtime);
+        };
+        sampleManager->md5CacheStore = [db = browserDb.get()](const auto &p, auto size,
+                                                              auto mtime, const auto &md5) {
+            db->cacheMD5(p, size, mtime, md5);
+        };
         browser = std::make_unique<browser::Browser>(
             *browserDb, *defaults, *tdp,
             [this](const auto &a, const auto &b) { messageController->reportErrorToClient(a, b); });
@@ -98,6 +157,9 @@ Engine::Engine()
 
     for (auto &v : voices)
         v = nullptr;
+    for (auto i = 0U; i < maxVoices; ++i)
+        freeVoiceSlots[i] = (int16_t)(maxVoices - 1 - i);
+    freeVoiceSlotCount = maxVoices;
 
     voiceInPlaceBuffer.reset(new uint8_t[sizeof(scxt::voice::Voice) * maxVoices]);
 
@@ -105,6 +167,13 @@ Engine::Engine()
     selectionManager = std::make_unique<selection::SelectionManager>(*this);
 
     memoryPool = std::make_unique<MemoryPool>();
+    memoryPool->requestRefill = [this]() {
+        // Only the realtime threads ask; everyone else grows the pool inline
+        messaging::audio::AudioToSerialization a2s;
+        a2s.id = messaging::audio::a2s_memory_pool_refill;
+        a2s.payloadType = messaging::audio::AudioToSerialization::NONE;
+        messageController->sendAudioToSerialization(a2s);
+    };
 
     voice::Voice::ahdsrenv_t::initializeLuts();
 
@@ -127,6 +196,9 @@ Engine::Engine()
 
 Engine::~Engine()
 {
+    // Stop the render workers before we start tearing down what they render
+    partRenderPool.reset();
+
     for (auto &v : voices)
     {
         if (v)
@@ -161,47 +233,400 @@ voice::Voice *Engine::initiateVoice(const pathToZone_t &path)
 #endif
 
     assert(zoneByPath(path));
-    for (const auto &[idx, v] : sst::cpputils::enumerate(voices))
+    if (!makeRoomForVoice(*zoneByPath(path)) || freeVoiceSlotCount == 0)
+        return nullptr;
+
+    auto idx = freeVoiceSlots[--freeVoiceSlotCount];
+    auto *v = voices[idx];
+    assert(!v || !v->isVoiceAssigned);
+
+    std::unique_ptr<voice::modulation::MatrixEndpoints> mp;
+    if (v)
+    {
+        mp = std::move(voices[idx]->endpoints);
+        voices[idx]->~Voice();
+    }
+    else
+    {
+        mp = std::move(allEndpoints[idx]);
+    }
+    auto *dp = voiceInPlaceBuffer.get() + idx * sizeof(voice::Voice);
+    const auto &z = zoneByPath(path);
+    voices[idx] = new (dp) voice::Voice(this, z.get());
+    voices[idx]->voiceSlot = idx;
+    voices[idx]->zonePath = path;
+    voices[idx]->channel = path.channel;
+    voices[idx]->key = path.key;
+    voices[idx]->noteId = path.noteid;
+    voices[idx]->startOffset = (int16_t)eventSampleOffset;
+    voices[idx]->setSampleRate(sampleRate, sampleRateInv);
+    voices[idx]->endpoints = std::move(mp);
+    activeVoices++;
+    return voices[idx];
+}
+
+void Engine::addVoiceToKeyIndex(voice::Voice *v)
+{
+    auto &head = voicesByChannelKey[voiceIndexBucket(v->channel, v->originalMidiKey)];
+    v->prevKeyVoice = nullptr;
+    v->nextKeyVoice = head;
+    if (head)
+        head->prevKeyVoice = v;
+    head = v;
+}
+
+void Engine::onVoiceCleanedUp(voice::Voice *v)
+{
+    if (v->prevKeyVoice)
+        v->prevKeyVoice->nextKeyVoice = v->nextKeyVoice;
+    else
+    {
+        auto &head = voicesByChannelKey[voiceIndexBucket(v->channel, v->originalMidiKey)];
+        assert(head == v);
+        head = v->nextKeyVoice;
+    }
+    if (v->nextKeyVoice)
+        v->nextKeyVoice->prevKeyVoice = v->prevKeyVoice;
+    v->prevKeyVoice = nullptr;
+    v->nextKeyVoice = nullptr;
+
+    assert(v->voiceSlot >= 0 && freeVoiceSlotCount < maxVoices);
+    freeVoiceSlots[freeVoiceSlotCount++] = v->voiceSlot;
+
+    if (v->isBeingStolen)
+    {
+        assert(stealingVoices > 0);
+        stealingVoices--;
+    }
+}
+
+int32_t Engine::effectiveEngineVoiceLimit() const
+{
+    auto res = std::clamp(polyphony.engineVoiceLimit, (int32_t)1, (int32_t)maxVoices);
+    if (polyphony.cpuGovernorTarget > 0)
+        res = std::min(res, governorVoiceCap);
+    return res;
+}
+
+bool Engine::makeRoomForVoice(const Zone &z)
+{
+    auto *g = z.parentGroup;
+    auto *p = g->parentPart;
+
+    // Narrowest scope first, since a steal there also frees room in the wider ones
+    auto gl = g->outputInfo.polyphonyLimit;
+    while (gl > 0 && g->polyphonyVoices >= (uint32_t)gl)
     {
-        if (!v || !v->isVoiceAssigned)
+        auto v = chooseVoiceToSteal(nullptr, g);
+        if (!v)
+            return false;
+        stealVoice(v);
+    }
+
+    auto pl = p->configuration.polyphonyLimit;
+    while (pl > 0 && p->polyphonyVoices >= (uint32_t)pl)
+    {
+        auto v = chooseVoiceToSteal(p, nullptr);
+        if (!v)
+            return false;
+        stealVoice(v);
+    }
+
+    auto el = (uint32_t)effectiveEngineVoiceLimit();
+    while (activeVoices - stealingVoices >= el)
+    {
+        auto v = chooseVoiceToSteal(nullptr, nullptr);
+        if (!v)
+            return false;
+        stealVoice(v);
+    }
+
+    if (freeVoiceSlotCount == 0)
+    {
+        // Every slot is held, so some are fading after a steal. Cut the quietest of those
+        voice::Voice *cut{nullptr};
+        for (auto v : voices)
         {
-            std::unique_ptr<voice::modulation::MatrixEndpoints> mp;
-            if (v)
+            if (v && v->isVoiceAssigned && v->isBeingStolen &&
+                (!cut || v->stealFadeLevel < cut->stealFadeLevel))
             {
-                mp = std::move(voices[idx]->endpoints);
-                voices[idx]->~Voice();
+                cut = v;
             }
-            else
+        }
+        if (!cut)
+            return false;
+        cut->isVoicePlaying = false;
+        cut->cleanupVoice();
+    }
+    return true;
+}
+
+voice::Voice *Engine::chooseVoiceToSteal(const Part *inPart, const Group *inGroup) const
+{
+    // Lowest (primary, start order) is stolen first
+    voice::Voice *res{nullptr};
+    std::pair<float, uint64_t> resScore{};
+    for (auto v : voices)
+    {
+        if (!v || !v->isVoiceAssigned || v->isBeingStolen || !v->zone)
+            continue;
+
+        const auto *g = v->zone->parentGroup;
+        if ((inGroup && g != inGroup) || (inPart && g->parentPart != inPart))
+            continue;
+
+        std::pair<float, uint64_t> score{0.f, v->voiceStartOrder};
+        switch (polyphony.stealingMode)
+        {
+        case STEAL_OLDEST:
+            break;
+        case STEAL_QUIETEST:
+            score.first = v->aeg.outputCache[blockSize - 1];
+            break;
+        case STEAL_RELEASED_FIRST:
+            score.first = v->isGated ? 1.f : 0.f;
+            break;
+        }
+
+        if (!res || score < resScore)
+        {
+            res = v;
+            resScore = score;
+        }
+    }
+    return res;
+}
+
+void Engine::stealVoice(voice::Voice *v)
+{
+    assert(v->isVoiceAssigned && !v->isBeingStolen && v->zone);
+    auto *g = v->zone->parentGroup;
+    assert(g->polyphonyVoices && g->parentPart->polyphonyVoices);
+    g->polyphonyVoices--;
+    g->parentPart->polyphonyVoices--;
+
+    v->beginStealFade(stealFadeTimeSeconds);
+    stealingVoices++;
+    stolenVoiceCount++;
+}
+
+void Engine::runPolyphonyGovernor(double blockLoad)
+{
+    governorLoad =
+        governorLoad * governorLoadSmoothing + blockLoad * (1.0 - governorLoadSmoothing);
+    if (governorSettleCountdown > 0)
+        governorSettleCountdown--;
+    if (++governorBlockCounter < governorBlockInterval)
+        return;
+    governorBlockCounter = 0;
+
+    auto target = polyphony.cpuGovernorTarget;
+    auto minVoices = std::max(polyphony.cpuGovernorMinVoices, (int32_t)1);
+    auto sounding = (int32_t)(activeVoices - stealingVoices);
+    if (governorLoad > target && sounding > minVoices)
+    {
+        // The load still includes the voices we shed last time
+        if (governorSettleCountdown > 0)
+            return;
+
+        // Shed roughly in proportion to the overload, but always at least one voice
+        auto want = (int32_t)(sounding * target / governorLoad);
+        governorVoiceCap = std::max(minVoices, std::min(want, sounding - 1));
+        while ((int32_t)(activeVoices - stealingVoices) > governorVoiceCap)
+        {
+            auto v = chooseVoiceToSteal(nullptr, nullptr);
+            if (!v)
+                break;
+            stealVoice(v);
+        }
+        governorSettleCountdown = governorSettleBlocks;
+    }
+    else if (governorLoad < target * 0.8 && governorVoiceCap < maxVoices)
+    {
+        governorVoiceCap =
+            std::min((int32_t)maxVoices, governorVoiceCap + std::max(1, governorVoiceCap / 8));
+    }
+}
+size_t Engine::findZone(int16_t channel, int16_t key, int32_t noteId, int16_t velocity,
+                        std::array<pathToZone_t, maxVoices> &res)
+{
+    auto *zli = zoneLookupIndex.get();
+    if (!zli || zli->generation != zoneLookupGeneration || key < 0 ||
+        key >= ZoneLookupIndex::numKeys)
+    {
+        return findZoneByScan(channel, key, noteId, velocity, res);
+    }
+
+    size_t idx{0};
+    for (const auto &[pidx, part] : sst::cpputils::enumerate(*patch))
+    {
+        if (!part->configuration.mute &&
+            (part->configuration.channel == channel ||
+             part->configuration.channel == Part::PartConfiguration::omniChannel))
+        {
+            const auto &r = zli->ranges[pidx][key];
+            for (auto i = r.begin; i < r.end && idx < res.size(); ++i)
             {
-                mp = std::move(allEndpoints[idx]);
+                const auto &en = zli->entries[i];
+                if (en.zonePtr->mapping.velocityRange.includes(velocity))
+                {
+                    res[idx] = {(size_t)pidx, en.group, en.zone, channel, key, noteId};
+                    idx++;
+                }
             }
-            auto *dp = voiceInPlaceBuffer.get() + idx * sizeof(voice::Voice);
-            const auto &z = zoneByPath(path);
-            voices[idx] = new (dp) voice::Voice(this, z.get());
-            voices[idx]->zonePath = path;
-            voices[idx]->channel = path.channel;
-            voices[idx]->key = path.key;
-            voices[idx]->noteId = path.noteid;
-            voices[idx]->setSampleRate(sampleRate, sampleRateInv);
-            voices[idx]->endpoints = std::move(mp);
-            activeVoices++;
-            return voices[idx];
         }
     }
-    return nullptr;
+    return idx;
 }
-void Engine::releaseVoice(int16_t channel, int16_t key, int32_t noteId, int32_t releaseVelocity)
+
+size_t Engine::findZoneByScan(int16_t channel, int16_t key, int32_t noteId, int16_t velocity,
+                              std::array<pathToZone_t, maxVoices> &res)
 {
-    for (auto &v : voices)
+    size_t idx{0};
+    for (const auto &[pidx, part] : sst::cpputils::enumerate(*patch))
     {
-        if (v && v->isVoiceAssigned && (v->originalMidiKey == key || key == -1) &&
-            (v->channel == channel || channel == -1 || v->channel == -1) &&
-            (v->noteId == noteId || v->noteId == -1 || noteId == -1))
+        if (!part->configuration.mute &&
+            (part->configuration.channel == channel ||
+             part->configuration.channel == Part::PartConfiguration::omniChannel))
         {
-            v->release();
+            for (const auto &[gidx, group] : sst::cpputils::enumerate(*part))
+            {
+                for (const auto &[zidx, zone] : sst::cpputils::enumerate(*group))
+                {
+                    if (zone->mapping.keyboardRange.includes(key) &&
+                        zone->mapping.velocityRange.includes(velocity) && idx < res.size())
+                    {
+                        res[idx] = {(size_t)pidx, (size_t)gidx, (size_t)zidx,
+                                    channel,      key,          noteId};
+                        idx++;
+                    }
+                }
+            }
+        }
+    }
+    return idx;
+}
+
+void Engine::updateZoneLookupIfNeeded()
+{
+    assert(messageController->threadingChecker.isSerialThread());
+
+    auto gen = zoneLookupGeneration.load();
+    if (gen == zoneLookupBuiltGeneration)
+        return;
+
+    auto nidx = std::make_unique<ZoneLookupIndex>();
+    {
+        std::lock_guard<std::mutex> g(modifyStructureMutex);
+        nidx->build(*patch, gen);
+    }
+    zoneLookupBuiltGeneration = gen;
+
+    /*
+     * If the structure changed while we were building, the index will carry the
+     * old generation and be ignored by findZone, and we will come around again
+     * next time the serialization thread loops.
+     */
+    messageController->scheduleAudioThreadCallback([ni = nidx.release()](auto &e) {
+        auto old = e.zoneLookupIndex.release();
+        e.zoneLookupIndex.reset(ni);
+
+        if (old)
+        {
+            messaging::audio::AudioToSerialization a2s;
+            a2s.id = messaging::audio::a2s_delete_this_pointer;
+            a2s.payloadType = messaging::audio::AudioToSerialization::TO_BE_DELETED;
+            a2s.payload.delThis.ptr = old;
+            a2s.payload.delThis.type =
+                messaging::audio::AudioToSerialization::ToBeDeleted::engine_ZoneLookupIndex;
+            e.getMessageController()->sendAudioToSerialization(a2s);
+        }
+    });
+}
+
+void Engine::updateSampleResidencyIfNeeded()
+{
+    assert(messageController->threadingChecker.isSerialThread());
+
+    for (const auto &c : sampleManager->updateResidency())
+    {
+        messageController->scheduleAudioThreadCallback(
+            [c](auto &e) { e.applySampleResidencyChange(c); },
+            [c](const auto &e) { e.getSampleManager()->residencyChangeDone(c); });
+    }
+}
+
+void Engine::applySampleResidencyChange(const sample::SampleManager::ResidencyChange &c)
+{
+    assert(messageController->threadingChecker.isAudioThread());
+
+    auto plays = [&c](const voice::Voice *v) {
+        return v && v->isVoiceAssigned && v->playsSample(c.sample);
+    };
+
+    if (!c.toFullyResident)
+    {
+        // A voice playing a fully resident sample reads it through raw pointers
+        for (const auto *v : voices)
+        {
+            if (plays(v))
+                return;
+        }
+        c.sample->swapResidentData(*c.replacement);
+        c.sample->diskStreamer = sampleManager->getDiskStreamer().get();
+        c.sample->isEvicted = true;
+        return;
+    }
+
+    c.sample->swapResidentData(*c.replacement);
+    c.sample->isEvicted = false;
+    for (auto *v : voices)
+    {
+        if (plays(v))
+            v->sampleResidencyChanged();
+    }
+}
+
+void Engine::releaseVoice(int16_t channel, int16_t key, int32_t noteId, int32_t releaseVelocity)
+{
+    auto matches = [=](const voice::Voice *v) {
+        return v && v->isVoiceAssigned && (v->originalMidiKey == key || key == -1) &&
+               (v->channel == channel || channel == -1 || v->channel == -1) &&
+               (v->noteId == noteId || v->noteId == -1 || noteId == -1);
+    };
+    auto doRelease = [&](voice::Voice *v) {
+        v->release();
 #if DEBUG_VOICE_LIFECYCLE
-            SCLOG("Release Voice at " << SCDBGV(key));
+        SCLOG("Release Voice at " << SCDBGV(key));
 #endif
+    };
+
+    if (key < 0 || key >= (int16_t)voiceIndexKeys || channel < 0)
+    {
+        // Wildcards have to look at everyone
+        for (auto &v : voices)
+        {
+            if (matches(v))
+                doRelease(v);
+        }
+    }
+    else
+    {
+        // Our exact channel, plus voices which have no channel
+        auto b0 = voiceIndexBucket(channel, key);
+        auto b1 = voiceIndexBucket(-1, key);
+        for (auto v = voicesByChannelKey[b0]; v; v = v->nextKeyVoice)
+        {
+            if (matches(v))
+                doRelease(v);
+        }
+        if (b1 != b0)
+        {
+            for (auto v = voicesByChannelKey[b1]; v; v = v->nextKeyVoice)
+            {
+                if (matches(v))
+                    doRelease(v);
+            }
         }
     }
 
@@ -252,6 +677,10 @@ bool Engine::processAudio()
 #if BUILD_IS_DEBUG
     messageController->threadingChecker.registerAsAudioThread();
 #endif
+    // The clients set this as their audio callbacks start; this catches hosts which
+    // move us between threads
+    MemoryPool::isRealtimeThread = true;
+    eventSampleOffset = 0;
     messageController->engineProcessRuns++;
     messageController->isAudioRunning = true;
     auto av = (uint32_t)activeVoices;
@@ -318,6 +747,9 @@ bool Engine::processAudio()
 
     getPatch()->process(*this);
 
+    // Any part render workers have joined by now, so we are the only sender
+    memoryPool->dispatchRefillRequest();
+
     auto &bl = sharedUIMemoryState.busVULevels;
     const auto &bs = getPatch()->busses;
     for (int c = 0; c < 2; ++c)
@@ -387,6 +819,17 @@ bool Engine::processAudio()
     //  or...
     auto pct = time_span.count() * sampleRate * blockSizeInv * 100.0;
     sharedUIMemoryState.cpuLevel = std::max(sharedUIMemoryState.cpuLevel * 0.9995, pct);
+    if (polyphony.cpuGovernorTarget > 0)
+    {
+        runPolyphonyGovernor(pct);
+    }
+
+    const auto &ds = sampleManager->getDiskStreamer();
+    if (ds)
+    {
+        sharedUIMemoryState.diskStreamUnderruns = ds->underrunCount.load();
+        sharedUIMemoryState.diskStreamStarvedVoices = ds->acquireFailures.load();
+    }
     return true;
 }
 
@@ -684,7 +1127,7 @@ void Engine::loadSf2MultiSampleIntoSelectedPart(const fs::path &p)
     {
         auto riff = std::make_unique<RIFF::File>(p.u8string());
         auto sf = std::make_unique<sf2::File>(riff.get());
-        auto md5 = infrastructure::createMD5SumFromFile(p);
+        auto md5 = sampleManager->md5ForFile(p);
 
         auto pt = getSelectionManager()->selectedPart;
 
@@ -945,11 +1388,12 @@ void Engine::onTransportUpdated()
 
 void Engine::updateTransportPhasors()
 {
-    float mul = 1 << ((numTransportPhasors - 1) / 2);
+    // In double since voices derive their phasors from these relative to their start
+    double mul = 1 << ((numTransportPhasors - 1) / 2);
     for (int i = 0; i < numTransportPhasors; ++i)
     {
-        float rawBeat;
-        transportPhasors[i] = std::modf((float)(transport.timeInBeats) * mul, &rawBeat);
+        double rawBeat;
+        transportPhasors[i] = (float)std::modf(transport.timeInBeats * mul, &rawBeat);
         mul = mul / 2;
     }
 }
@@ -41,6 +41,7 @@
 #include "sample/sample.h"
 #include "sample/sample_manager.h"
 
+#include <algorithm>
 #include <filesystem>
 #include <memory>
 #include <set>
@@ -55,6 +56,8 @@
 #include "modulation/voice_matrix.h"
 #include "modulation/group_matrix.h"
 #include "transport.h"
+#include "zone_lookup.h"
+#include "part_render_pool.h"
 
 #define DEBUG_VOICE_LIFECYCLE 0
 
@@ -118,8 +121,6 @@ struct Engine : MoveableOnly<Engine>, SampleRateSupport
      * blockSize sample block
      */
 
-    // TODO: This is obviusly a pretty inefficient search method. We can definitel
-    // pre-cache some of this lookup when the patch mutates
     struct pathToZone_t
     {
         size_t part{0};
@@ -130,33 +131,34 @@ struct Engine : MoveableOnly<Engine>, SampleRateSupport
         int16_t key{-1};
         int32_t noteid{-1};
     };
+    /**
+     * Find the zones which respond to a channel / key / velocity. This uses the
+     * precomputed ZoneLookupIndex when it matches the current structure generation
+     * and falls back to a full walk of the patch otherwise.
+     */
     size_t findZone(int16_t channel, int16_t key, int32_t noteId, int16_t velocity,
-                    std::array<pathToZone_t, maxVoices> &res)
-    {
-        size_t idx{0};
-        for (const auto &[pidx, part] : sst::cpputils::enumerate(*patch))
-        {
-            if (!part->configuration.mute &&
-                (part->configuration.channel == channel ||
-                 part->configuration.channel == Part::PartConfiguration::omniChannel))
-            {
-                for (const auto &[gidx, group] : sst::cpputils::enumerate(*part))
-                {
-                    for (const auto &[zidx, zone] : sst::cpputils::enumerate(*group))
-                    {
-                        if (zone->mapping.keyboardRange.includes(key) &&
-                            zone->mapping.velocityRange.includes(velocity))
-                        {
-                            res[idx] = {(size_t)pidx, (size_t)gidx, (size_t)zidx,
-                                        channel,      key,          noteId};
-                            idx++;
-                        }
-                    }
-                }
-            }
-        }
-        return idx;
-    }
+                    std::array<pathToZone_t, maxVoices> &res);
+    size_t findZoneByScan(int16_t channel, int16_t key, int32_t noteId, int16_t velocity,
+                          std::array<pathToZone_t, maxVoices> &res);
+
+    /*
+     * Any change to the part / group / zone structure or to a zone keyboard
+     * range needs to call this so note lookup doesn't use a stale index. It is
+     * safe from any thread. The serialization thread calls updateZoneLookupIfNeeded
+     * each time through its loop to rebuild and hand the new index to the audio thread.
+     */
+    void invalidateZoneLookup() { zoneLookupGeneration++; }
+    void updateZoneLookupIfNeeded();
+
+    /*
+     * Sample memory budget. The serialization thread calls updateSampleResidencyIfNeeded
+     * each time through its loop to hand the sample manager's finished evictions and
+     * reloads to the audio thread, which swaps them in with applySampleResidencyChange.
+     * That declines to evict a sample a voice is playing, and moves voices playing a
+     * reloaded sample off their streams.
+     */
+    void updateSampleResidencyIfNeeded();
+    void applySampleResidencyChange(const sample::SampleManager::ResidencyChange &);
 
     tuning::MidikeyRetuner midikeyRetuner;
 
@@ -171,6 +173,22 @@ struct Engine : MoveableOnly<Engine>, SampleRateSupport
         Engine &engine;
         std::array<pathToZone_t, maxVoices> findZoneWorkingBuffer;
 
+        /*
+         * The voice manager asks for a voice count then initializes voices for the
+         * same note, so we hold onto the last search result to avoid finding twice.
+         */
+        struct LastFindZone
+        {
+            bool valid{false};
+            uint16_t channel{0}, key{0};
+            int32_t noteId{-1};
+            int16_t velocity{-1};
+            uint64_t generation{0};
+            size_t count{0};
+        } lastFindZone;
+        size_t findZoneCached(uint16_t channel, uint16_t key, int32_t noteId, int16_t velocity,
+                              bool consume);
+
         VoiceManagerResponder(Engine &e) : engine(e) {}
 
         std::function<void(voice::Voice *)> voiceEndCallback{nullptr};
@@ -233,6 +251,75 @@ struct Engine : MoveableOnly<Engine>, SampleRateSupport
     void releaseAllVoices();
     void stopAllSounds();
 
+    /*
+     * Voices join the (channel, key) index when they start and leave it, handing their
+     * slot back, when they clean up. Audio thread only.
+     */
+    void addVoiceToKeyIndex(voice::Voice *v);
+    void onVoiceCleanedUp(voice::Voice *v);
+
+    /*
+     * Polyphony limits and voice stealing. Groups and parts can carry a polyphony limit
+     * and the engine has one of its own. When a new voice would go past any of them we
+     * steal a voice in that scope, which then fades out over stealFadeTimeSeconds rather
+     * than clicking off. A stolen voice stops counting against limits right away but keeps
+     * its slot until the fade completes, so the engine limit defaults to a little under
+     * maxVoices to leave room for those fades.
+     *
+     * The optional CPU governor lowers the effective engine limit when the render load
+     * sits above cpuGovernorTarget (percent of the block; 0 is off) and lets it recover
+     * once the load drops again.
+     */
+    enum VoiceStealingMode : int16_t
+    {
+        STEAL_OLDEST,
+        STEAL_QUIETEST,
+        STEAL_RELEASED_FIRST
+    };
+    static constexpr uint16_t stealFadeHeadroom{16};
+    static constexpr float stealFadeTimeSeconds{0.005f};
+    struct PolyphonySettings
+    {
+        int32_t engineVoiceLimit{maxVoices - stealFadeHeadroom};
+        VoiceStealingMode stealingMode{STEAL_RELEASED_FIRST};
+        float cpuGovernorTarget{0.f};
+        int32_t cpuGovernorMinVoices{8};
+    } polyphony;
+
+    /*
+     * Called by initiateVoice. Returns false if the zone can't get a voice since one of
+     * its limits is full and there is nothing left to steal in that scope.
+     */
+    bool makeRoomForVoice(const Zone &z);
+    voice::Voice *chooseVoiceToSteal(const Part *inPart, const Group *inGroup) const;
+    void stealVoice(voice::Voice *v);
+    int32_t effectiveEngineVoiceLimit() const;
+
+    /*
+     * Released voices (or ones whose sample has ended) which stay below this energy
+     * end early rather than running the whole AEG release. See
+     * Voice::updateSilenceDetection. Set from a dB level; 0 turns it off.
+     */
+    float voiceSilenceEnergy{0.f};
+    static constexpr float voiceSilenceMinHoldSeconds{0.01f};
+    void setVoiceSilenceThresholdDb(float db)
+    {
+        voiceSilenceEnergy = db >= 0.f ? 0.f : std::pow(10.f, db * 0.1f);
+    }
+
+    /**
+     * Where in the coming block the event being dispatched lands, in frames. Clients
+     * set this before handing a note to the voice manager and new voices hold their
+     * output back by it (see Voice::startOffset). processAudio clears it, so notes
+     * from the UI or from events between blocks start at the top of the block.
+     */
+    int32_t eventSampleOffset{0};
+    void setEventSampleOffset(int32_t f) { eventSampleOffset = std::clamp(f, 0, blockSize - 1); }
+
+    uint64_t voiceStartCounter{0};
+    uint32_t stealingVoices{0};
+    uint64_t stolenVoiceCount{0};
+
     // TODO: All this gets ripped out when voice management is fixed
     void assertActiveVoiceCount();
     std::atomic<uint32_t> activeVoices{0};
@@ -331,6 +418,8 @@ struct Engine : MoveableOnly<Engine>, SampleRateSupport
 
         std::atomic<float> cpuLevel{0};
         std::atomic<float> ramUsage{0};
+        std::atomic<uint64_t> diskStreamUnderruns{0};
+        std::atomic<uint64_t> diskStreamStarvedVoices{0};
     } sharedUIMemoryState;
 
     /* When we actually unstream an entire engine we want to know if we are doing
@@ -451,7 +540,9 @@ struct Engine : MoveableOnly<Engine>, SampleRateSupport
      */
     pgzStructure_t getPartGroupZoneStructure() const;
 
-    const std::unique_ptr<MemoryPool> &getMemoryPool()
+    const std::unique_ptr<PartRenderPool> &getPartRenderPool() const { return partRenderPool; }
+
+    const std::unique_ptr<MemoryPool> &getMemoryPool() const
     {
         assert(memoryPool);
         return memoryPool;
@@ -509,14 +600,53 @@ struct Engine : MoveableOnly<Engine>, SampleRateSupport
   private:
     std::unique_ptr<Patch> patch;
     std::unique_ptr<MemoryPool> memoryPool;
+    std::unique_ptr<PartRenderPool> partRenderPool;
     std::unique_ptr<sample::SampleManager> sampleManager;
     std::unique_ptr<browser::BrowserDB> browserDb;
     std::unique_ptr<browser::Browser> browser;
     std::array<voice::Voice *, maxVoices> voices;
     std::array<std::unique_ptr<voice::modulation::MatrixEndpoints>, maxVoices> allEndpoints;
     std::unique_ptr<uint8_t[]> voiceInPlaceBuffer{nullptr};
+
+    // Unassigned slots in voices, as a stack, so initiateVoice doesn't scan
+    std::array<int16_t, maxVoices> freeVoiceSlots;
+    size_t freeVoiceSlotCount{0};
+
+    /*
+     * Assigned voices bucketed by (channel, original midi key), linked through
+     * Voice::prev/nextKeyVoice, so releaseVoice only looks at voices which could
+     * match. Voices with an out of range channel (say -1) share the last bucket.
+     */
+    static constexpr size_t voiceIndexChannels{17}, voiceIndexKeys{128};
+    std::array<voice::Voice *, voiceIndexChannels * voiceIndexKeys> voicesByChannelKey{};
+    static size_t voiceIndexBucket(int16_t channel, int16_t key)
+    {
+        auto c = (channel >= 0 && channel < 16) ? channel : 16;
+        return c * voiceIndexKeys + (key & 127);
+    }
+
+    /*
+     * CPU governor state. cpuLevel is a slow falling peak hold for display so the
+     * governor keeps its own smoothed load and only adjusts every governorBlockInterval.
+     * That load lags by about 50 blocks, so after shedding we wait governorSettleBlocks
+     * (three of those) for it to show the lighter load before shedding again.
+     */
+    static constexpr int32_t governorBlockInterval{32};
+    static constexpr double governorLoadSmoothing{0.98};
+    static constexpr int32_t governorSettleBlocks{150};
+    int32_t governorVoiceCap{maxVoices};
+    int32_t governorBlockCounter{0};
+    int32_t governorSettleCountdown{0};
+    double governorLoad{0};
+    void runPolyphonyGovernor(double blockLoad);
     std::unique_ptr<messaging::MessageController> messageController;
     std::unique_ptr<selection::SelectionManager> selectionManager;
+
+    // The lookup index is owned by the audio thread once installed
+    std::unique_ptr<ZoneLookupIndex> zoneLookupIndex;
+    std::atomic<uint64_t> zoneLookupGeneration{1};
+    // Serialization thread only; the generation we last built an index for
+    uint64_t zoneLookupBuiltGeneration{0};
 };
 } // namespace scxt::engine
 #endif
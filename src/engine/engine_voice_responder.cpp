@@ -33,11 +33,35 @@ namespace scxt::engine
 int32_t Engine::VoiceManagerResponder::voiceCountForInitializationAction(
     uint16_t port, uint16_t channel, uint16_t key, int32_t noteId, float velocity)
 {
-    // TODO: We can optimize this so we don't have to find twice in the future
+    auto nts = findZoneCached(channel, key, noteId, std::clamp((int)(velocity * 128), 0, 127),
+                              false);
+
+    return nts;
+}
+
+size_t Engine::VoiceManagerResponder::findZoneCached(uint16_t channel, uint16_t key,
+                                                     int32_t noteId, int16_t velocity,
+                                                     bool consume)
+{
+    auto &lf = lastFindZone;
+    auto gen = engine.zoneLookupGeneration.load();
+    if (lf.valid && lf.channel == channel && lf.key == key && lf.noteId == noteId &&
+        lf.velocity == velocity && lf.generation == gen)
+    {
+        lf.valid = !consume;
+        return lf.count;
+    }
+
     auto useKey = engine.midikeyRetuner.remapKeyTo(channel, key);
-    auto nts = engine.findZone(channel, useKey, noteId, std::clamp((int)(velocity * 128), 0, 127),
-                               findZoneWorkingBuffer);
+    auto nts = engine.findZone(channel, useKey, noteId, velocity, findZoneWorkingBuffer);
 
+    lf.valid = !consume;
+    lf.channel = channel;
+    lf.key = key;
+    lf.noteId = noteId;
+    lf.velocity = velocity;
+    lf.generation = gen;
+    lf.count = nts;
     return nts;
 }
 
@@ -45,9 +69,8 @@ int32_t Engine::VoiceManagerResponder::initializeMultipleVoices(
     std::array<voice::Voice *, VMConfig::maxVoiceCount> &voiceInitWorkingBuffer, uint16_t port,
     uint16_t channel, uint16_t key, int32_t noteId, float velocity, float retune)
 {
-    auto useKey = engine.midikeyRetuner.remapKeyTo(channel, key);
-    auto nts = engine.findZone(channel, useKey, noteId, std::clamp((int)(velocity * 128), 0, 127),
-                               findZoneWorkingBuffer);
+    auto nts = findZoneCached(channel, key, noteId, std::clamp((int)(velocity * 128), 0, 127),
+                              true);
 
     for (auto idx = 0; idx < nts; ++idx)
     {
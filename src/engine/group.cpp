@@ -98,7 +98,7 @@ template <bool OS> void Group::processWithOS(scxt::engine::Engine &e)
 
     bool gated{attackInThisBlock};
     attackInThisBlock = false;
-    for (const auto &z : zones)
+    for (auto z = firstActiveZone; z; z = z->nextActiveZone)
     {
         gated = gated || (z->gatedVoiceCount > 0);
     }
@@ -139,30 +139,30 @@ template <bool OS> void Group::processWithOS(scxt::engine::Engine &e)
 
     modMatrix.process();
 
-    for (const auto &z : zones)
+    for (auto z = firstActiveZone; z;)
     {
-        if (z->isActive())
+        // processing can retire the zone's last voice and unlink it
+        auto next = z->nextActiveZone;
+        z->process(e);
+        /*
+         * This is just an optimization to not accumulate. The zone will
+         * have already routed to the approprite other bus and output will
+         * be empty.
+         */
+        if (z->outputInfo.routeTo == DEFAULT_BUS)
         {
-            z->process(e);
-            /*
-             * This is just an optimization to not accumulate. The zone will
-             * have already routed to the approprite other bus and output will
-             * be empty.
-             */
-            if (z->outputInfo.routeTo == DEFAULT_BUS)
+            if constexpr (OS)
             {
-                if constexpr (OS)
-                {
-                    blk::accumulate_from_to<blockSize << 1>(z->output[0], lOut);
-                    blk::accumulate_from_to<blockSize << 1>(z->output[1], rOut);
-                }
-                else
-                {
-                    blk::accumulate_from_to<blockSize>(z->output[0], lOut);
-                    blk::accumulate_from_to<blockSize>(z->output[1], rOut);
-                }
+                blk::accumulate_from_to<blockSize << 1>(z->output[0], lOut);
+                blk::accumulate_from_to<blockSize << 1>(z->output[1], rOut);
+            }
+            else
+            {
+                blk::accumulate_from_to<blockSize>(z->output[0], lOut);
+                blk::accumulate_from_to<blockSize>(z->output[1], rOut);
             }
         }
+        z = next;
     }
 
     // Groups are always unpitched and stereo
@@ -273,19 +273,26 @@ template <bool OS> void Group::processWithOS(scxt::engine::Engine &e)
         else
         {
             mUILag.instantlySnap();
-            parentPart->removeActiveGroup();
+            parentPart->removeActiveGroup(this);
             ringoutMax = 0;
         }
     }
 }
 
-void Group::addActiveZone()
+void Group::addActiveZone(Zone *z)
 {
     if (activeZones == 0)
     {
-        parentPart->addActiveGroup();
+        parentPart->addActiveGroup(this);
         attack();
     }
+
+    z->prevActiveZone = nullptr;
+    z->nextActiveZone = firstActiveZone;
+    if (firstActiveZone)
+        firstActiveZone->prevActiveZone = z;
+    firstActiveZone = z;
+
     // Important we do this *after* the attack since it allows
     // isActive to be accurate with processor ringout
     activeZones++;
@@ -322,9 +329,18 @@ bool Group::updateRingout()
     return res;
 }
 
-void Group::removeActiveZone()
+void Group::removeActiveZone(Zone *z)
 {
     assert(activeZones);
+    if (z->prevActiveZone)
+        z->prevActiveZone->nextActiveZone = z->nextActiveZone;
+    else
+        firstActiveZone = z->nextActiveZone;
+    if (z->nextActiveZone)
+        z->nextActiveZone->prevActiveZone = z->prevActiveZone;
+    z->prevActiveZone = nullptr;
+    z->nextActiveZone = nullptr;
+
     activeZones--;
     if (activeZones == 0)
     {
@@ -348,6 +364,13 @@ const engine::Engine *Group::getEngine() const
     return nullptr;
 }
 
+void Group::onZoneStructureChanged()
+{
+    auto e = getEngine();
+    if (e)
+        e->invalidateZoneLookup();
+}
+
 void Group::setupOnUnstream(const engine::Engine &e)
 {
     onRoutingChanged();
@@ -357,11 +380,13 @@ void Group::setupOnUnstream(const engine::Engine &e)
     {
         stepLfos[i].setSampleRate(sampleRate, sampleRateInv);
 
-        stepLfos[i].assign(&modulatorStorage[i], endpoints.lfo[i].rateP, nullptr, getEngine()->rng);
+        stepLfos[i].assign(&modulatorStorage[i], endpoints.lfo[i].rateP, nullptr, parentPart->rng);
     }
 
     for (int p = 0; p < processorCount; ++p)
     {
+        dsp::processor::preReserveProcessorMemory(processorStorage[p].type,
+                                                  e.getMemoryPool().get());
         setupProcessorControlDescriptions(p, processorStorage[p].type);
         onProcessorTypeChanged(p, processorStorage[p].type);
     }
@@ -397,12 +422,24 @@ void Group::onProcessorTypeChanged(int w, dsp::processor::ProcessorType t)
             endpoints.processorTarget[w].fp, processorStorage[w].intParams.data(),
             outputInfo.oversample, false);
 
+        // If the memory pool is dry the group runs this slot bypassed
+        if (processors[w] && !processors[w]->holdReservedBlocks())
+        {
+            dsp::processor::unspawnProcessor(processors[w]);
+            processors[w] = nullptr;
+        }
+
         if (processors[w])
         {
             processors[w]->setSampleRate(sampleRate * (outputInfo.oversample ? 2 : 1));
             processors[w]->setTempoPointer(&(getEngine()->transport.tempo));
 
             processors[w]->init();
+            if (processors[w]->memoryShortfall)
+            {
+                dsp::processor::unspawnProcessor(processors[w]);
+                processors[w] = nullptr;
+            }
         }
     }
     else
@@ -469,7 +506,7 @@ void Group::resetLFOs(int whichLFO)
             stepLfos[i].setSampleRate(sampleRate, sampleRateInv);
 
             stepLfos[i].assign(&modulatorStorage[i], endpoints.lfo[i].rateP, nullptr,
-                               getEngine()->rng);
+                               parentPart->rng);
         }
         else if (lfoEvaluator[i] == CURVE)
         {
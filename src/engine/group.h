@@ -84,6 +84,7 @@ struct Group : MoveableOnly<Group>,
         bool oversample{true};
         ProcRoutingPath procRouting{procRoute_linear};
         BusAddress routeTo{DEFAULT_BUS};
+        int16_t polyphonyLimit{0}; // 0 is unlimited; the engine steals voices past this
     } outputInfo;
 
     Engine *getEngine();
@@ -105,6 +106,7 @@ struct Group : MoveableOnly<Group>,
     {
         z->parentGroup = this;
         zones.push_back(std::move(z));
+        onZoneStructureChanged();
         return zones.size();
     }
 
@@ -112,10 +114,18 @@ struct Group : MoveableOnly<Group>,
     {
         z->parentGroup = this;
         zones.push_back(std::move(z));
+        onZoneStructureChanged();
         return zones.size();
     }
 
-    void clearZones() { zones.clear(); }
+    void clearZones()
+    {
+        zones.clear();
+        onZoneStructureChanged();
+    }
+
+    // Lets the engine know its zone lookup is out of date
+    void onZoneStructureChanged();
 
     int getZoneIndex(const ZoneID &zid) const
     {
@@ -149,17 +159,29 @@ struct Group : MoveableOnly<Group>,
         auto res = std::move(zones[idx]);
         zones.erase(zones.begin() + idx);
         res->parentGroup = nullptr;
+        onZoneStructureChanged();
         return res;
     }
 
     void swapZonesByIndex(size_t zoneIndex0, size_t zoneIndex1)
     {
         std::swap(zones[zoneIndex0], zones[zoneIndex1]);
+        onZoneStructureChanged();
     }
 
     bool isActive() const;
-    void addActiveZone();
-    void removeActiveZone();
+    void addActiveZone(Zone *);
+    void removeActiveZone(Zone *);
+
+    /*
+     * The render loop only visits zones with voices and groups which are sounding, so
+     * we keep intrusive lists of those. Zones join their group's list when they gain a
+     * first voice and leave when the last one goes; groups join their part's list with
+     * their first active zone and leave once ringout and envelopes are done.
+     */
+    Zone *firstActiveZone{nullptr};
+    Group *prevActiveGroup{nullptr}, *nextActiveGroup{nullptr};
+    bool onActiveGroupList{false};
 
     void onSampleRateChanged() override;
 
@@ -210,6 +232,8 @@ struct Group : MoveableOnly<Group>,
     void onProcessorTypeChanged(int w, dsp::processor::ProcessorType t);
 
     uint32_t activeZones{0};
+    // Voices counted against polyphonyLimit. Stolen voices which are fading out don't count
+    uint32_t polyphonyVoices{0};
     int32_t ringoutTime{0};
     int32_t ringoutMax{0};
 
@@ -250,6 +274,8 @@ SC_DESCRIBE(scxt::engine::Group::GroupOutputInfo,
             SC_FIELD(procRouting, pmd().asInt().withRange(0, 1));
             SC_FIELD(oversample, pmd().asBool().withName("Oversample"));
             SC_FIELD(velocitySensitivity,
-                     pmd().asPercent().withName("Velocity Sensitivity").withDefault(0.6f));)
+                     pmd().asPercent().withName("Velocity Sensitivity").withDefault(0.6f));
+            SC_FIELD(polyphonyLimit,
+                     pmd().asInt().withRange(0, maxVoices).withName("Polyphony").withDefault(0));)
 
 #endif
\ No newline at end of file
@@ -76,6 +76,12 @@ void HasGroupZoneProcessors<T>::setupProcessorControlDescriptions(
     int whichProcessor, dsp::processor::ProcessorType type,
     dsp::processor::Processor *tmpProcessorFromAfar, bool reClampFloatValues)
 {
+    if constexpr (forZone)
+    {
+        // Routed targets cache their range as a depth scale, and the ranges come from here
+        asT()->routingPlan.invalidateDepthScales();
+    }
+
     if (type == dsp::processor::proct_none)
     {
         processorDescription[whichProcessor] = {};
@@ -338,6 +344,7 @@ void HasGroupZoneProcessors<T>::updateRoutingTableAfterProcessorSwap(size_t f, s
                 r.target->setProcessorTargetTo(f);
         }
     }
+    asT()->onRoutingChanged();
 }
 } // namespace scxt::engine
 
@@ -26,111 +26,335 @@
  */
 
 #include "memory_pool.h"
+#include <algorithm>
 #include <cassert>
+#include <cstring>
 
 namespace scxt::engine
 {
-/*
- * A massive TODO here. Right now this allocates on the audio thread but we
- * can instead have this have a message contrller refecence at construction time
- * and instead try to ask the audio thread to allocate.
- */
+thread_local bool MemoryPool::isRealtimeThread{false};
 
 MemoryPool::~MemoryPool()
 {
     assert(debugCheckouts == debugReturns);
 
-    for (auto &[sz, s] : cache)
+    freeRetiredBlocks();
+
+    for (auto &sc : sizeClasses)
     {
-        while (!s.empty())
+        auto n = std::min(sc.allocated.load(), maxBlocksPerClass);
+        for (auto i = 0U; i < n; ++i)
         {
-            delete[] s.front();
-            s.pop();
+            delete[] sc.blocks[i];
+            sc.blocks[i] = nullptr;
         }
     }
 }
 
-#define ALLOCATE_IMPLEMENTATION 0
-#if ALLOCATE_IMPLEMENTATION
-void MemoryPool::preReservePool(size_t blockSize) {}
-MemoryPool::data_t *MemoryPool::checkoutBlock(size_t blockSize)
+MemoryPool::SizeClass *MemoryPool::findSizeClass(size_t blockSize)
 {
-    // Technically don't need this in the naive impl but lets avoid some bugs
-    debugCheckouts++;
-    auto ubs = nearestBlock(blockSize);
-    return new data_t[ubs];
+    // Classes are claimed front to back so the first empty one ends the search
+    for (auto &sc : sizeClasses)
+    {
+        auto bs = sc.blockSize.load(std::memory_order_acquire);
+        if (bs == blockSize)
+            return &sc;
+        if (bs == 0)
+            return nullptr;
+    }
+    return nullptr;
 }
-void MemoryPool::returnBlock(data_t *block, size_t blockSize)
+
+MemoryPool::SizeClass *MemoryPool::findOrClaimSizeClass(size_t blockSize, bool &isNew)
 {
-    debugReturns++;
-    delete[] block;
+    isNew = false;
+    for (auto &sc : sizeClasses)
+    {
+        auto bs = sc.blockSize.load(std::memory_order_acquire);
+        if (bs == 0)
+        {
+            if (sc.blockSize.compare_exchange_strong(bs, blockSize, std::memory_order_acq_rel))
+            {
+                isNew = true;
+                return &sc;
+            }
+            // someone else claimed it. bs now holds their size
+        }
+        if (bs == blockSize)
+            return &sc;
+    }
+    SCLOG("MemoryPool: out of size classes reserving block size " << blockSize);
+    return nullptr;
+}
+
+bool MemoryPool::popFree(SizeClass &sc, uint32_t &slot)
+{
+    auto head = sc.freeHead.load(std::memory_order_acquire);
+    while (head & 0xFFFFFFFF)
+    {
+        auto idx = (uint32_t)(head & 0xFFFFFFFF) - 1;
+        auto next = sc.nextFree[idx].load(std::memory_order_relaxed);
+        auto nh = (((head >> 32) + 1) << 32) | next;
+        if (sc.freeHead.compare_exchange_weak(head, nh, std::memory_order_acq_rel,
+                                              std::memory_order_acquire))
+        {
+            sc.freeCount.fetch_sub(1, std::memory_order_relaxed);
+            slot = idx;
+            return true;
+        }
+    }
+    return false;
+}
+
+void MemoryPool::pushFree(SizeClass &sc, uint32_t slot)
+{
+    auto head = sc.freeHead.load(std::memory_order_acquire);
+    uint64_t nh;
+    do
+    {
+        sc.nextFree[slot].store((uint32_t)(head & 0xFFFFFFFF), std::memory_order_relaxed);
+        nh = (((head >> 32) + 1) << 32) | (slot + 1);
+    } while (!sc.freeHead.compare_exchange_weak(head, nh, std::memory_order_acq_rel,
+                                                std::memory_order_acquire));
+    sc.freeCount.fetch_add(1, std::memory_order_relaxed);
+}
+
+void MemoryPool::growSizeClass(SizeClass &sc, uint32_t byEntries)
+{
+    auto bs = sc.blockSize.load(std::memory_order_acquire);
+    assert(bs > 0);
+
+    // Reserve a range of slots first so concurrent growers never share one
+    auto start = sc.allocated.load();
+    uint32_t end;
+    do
+    {
+        end = std::min(start + byEntries, maxBlocksPerClass);
+        if (end <= start)
+        {
+            SCLOG("MemoryPool: size class " << bs << " is at its " << maxBlocksPerClass
+                                            << " block limit");
+            return;
+        }
+    } while (!sc.allocated.compare_exchange_weak(start, end));
+
+    for (auto i = start; i < end; ++i)
+    {
+        auto mem = new data_t[headerSize + bs];
+        std::memcpy(mem, &i, sizeof(i));
+        sc.blocks[i] = mem;
+        pushFree(sc, i);
+    }
+}
+
+void MemoryPool::askForRefill()
+{
+    if (canGrowInline())
+    {
+        // Off the realtime threads there is no reason to wait on anyone
+        if (requestRefill)
+            refillPools();
+        return;
+    }
+
+    // Realtime threads (including the part render workers) only raise the flag; the
+    // audio thread passes it on in dispatchRefillRequest.
+    refillWanted.store(true, std::memory_order_release);
+}
+
+void MemoryPool::dispatchRefillRequest()
+{
+    if (!requestRefill || !refillWanted.load(std::memory_order_acquire))
+        return;
+
+    // One outstanding request is enough; refillPools looks at every class
+    if (!refillPending.exchange(true, std::memory_order_acq_rel))
+    {
+        refillWanted.store(false, std::memory_order_release);
+        requestRefill();
+    }
+}
+
+void MemoryPool::retireBlock(data_t *mem)
+{
+    auto head = retiredHead.load(std::memory_order_acquire);
+    do
+    {
+        std::memcpy(mem + sizeof(uint64_t), &head, sizeof(head));
+    } while (!retiredHead.compare_exchange_weak(head, mem, std::memory_order_acq_rel,
+                                                std::memory_order_acquire));
+    retiredCount.fetch_add(1, std::memory_order_relaxed);
+    askForRefill();
+}
+
+void MemoryPool::freeRetiredBlocks()
+{
+    auto mem = retiredHead.exchange(nullptr, std::memory_order_acq_rel);
+    while (mem)
+    {
+        data_t *next;
+        std::memcpy(&next, mem + sizeof(uint64_t), sizeof(next));
+        delete[] mem;
+        retiredCount.fetch_sub(1, std::memory_order_relaxed);
+        mem = next;
+    }
+}
+
+void MemoryPool::preReservePool(size_t requestBlockSize)
+{
+    auto blockSize = nearestBlock(requestBlockSize);
+    bool isNew{false};
+    auto sc = findOrClaimSizeClass(blockSize, isNew);
+    if (!sc)
+        return;
+
+    if (canGrowInline())
+    {
+        // Fill the class here and now so the first voice to use it doesn't allocate
+        auto fc = sc->freeCount.load(std::memory_order_relaxed);
+        if (fc < initialPoolSize)
+            growSizeClass(*sc, initialPoolSize - fc);
+    }
+    else if (isNew)
+    {
+        // Too late to fill it before this voice; refillPools will catch up
+        askForRefill();
+    }
 }
-#else
 
-static constexpr size_t initialPoolSize{16};
 MemoryPool::data_t *MemoryPool::checkoutBlock(size_t requestBlockSize)
 {
-    // Technically don't need this in the naive impl but lets avoid some bugs
     auto blockSize = nearestBlock(requestBlockSize);
-    auto cacheP = cache.find(blockSize);
-    assert(cacheP != cache.end()); // If you hit this you didn't pre-reserve
-    if (cacheP == cache.end())
+    auto sc = findSizeClass(blockSize);
+    assert(sc); // If you hit this you didn't pre-reserve
+    if (!sc)
+    {
+        return nullptr;
+    }
+
+    uint32_t slot;
+    auto gotSlot = popFree(*sc, slot);
+    if (!gotSlot && canGrowInline())
+    {
+        growSizeClass(*sc, initialPoolSize);
+        gotSlot = popFree(*sc, slot);
+    }
+
+    if (!gotSlot)
     {
+        // The pool ran dry before the serialization thread could refill it. We don't
+        // allocate here; the caller goes without and refillPools reports and regrows.
+        sc->shortfalls.fetch_add(1, std::memory_order_relaxed);
+        askForRefill();
         return nullptr;
     }
-    if (cacheP->second.empty())
+    auto res = sc->blocks[slot];
+
+    if (sc->freeCount.load(std::memory_order_relaxed) < lowWaterMark)
     {
-        growBlock(requestBlockSize, initialPoolSize);
-        return checkoutBlock(requestBlockSize);
+        askForRefill();
     }
 
     debugCheckouts++;
-    auto res = cacheP->second.front();
-    cacheP->second.pop();
+    auto iu = sc->inUse.fetch_add(1, std::memory_order_relaxed) + 1;
+    auto hw = sc->highWater.load(std::memory_order_relaxed);
+    while (iu > hw && !sc->highWater.compare_exchange_weak(hw, iu, std::memory_order_relaxed))
+    {
+    }
 
     // Please leave these in. Handy to debug
-    // SCLOG(blockSize << " : Post checkout size is " << cacheP->second.size());
-    return res;
+    // SCLOG(blockSize << " : Post checkout free size is " << sc->freeCount);
+    return res + headerSize;
 }
+
 void MemoryPool::returnBlock(data_t *block, size_t requestBlockSize)
 {
+    if (!block)
+        return;
+
     debugReturns++;
     auto blockSize = nearestBlock(requestBlockSize);
-    auto cacheP = cache.find(blockSize);
-    assert(cacheP != cache.end()); // If you hit this you didn't pre-reserve
+    auto sc = findSizeClass(blockSize);
+    assert(sc); // If you hit this you didn't pre-reserve
+
+    auto mem = block - headerSize;
+    if (!sc)
+    {
+        retireBlock(mem);
+        return;
+    }
+    sc->inUse.fetch_sub(1, std::memory_order_relaxed);
 
-    cacheP->second.push(block);
+    uint32_t slot;
+    std::memcpy(&slot, mem, sizeof(slot));
+    assert(sc->blocks[slot] == mem);
+    pushFree(*sc, slot);
 
-    // SCLOG(blockSize << ": Post return size is " << cacheP->second.size());
+    // SCLOG(blockSize << ": Post return free size is " << sc->freeCount);
 }
 
-void MemoryPool::growBlock(size_t requestBlockSize, size_t byEntries)
+void MemoryPool::refillPools()
 {
-    auto blockSize = nearestBlock(requestBlockSize);
-    // SCLOG(blockSize << ": Growing pool " << blockSize);
-    auto cacheP = cache.find(blockSize);
-    assert(cacheP != cache.end()); // If you hit this you didn't pre-reserve
+    refillPending.store(false, std::memory_order_release);
 
-    for (auto i = 0U; i < initialPoolSize; ++i)
+    freeRetiredBlocks();
+
+    for (auto &sc : sizeClasses)
     {
-        cacheP->second.push(new data_t[blockSize]);
+        auto bs = sc.blockSize.load(std::memory_order_acquire);
+        if (bs == 0)
+            break;
+
+        auto sf = sc.shortfalls.load(std::memory_order_relaxed);
+        auto shortfallHappened = sf != sc.reportedShortfalls;
+        if (shortfallHappened)
+        {
+            SCLOG("MemoryPool: size class " << bs << " ran dry on the audio thread; "
+                                            << sf - sc.reportedShortfalls
+                                            << " processor(s) ran bypassed. High water "
+                                            << sc.highWater);
+            sc.reportedShortfalls = sf;
+        }
+
+        auto fc = sc.freeCount.load(std::memory_order_relaxed);
+        if (fc >= initialPoolSize && !shortfallHappened)
+            continue;
+
+        // Top the free list back up, and if we got caught short double the class
+        // so the next burst of voices fits
+        auto need = fc < initialPoolSize ? initialPoolSize - fc : 0;
+        if (shortfallHappened)
+            need = std::max(need, sc.allocated.load());
+        growSizeClass(sc, need);
     }
-    // SCLOG(blockSize << ": Post grow size is " << cacheP->second.size());
 }
 
-void MemoryPool::preReservePool(size_t requestBlockSize)
+std::vector<MemoryPool::SizeClassStats> MemoryPool::getStats() const
 {
-    auto blockSize = nearestBlock(requestBlockSize);
-    auto cacheP = cache.find(blockSize);
-    if (cacheP == cache.end())
+    std::vector<SizeClassStats> res;
+    for (auto &sc : sizeClasses)
     {
-        auto cacheSet = pool_t();
-
-        cache.insert({blockSize, cacheSet});
-        growBlock(requestBlockSize, initialPoolSize);
+        auto bs = sc.blockSize.load(std::memory_order_acquire);
+        if (bs == 0)
+            break;
+        SizeClassStats s;
+        s.blockSize = bs;
+        s.allocated = sc.allocated;
+        s.inUse = sc.inUse;
+        s.highWater = sc.highWater;
+        s.shortfalls = sc.shortfalls;
+        res.push_back(s);
     }
-    // SCLOG(blockSize << ": Pre-Reserve cache found " << cache.at(blockSize).size() << " entries")
+    return res;
 }
-#endif
 
-} // namespace scxt::engine
\ No newline at end of file
+void MemoryPool::logStats() const
+{
+    for (const auto &s : getStats())
+    {
+        SCLOG("MemoryPool: block " << s.blockSize << " allocated=" << s.allocated
+                                   << " inUse=" << s.inUse << " highWater=" << s.highWater
+                                   << " shortfalls=" << s.shortfalls);
+    }
+}
+} // namespace scxt::engine
@@ -28,16 +28,42 @@
 #ifndef SCXT_SRC_ENGINE_MEMORY_POOL_H
 #define SCXT_SRC_ENGINE_MEMORY_POOL_H
 
+#include <array>
+#include <atomic>
 #include <cstdint>
 #include <cctype>
-#include <unordered_map>
-#include <unordered_set>
-#include <queue>
+#include <functional>
+#include <vector>
 
 #include "utils.h"
 
 namespace scxt::engine
 {
+/*
+ * The memory pool hands out fixed size blocks to processors (delay lines, reverb
+ * buffers and so on) which are created and destroyed on the audio thread as voices
+ * start and stop.
+ *
+ * Each size class is a fixed table of blocks with a lock-free (tagged index) free
+ * list, so checkout and return never lock and, once a class is warm, never allocate.
+ * Classes are reserved and filled synchronously when a processor pre-reserves off the
+ * realtime threads (dsp::processor::preReserveProcessorMemory does this on the
+ * serialization thread whenever a processor type is chosen or a patch loads) so the
+ * first voice finds its blocks waiting.
+ *
+ * On the realtime threads (the audio thread and the part render workers, which mark
+ * themselves with isRealtimeThread) the pool never grows. When a class runs low it
+ * flags a refill, the audio thread hands that to requestRefill via dispatchRefillRequest
+ * once its workers have joined, and the allocation happens on the serialization thread
+ * in refillPools. Blocks of a class we can't find are parked for refillPools to free
+ * too. If a class runs completely dry on a realtime thread checkout returns nullptr
+ * rather than allocate, and counts a shortfall; the processor asking runs bypassed
+ * (see Processor::holdReservedBlocks), the serialization thread warns about it on the
+ * next refill and grows the class so it doesn't happen again.
+ *
+ * Checkout, return and pre-reserve are safe from any thread concurrently; refillPools
+ * must only run on one thread at a time (the serialization thread).
+ */
 struct MemoryPool : MoveableOnly<MemoryPool>
 {
     typedef uint8_t data_t;
@@ -46,20 +72,88 @@ struct MemoryPool : MoveableOnly<MemoryPool>
 
     void preReservePool(size_t blockSize);
 
+    // nullptr if the class is dry and we may not grow it here
     data_t *checkoutBlock(size_t blockSize);
     void returnBlock(data_t *block, size_t blockSize);
 
+    /*
+     * If this is unset (as it is in tests and before the engine wires it up) the pool
+     * grows inline, like a plain allocator. Once set, growth on a realtime thread is only
+     * ever requested through this callback, which should arrange for refillPools to run
+     * on the serialization thread. It is only called from dispatchRefillRequest.
+     */
+    std::function<void()> requestRefill{nullptr};
+    void refillPools();
+
+    /*
+     * Audio thread, once per block after any parallel part rendering has joined. Sends
+     * at most one outstanding refill request so requestRefill keeps a single producer.
+     */
+    void dispatchRefillRequest();
+
+    // Set by the threads which render audio as they start; the pool never grows on these
+    static thread_local bool isRealtimeThread;
+
+    struct SizeClassStats
+    {
+        size_t blockSize{0};
+        uint32_t allocated{0}, inUse{0}, highWater{0}, shortfalls{0};
+    };
+    std::vector<SizeClassStats> getStats() const;
+    void logStats() const;
+
+    // Blocks returned on a realtime thread which wait for refillPools to free them
+    uint32_t getRetiredBlockCount() const { return retiredCount; }
+
+    static constexpr size_t maxSizeClasses{32};
+    static constexpr uint32_t maxBlocksPerClass{1024};
+    static constexpr uint32_t initialPoolSize{16};
+    static constexpr uint32_t lowWaterMark{4};
+
   private:
     template <size_t N = 10> static inline size_t nearestBlock(size_t x)
     {
         return ((x >> N) + 1) * (1 << N);
     }
-    void growBlock(size_t blockSize, size_t byEntries);
-    using pool_t = std::queue<data_t *>;
-    using cache_t = std::unordered_map<size_t, pool_t>;
-    cache_t cache;
 
-    int64_t debugCheckouts{0}, debugReturns{0};
+    // Each block carries a small header with its slot so return is O(1). Keep this
+    // a multiple of 16 so the payload keeps the alignment of new[]
+    static constexpr size_t headerSize{16};
+
+    struct SizeClass
+    {
+        // 0 means unclaimed. Claimed once and never released.
+        std::atomic<size_t> blockSize{0};
+
+        std::array<data_t *, maxBlocksPerClass> blocks{};
+        std::array<std::atomic<uint32_t>, maxBlocksPerClass> nextFree{};
+
+        // (tag << 32) | (slot + 1); a low word of 0 is the empty list. The tag
+        // bumps on every push and pop which keeps us safe from ABA.
+        std::atomic<uint64_t> freeHead{0};
+
+        std::atomic<uint32_t> allocated{0}, freeCount{0}, inUse{0}, highWater{0};
+        std::atomic<uint32_t> shortfalls{0}, reportedShortfalls{0};
+    };
+    std::array<SizeClass, maxSizeClasses> sizeClasses;
+    std::atomic<bool> refillWanted{false}, refillPending{false};
+
+    // An intrusive stack of blocks to free, linked through their headers
+    std::atomic<data_t *> retiredHead{nullptr};
+    std::atomic<uint32_t> retiredCount{0};
+    void retireBlock(data_t *mem);
+    void freeRetiredBlocks();
+
+    SizeClass *findSizeClass(size_t blockSize);
+    SizeClass *findOrClaimSizeClass(size_t blockSize, bool &isNew);
+
+    void growSizeClass(SizeClass &sc, uint32_t byEntries);
+    bool canGrowInline() const { return !requestRefill || !isRealtimeThread; }
+    bool popFree(SizeClass &sc, uint32_t &slot);
+    void pushFree(SizeClass &sc, uint32_t slot);
+    void askForRefill();
+
+    std::atomic<int64_t> debugCheckouts{0}, debugReturns{0};
 };
 } // namespace scxt::engine
 
@@ -46,8 +46,10 @@ void Part::process(Engine &e)
             sm.step();
     pitchBendSmoother.step();
 
-    for (const auto &g : groups)
+    for (auto g = firstActiveGroup; g;)
     {
+        // the group unlinks itself when its ringout completes
+        auto next = g->nextActiveGroup;
         if (g->isActive())
         {
             g->process(e);
@@ -63,7 +65,69 @@ void Part::process(Engine &e)
             blk::accumulate_from_to<blockSize>(g->output[0], obus.output[0]);
             blk::accumulate_from_to<blockSize>(g->output[1], obus.output[1]);
         }
+        else
+        {
+            removeActiveGroup(g);
+        }
+        g = next;
+    }
+}
+
+void Part::addActiveGroup(Group *g)
+{
+    if (g->onActiveGroupList)
+        return;
+
+    g->prevActiveGroup = nullptr;
+    g->nextActiveGroup = firstActiveGroup;
+    if (firstActiveGroup)
+        firstActiveGroup->prevActiveGroup = g;
+    firstActiveGroup = g;
+    g->onActiveGroupList = true;
+    activeGroups++;
+}
+
+void Part::removeActiveGroup(Group *g)
+{
+    if (!g->onActiveGroupList)
+        return;
+
+    assert(activeGroups);
+    if (g->prevActiveGroup)
+        g->prevActiveGroup->nextActiveGroup = g->nextActiveGroup;
+    else
+        firstActiveGroup = g->nextActiveGroup;
+    if (g->nextActiveGroup)
+        g->nextActiveGroup->prevActiveGroup = g->prevActiveGroup;
+    g->prevActiveGroup = nullptr;
+    g->nextActiveGroup = nullptr;
+    g->onActiveGroupList = false;
+    activeGroups--;
+}
+
+bool Part::rendersToOwnBusOnly()
+{
+    auto ownBus = (BusAddress)(PART_0 + partNumber);
+    for (auto g = firstActiveGroup; g; g = g->nextActiveGroup)
+    {
+        auto gr = g->outputInfo.routeTo;
+        if (gr != DEFAULT_BUS && gr != ownBus)
+            return false;
+
+        for (auto z = g->firstActiveZone; z; z = z->nextActiveZone)
+        {
+            auto zr = z->outputInfo.routeTo;
+            if (zr != DEFAULT_BUS && zr != ownBus)
+                return false;
+        }
     }
+    return true;
+}
+
+void Part::onGroupStructureChanged()
+{
+    if (parentPatch && parentPatch->parentEngine)
+        parentPatch->parentEngine->invalidateZoneLookup();
 }
 
 Part::zoneMappingSummary_t Part::getZoneMappingSummary()
@@ -66,6 +66,13 @@ struct Part : MoveableOnly<Part>, SampleRateSupport
     int16_t partNumber;
     Patch *parentPatch{nullptr};
 
+    /*
+     * The step LFOs and random sources of this part's groups and voices draw from here
+     * rather than the engine's generator, since parts render in parallel on the part
+     * render pool. Seeded from the engine generator by Patch::seedPartRandom.
+     */
+    sst::basic_blocks::dsp::RNG rng;
+
     struct PartConfiguration
     {
         static constexpr int16_t omniChannel{-1};
@@ -74,6 +81,7 @@ struct Part : MoveableOnly<Part>, SampleRateSupport
         int16_t channel{omniChannel}; // a midi channel or a special value like omni
         bool mute{false};
         bool solo{false};
+        int16_t polyphonyLimit{0}; // 0 is unlimited
 
         BusAddress routeTo{DEFAULT_BUS};
     } configuration;
@@ -118,9 +126,13 @@ struct Part : MoveableOnly<Part>, SampleRateSupport
         g->name = cn;
 
         groups.push_back(std::move(g));
+        onGroupStructureChanged();
         return groups.size();
     }
 
+    // Lets the engine know its zone lookup is out of date
+    void onGroupStructureChanged();
+
     void guaranteeGroupCount(size_t count)
     {
         while (groups.size() < count)
@@ -149,13 +161,18 @@ struct Part : MoveableOnly<Part>, SampleRateSupport
     }
 
     uint32_t activeGroups{0};
+    // Voices counted against configuration.polyphonyLimit, as Group::polyphonyVoices
+    uint32_t polyphonyVoices{0};
     bool isActive() { return activeGroups != 0; }
-    void addActiveGroup() { activeGroups++; }
-    void removeActiveGroup()
-    {
-        assert(activeGroups);
-        activeGroups--;
-    }
+    /*
+     * True if every active group and zone in this part routes to this part's bus,
+     * which means we can render it on another thread. See PartRenderPool.
+     */
+    bool rendersToOwnBusOnly();
+    // The sounding groups, linked through Group::prev/nextActiveGroup
+    Group *firstActiveGroup{nullptr};
+    void addActiveGroup(Group *);
+    void removeActiveGroup(Group *);
 
     std::array<dsp::Smoother, 128> midiCCSmoothers;
     dsp::Smoother pitchBendSmoother;
@@ -174,7 +191,13 @@ struct Part : MoveableOnly<Part>, SampleRateSupport
     typedef std::vector<std::unique_ptr<Group>> groupContainer_t;
 
     const groupContainer_t &getGroups() const { return groups; }
-    void clearGroups() { groups.clear(); }
+    void clearGroups()
+    {
+        groups.clear();
+        firstActiveGroup = nullptr;
+        activeGroups = 0;
+        onGroupStructureChanged();
+    }
     int getGroupIndex(const GroupID &zid) const
     {
         for (const auto &[idx, r] : sst::cpputils::enumerate(groups))
@@ -190,7 +213,10 @@ struct Part : MoveableOnly<Part>, SampleRateSupport
 
         auto res = std::move(groups[idx]);
         groups.erase(groups.begin() + idx);
+        // A group can still be ringing out after its voices are terminated
+        removeActiveGroup(res.get());
         res->parentPart = nullptr;
+        onGroupStructureChanged();
         return res;
     }
     groupContainer_t::iterator begin() noexcept { return groups.begin(); }
@@ -205,6 +231,8 @@ struct Part : MoveableOnly<Part>, SampleRateSupport
 } // namespace scxt::engine
 
 SC_DESCRIBE(scxt::engine::Part::PartConfiguration,
-            SC_FIELD(channel, pmd().asInt().withRange(-1, 15)););
+            SC_FIELD(channel, pmd().asInt().withRange(-1, 15));
+            SC_FIELD(polyphonyLimit,
+                     pmd().asInt().withRange(0, maxVoices).withName("Polyphony").withDefault(0)););
 
 #endif
\ No newline at end of file
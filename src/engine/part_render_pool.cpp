@@ -0,0 +1,183 @@
+/*
+ * Shortcircuit XT - a Surge Synth Team product
+ *
+ * A fully featured creative sampler, available as a standalone
+ * and plugin for multiple platforms.
+ *
+ * Copyright 2019 - 2024, Various authors, as described in the github
+ * transaction log.
+ *
+ * ShortcircuitXT is released under the Gnu General Public Licence
+ * V3 or later (GPL-3.0-or-later). The license is found in the file
+ * "LICENSE" in the root of this repository or at
+ * https://www.gnu.org/licenses/gpl-3.0.en.html
+ *
+ * Individual sections of code which comprises ShortcircuitXT in this
+ * repository may also be used under an MIT license. Please see the
+ * section  "Licensing" in "README.md" for details.
+ *
+ * ShortcircuitXT is inspired by, and shares code with, the
+ * commercial product Shortcircuit 1 and 2, released by VemberTech
+ * in the mid 2000s. The code for Shortcircuit 2 was opensourced in
+ * 2020 at the outset of this project.
+ *
+ * All source for ShortcircuitXT is available at
+ * https://github.com/surge-synthesizer/shortcircuit-xt
+ */
+
+#include "part_render_pool.h"
+
+#include <algorithm>
+#include <chrono>
+
+#include "engine.h"
+#include "voice/voice.h"
+#include "infrastructure/sse_include.h"
+
+namespace scxt::engine
+{
+PartRenderPool::PartRenderPool(Engine &e, int numWorkers) : engine(e)
+{
+    // More workers than parts less the audio thread will never find work
+    numWorkers = std::clamp(numWorkers, 0, (int)numParts - 1);
+    SCLOG("Starting part render pool with " << numWorkers << " workers");
+    for (int i = 0; i < numWorkers; ++i)
+    {
+        workers.push_back(std::make_unique<std::thread>([this]() { runWorker(); }));
+    }
+}
+
+PartRenderPool::~PartRenderPool()
+{
+    keepRunning = false;
+    for (auto &w : workers)
+    {
+        w->join();
+    }
+    workers.clear();
+}
+
+void PartRenderPool::processParts()
+{
+    auto &patch = engine.getPatch();
+
+    uint32_t nJobs{0};
+    for (const auto &part : *patch)
+    {
+        if (part->isActive() && part->rendersToOwnBusOnly())
+        {
+            jobs[nJobs++] = part.get();
+        }
+    }
+
+    if (nJobs > 1 && !workers.empty())
+    {
+        renderingInParallel = true;
+        deferredCleanupCount = 0;
+        jobsDone.store(0, std::memory_order_relaxed);
+        jobCount.store(nJobs, std::memory_order_relaxed);
+        generation++;
+        jobState.store(packJobState(generation, 0), std::memory_order_release);
+
+        // Pitch in, then wait for anything the workers are still on
+        while (claimAndRunJob(generation))
+            ;
+        while (jobsDone.load(std::memory_order_acquire) < nJobs)
+        {
+            _mm_pause();
+        }
+
+        renderingInParallel = false;
+        auto nc = deferredCleanupCount.load(std::memory_order_acquire);
+        for (uint32_t i = 0; i < nc; ++i)
+        {
+            deferredCleanup[i]->cleanupVoice();
+        }
+    }
+    else
+    {
+        nJobs = 0;
+    }
+
+    // And anything we didn't render in parallel goes serially as before
+    for (const auto &part : *patch)
+    {
+        if (!part->isActive())
+            continue;
+
+        bool done{false};
+        for (uint32_t i = 0; i < nJobs; ++i)
+            done = done || (jobs[i] == part.get());
+
+        if (!done)
+            part->process(engine);
+    }
+}
+
+void PartRenderPool::deferVoiceCleanup(voice::Voice *v)
+{
+    auto idx = deferredCleanupCount.fetch_add(1, std::memory_order_acq_rel);
+    assert(idx < deferredCleanup.size());
+    deferredCleanup[idx] = v;
+}
+
+bool PartRenderPool::claimAndRunJob(uint32_t gen)
+{
+    auto st = jobState.load(std::memory_order_acquire);
+    while (true)
+    {
+        auto stGen = (uint32_t)(st >> 32);
+        auto next = (uint32_t)(st & 0xFFFFFFFF);
+        if (stGen != gen || next >= jobCount.load(std::memory_order_relaxed))
+            return false;
+
+        if (jobState.compare_exchange_weak(st, packJobState(gen, next + 1),
+                                           std::memory_order_acq_rel))
+        {
+            jobs[next]->process(engine);
+            jobsDone.fetch_add(1, std::memory_order_acq_rel);
+            return true;
+        }
+    }
+}
+
+void PartRenderPool::runWorker()
+{
+    static constexpr int spinsBeforeYield{4096};
+    static constexpr int yieldsBeforeSleep{256};
+
+    // Voices we render start processors, so the memory pool must treat us like the
+    // audio thread: never grow here, and leave refill requests for the audio thread
+    MemoryPool::isRealtimeThread = true;
+
+    uint32_t lastGen{0};
+    int idle{0};
+    while (keepRunning)
+    {
+        auto gen = (uint32_t)(jobState.load(std::memory_order_acquire) >> 32);
+        if (gen != lastGen)
+        {
+            while (claimAndRunJob(gen))
+                ;
+            lastGen = gen;
+            idle = 0;
+            continue;
+        }
+
+        idle++;
+        if (idle < spinsBeforeYield)
+        {
+            _mm_pause();
+        }
+        else if (idle < spinsBeforeYield + yieldsBeforeSleep)
+        {
+            std::this_thread::yield();
+        }
+        else
+        {
+            // We've been idle a while (audio probably stopped). Don't burn a core.
+            std::this_thread::sleep_for(std::chrono::microseconds(100));
+        }
+    }
+}
+} // namespace scxt::engine
@@ -0,0 +1,111 @@
+/*
+ * Shortcircuit XT - a Surge Synth Team product
+ *
+ * A fully featured creative sampler, available as a standalone
+ * and plugin for multiple platforms.
+ *
+ * Copyright 2019 - 2024, Various authors, as described in the github
+ * transaction log.
+ *
+ * ShortcircuitXT is released under the Gnu General Public Licence
+ * V3 or later (GPL-3.0-or-later). The license is found in the file
+ * "LICENSE" in the root of this repository or at
+ * https://www.gnu.org/licenses/gpl-3.0.en.html
+ *
+ * Individual sections of code which comprises ShortcircuitXT in this
+ * repository may also be used under an MIT license. Please see the
+ * section  "Licensing" in "README.md" for details.
+ *
+ * ShortcircuitXT is inspired by, and shares code with, the
+ * commercial product Shortcircuit 1 and 2, released by VemberTech
+ * in the mid 2000s. The code for Shortcircuit 2 was opensourced in
+ * 2020 at the outset of this project.
+ *
+ * All source for ShortcircuitXT is available at
+ * https://github.com/surge-synthesizer/shortcircuit-xt
+ */
+
+#ifndef SCXT_SRC_ENGINE_PART_RENDER_POOL_H
+#define SCXT_SRC_ENGINE_PART_RENDER_POOL_H
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "utils.h"
+#include "configuration.h"
+
+namespace scxt::voice
+{
+struct Voice;
+}
+
+namespace scxt::engine
+{
+struct Engine;
+struct Part;
+
+/**
+ * PartRenderPool renders independent parts in parallel on a set of worker threads.
+ *
+ * A part is independent if everything active in it routes to its own part bus, in which
+ * case its whole Group/Zone/Voice subtree only touches memory it owns. Each block the
+ * audio thread publishes the independent active parts as jobs, claims jobs itself
+ * alongside the workers, and spins until they are all done. Everything else (parts
+ * which route elsewhere, the part and aux bus sends, the main bus) then runs on the
+ * audio thread as before.
+ *
+ * Nothing on the audio path locks or waits on a condition. Jobs are claimed with a CAS
+ * on a word holding both the block generation and the next job index, so a worker
+ * which wakes late for an old block can never claim a job in the new one. Workers
+ * spin then back off to sleeping when idle; since the audio thread does any work no
+ * one else has claimed, a sleeping worker costs throughput but never latency.
+ *
+ * Voices finishing on a worker would call back into the (single threaded) voice
+ * manager, so while rendering in parallel Zone defers voice cleanup to us and we run
+ * it on the audio thread after the barrier.
+ */
+struct PartRenderPool : MoveableOnly<PartRenderPool>
+{
+    explicit PartRenderPool(Engine &e, int numWorkers);
+    ~PartRenderPool();
+
+    /*
+     * Audio thread. Run the active parts, accumulating onto their busses.
+     */
+    void processParts();
+
+    bool isRenderingInParallel() const { return renderingInParallel; }
+    void deferVoiceCleanup(voice::Voice *v);
+
+    size_t workerCount() const { return workers.size(); }
+
+  private:
+    Engine &engine;
+
+    void runWorker();
+    bool claimAndRunJob(uint32_t generation);
+    static constexpr uint64_t packJobState(uint32_t generation, uint32_t next)
+    {
+        return ((uint64_t)generation << 32) | next;
+    }
+
+    std::array<Part *, numParts> jobs{};
+    std::atomic<uint32_t> jobCount{0};
+    std::atomic<uint64_t> jobState{0};
+    std::atomic<uint32_t> jobsDone{0};
+    uint32_t generation{0};
+
+    bool renderingInParallel{false};
+    std::array<voice::Voice *, maxVoices> deferredCleanup{};
+    std::atomic<uint32_t> deferredCleanupCount{0};
+
+    std::atomic<bool> keepRunning{true};
+    std::vector<std::unique_ptr<std::thread>> workers;
+};
+} // namespace scxt::engine
+
+#endif // SCXT_SRC_ENGINE_PART_RENDER_POOL_H
@@ -26,6 +26,7 @@
  */
 
 #include "patch.h"
+#include "engine.h"
 #include "sst/basic-blocks/mechanics/block-ops.h"
 
 namespace scxt::engine
@@ -42,11 +43,19 @@ void Patch::process(Engine &e)
         b.clear();
 
     // Run each of the parts, accumulating onto the engine busses
-    for (const auto &part : parts)
+    const auto &renderPool = e.getPartRenderPool();
+    if (renderPool)
+    {
+        renderPool->processParts();
+    }
+    else
     {
-        if (part->isActive())
+        for (const auto &part : parts)
         {
-            part->process(e);
+            if (part->isActive())
+            {
+                part->process(e);
+            }
         }
     }
 
@@ -135,6 +144,15 @@ void Patch::process(Engine &e)
     busses.mainBus.process();
 }
 
+void Patch::seedPartRandom()
+{
+    if (!parentEngine)
+        return;
+
+    for (auto &p : parts)
+        p->rng.reseed(parentEngine->rng.unifU32());
+}
+
 void Patch::setupBussesOnUnstream(Engine &e)
 {
     // Assume the bus storage is correct
@@ -172,9 +172,12 @@ struct Patch : MoveableOnly<Patch>, SampleRateSupport
             parts[i] = std::make_unique<Part>(i);
             parts[i]->parentPatch = this;
         }
+        seedPartRandom();
         busses.initialize();
         setSampleRate(1);
     }
+    // Give each part a random stream of its own, drawn from the engine's
+    void seedPartRandom();
 
     bool usesOutputBus(int bus) { return busses.usesOutput[bus]; }
     void setupBussesOnUnstream(Engine &e);
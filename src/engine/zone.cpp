@@ -33,6 +33,7 @@
 #include "engine.h"
 #include "messaging/messaging.h"
 #include "voice/voice.h"
+#include "voice/voice_lanes.h"
 
 #include "sst/basic-blocks/mechanics/block-ops.h"
 #include "group_and_zone_impl.h"
@@ -54,44 +55,55 @@ void Zone::process(Engine &e)
 template <bool OS> void Zone::processWithOS(scxt::engine::Engine &onto)
 {
     constexpr size_t osBlock{blockSize << (OS ? 1 : 0)};
-    namespace blk = sst::basic_blocks::mechanics;
     // TODO these memsets are probably gratuitous
     memset(output, 0, sizeof(output));
 
     mUILag.process();
 
-    std::array<voice::Voice *, maxVoices> toCleanUp;
-    size_t cleanupIdx{0};
+    float *dL{nullptr}, *dR{nullptr};
+    Bus *targetBus{nullptr};
+    if (outputInfo.routeTo == DEFAULT_BUS)
+    {
+        dL = output[0];
+        dR = output[1];
+    }
+    else if (outputInfo.routeTo >= 0)
+    {
+        auto &bs = getEngine()->getPatch()->busses;
+        targetBus = &bs.busByAddress(outputInfo.routeTo);
+        dL = OS ? targetBus->outputOS[0] : targetBus->output[0];
+        dR = OS ? targetBus->outputOS[1] : targetBus->output[1];
+    }
+
+    // Voices leave their output stage to us and we mix them voiceLaneWidth at a time
+    std::array<voice::Voice *, voiceLaneWidth> lanes;
+    size_t laneIdx{0};
+    auto flushLanes = [&]() {
+        if (laneIdx == 0)
+            return;
+        voice::mixOutputStageLanes<osBlock>(lanes.data(), laneIdx, dL, dR);
+        if constexpr (OS)
+        {
+            if (targetBus)
+                targetBus->hasOSSignal = true;
+        }
+        laneIdx = 0;
+    };
+
     gatedVoiceCount = 0;
-    for (auto &v : voiceWeakPointers)
+    bool anyFinished{false};
+    for (auto v = firstVoice; v; v = v->nextZoneVoice)
     {
-        if (v && v->isVoiceAssigned)
+        if (v->isVoiceAssigned)
         {
-            if (v->process())
-            {
-                if (outputInfo.routeTo == DEFAULT_BUS)
-                {
-                    blk::accumulate_from_to<osBlock>(v->output[0], output[0]);
-                    blk::accumulate_from_to<osBlock>(v->output[1], output[1]);
-                }
-                else if (outputInfo.routeTo >= 0)
-                {
-                    auto &bs = getEngine()->getPatch()->busses;
-                    auto &tb = bs.busByAddress(outputInfo.routeTo);
-                    blk::accumulate_from_to<osBlock>(v->output[0],
-                                                     OS ? tb.outputOS[0] : tb.output[0]);
-                    blk::accumulate_from_to<osBlock>(v->output[1],
-                                                     OS ? tb.outputOS[1] : tb.output[1]);
-                    if constexpr (OS)
-                    {
-                        tb.hasOSSignal = true;
-                    }
-                }
-            }
-            if (!v->isVoicePlaying)
+            v->deferOutputStage = true;
+            if (v->process() && dL)
             {
-                toCleanUp[cleanupIdx++] = v;
+                lanes[laneIdx++] = v;
+                if (laneIdx == voiceLaneWidth)
+                    flushLanes();
             }
+            anyFinished = anyFinished || !v->isVoicePlaying;
 
             if (v->isGated)
             {
@@ -99,13 +111,29 @@ template <bool OS> void Zone::processWithOS(scxt::engine::Engine &onto)
             }
         }
     }
+    flushLanes();
 
-    for (int i = 0; i < cleanupIdx; ++i)
+    if (anyFinished)
     {
+        // When parts render in parallel, voice cleanup has to wait for the audio thread
+        auto &renderPool = onto.getPartRenderPool();
+        bool deferCleanup = renderPool && renderPool->isRenderingInParallel();
+        for (auto v = firstVoice; v;)
+        {
+            // cleanupVoice unlinks v
+            auto next = v->nextZoneVoice;
+            if (v->isVoiceAssigned && !v->isVoicePlaying)
+            {
 #if DEBUG_VOICE_LIFECYCLE
-        SCLOG("Cleanup Voice at " << SCDBGV((int)toCleanUp[i]->key));
+                SCLOG("Cleanup Voice at " << SCDBGV((int)v->key));
 #endif
-        toCleanUp[i]->cleanupVoice();
+                if (deferCleanup)
+                    renderPool->deferVoiceCleanup(v);
+                else
+                    v->cleanupVoice();
+            }
+            v = next;
+        }
     }
 
     for (int i = 0; i < osBlock; i += 4)
@@ -120,38 +148,48 @@ void Zone::addVoice(voice::Voice *v)
 {
     if (activeVoices == 0)
     {
-        parentGroup->addActiveZone();
+        parentGroup->addActiveZone(this);
     }
 
     activeVoices++;
-    for (auto &nv : voiceWeakPointers)
-    {
-        if (nv == nullptr)
-        {
-            nv = v;
-            return;
-        }
-    }
-
-    assert(false);
+    parentGroup->polyphonyVoices++;
+    parentGroup->parentPart->polyphonyVoices++;
+    assert(!v->prevZoneVoice && !v->nextZoneVoice && firstVoice != v);
+    v->prevZoneVoice = nullptr;
+    v->nextZoneVoice = firstVoice;
+    if (firstVoice)
+        firstVoice->prevZoneVoice = v;
+    firstVoice = v;
 }
 void Zone::removeVoice(voice::Voice *v)
 {
-    for (auto &nv : voiceWeakPointers)
+    assert(activeVoices);
+    if (v->prevZoneVoice)
+        v->prevZoneVoice->nextZoneVoice = v->nextZoneVoice;
+    else
     {
-        if (nv == v)
-        {
-            nv = nullptr;
-            activeVoices--;
-            if (activeVoices == 0)
-            {
-                mUILag.instantlySnap();
-                parentGroup->removeActiveZone();
-            }
-            return;
-        }
+        assert(firstVoice == v);
+        firstVoice = v->nextZoneVoice;
+    }
+    if (v->nextZoneVoice)
+        v->nextZoneVoice->prevZoneVoice = v->prevZoneVoice;
+    v->prevZoneVoice = nullptr;
+    v->nextZoneVoice = nullptr;
+
+    // stolen voices already left the polyphony counts in Engine::stealVoice
+    if (!v->isBeingStolen)
+    {
+        assert(parentGroup->polyphonyVoices && parentGroup->parentPart->polyphonyVoices);
+        parentGroup->polyphonyVoices--;
+        parentGroup->parentPart->polyphonyVoices--;
+    }
+
+    activeVoices--;
+    if (activeVoices == 0)
+    {
+        mUILag.instantlySnap();
+        parentGroup->removeActiveZone(this);
     }
-    assert(false);
 }
 
 engine::Engine *Zone::getEngine()
@@ -170,8 +208,7 @@ const engine::Engine *Zone::getEngine() const
 
 void Zone::initialize()
 {
-    for (auto &v : voiceWeakPointers)
-        v = nullptr;
+    firstVoice = nullptr;
 
     for (auto &l : modulatorStorage)
     {
@@ -188,6 +225,8 @@ void Zone::setupOnUnstream(const engine::Engine &e)
     }
     for (int p = 0; p < processorCount; ++p)
     {
+        dsp::processor::preReserveProcessorMemory(processorStorage[p].type,
+                                                  e.getMemoryPool().get());
         setupProcessorControlDescriptions(p, processorStorage[p].type);
     }
 }
@@ -350,26 +389,27 @@ void Zone::onSampleRateChanged() { mUILag.setRate(120, blockSize, sampleRate); }
 
 void Zone::terminateAllVoices()
 {
-    std::array<voice::Voice *, maxVoices> toCleanUp{};
-    size_t cleanupIdx{0};
-    for (auto &v : voiceWeakPointers)
+    size_t cleanupCount{0};
+    for (auto v = firstVoice; v;)
     {
-        if (v && v->isVoiceAssigned)
+        // cleanupVoice unlinks v
+        auto next = v->nextZoneVoice;
+        if (v->isVoiceAssigned)
         {
-            toCleanUp[cleanupIdx++] = v;
+            v->cleanupVoice();
+            cleanupCount++;
         }
+        v = next;
     }
-    if (cleanupIdx)
+    if (cleanupCount)
     {
-        SCLOG("Early-terminating " << cleanupIdx << " voices");
-    }
-    for (int i = 0; i < cleanupIdx; ++i)
-    {
-        toCleanUp[i]->cleanupVoice();
+        SCLOG("Early-terminating " << cleanupCount << " voices");
     }
 }
 void Zone::onRoutingChanged()
 {
+    routingPlan.compile(routingTable);
+
     voice::modulation::MatrixEndpoints::Sources usedForScanning(nullptr);
     std::fill(lfosActive.begin(), lfosActive.end(), false);
     egsActive[0] = true; // the AEG always runs
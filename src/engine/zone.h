@@ -218,7 +218,10 @@ struct Zone : MoveableOnly<Zone>, HasGroupZoneProcessors<Zone>, SampleRateSuppor
 
     bool isActive() { return activeVoices != 0; }
     uint32_t activeVoices{0};
-    std::array<voice::Voice *, maxVoices> voiceWeakPointers;
+    // Intrusive links in our group's list of zones with voices. See Group::firstActiveZone
+    Zone *prevActiveZone{nullptr}, *nextActiveZone{nullptr};
+    // Our voices, linked through Voice::prev/nextZoneVoice. Weak; the engine owns them
+    voice::Voice *firstVoice{nullptr};
     int gatedVoiceCount{0};
     void terminateAllVoices();
 
@@ -228,6 +231,8 @@ struct Zone : MoveableOnly<Zone>, HasGroupZoneProcessors<Zone>, SampleRateSuppor
     void removeVoice(voice::Voice *);
 
     voice::modulation::Matrix::RoutingTable routingTable;
+    // Compiled from routingTable in onRoutingChanged for voices to bind against
+    voice::modulation::RoutingPlan routingPlan;
     void onRoutingChanged();
 
     std::array<modulation::ModulatorStorage, lfosPerZone> modulatorStorage;
@@ -0,0 +1,93 @@
+/*
+ * Shortcircuit XT - a Surge Synth Team product
+ *
+ * A fully featured creative sampler, available as a standalone
+ * and plugin for multiple platforms.
+ *
+ * Copyright 2019 - 2024, Various authors, as described in the github
+ * transaction log.
+ *
+ * ShortcircuitXT is released under the Gnu General Public Licence
+ * V3 or later (GPL-3.0-or-later). The license is found in the file
+ * "LICENSE" in the root of this repository or at
+ * https://www.gnu.org/licenses/gpl-3.0.en.html
+ *
+ * Individual sections of code which comprises ShortcircuitXT in this
+ * repository may also be used under an MIT license. Please see the
+ * section  "Licensing" in "README.md" for details.
+ *
+ * ShortcircuitXT is inspired by, and shares code with, the
+ * commercial product Shortcircuit 1 and 2, released by VemberTech
+ * in the mid 2000s. The code for Shortcircuit 2 was opensourced in
+ * 2020 at the outset of this project.
+ *
+ * All source for ShortcircuitXT is available at
+ * https://github.com/surge-synthesizer/shortcircuit-xt
+ */
+
+#include "zone_lookup.h"
+#include "patch.h"
+#include "part.h"
+#include "group.h"
+#include "zone.h"
+
+#include <algorithm>
+
+namespace scxt::engine
+{
+void ZoneLookupIndex::build(const Patch &patch, uint64_t gen)
+{
+    generation = gen;
+
+    /*
+     * This is a counting sort. First figure out how many zones land on each
+     * (part, key), lay the ranges out contiguously, then fill them in walking
+     * the structure in the same part / group / zone order as the linear scan
+     * so voice initiation order is unchanged.
+     */
+    size_t total{0};
+    for (int p = 0; p < numParts; ++p)
+    {
+        std::array<uint32_t, numKeys> counts{};
+        for (const auto &group : *patch.getPart(p))
+        {
+            for (const auto &zone : *group)
+            {
+                const auto &kr = zone->mapping.keyboardRange;
+                auto ks = std::max((int)kr.keyStart, 0);
+                auto ke = std::min((int)kr.keyEnd, numKeys - 1);
+                for (auto k = ks; k <= ke; ++k)
+                    counts[k]++;
+            }
+        }
+        for (int k = 0; k < numKeys; ++k)
+        {
+            ranges[p][k].begin = total;
+            ranges[p][k].end = total;
+            total += counts[k];
+        }
+    }
+
+    entries.resize(total);
+    for (int p = 0; p < numParts; ++p)
+    {
+        uint32_t gidx{0};
+        for (const auto &group : *patch.getPart(p))
+        {
+            uint32_t zidx{0};
+            for (const auto &zone : *group)
+            {
+                const auto &kr = zone->mapping.keyboardRange;
+                auto ks = std::max((int)kr.keyStart, 0);
+                auto ke = std::min((int)kr.keyEnd, numKeys - 1);
+                for (auto k = ks; k <= ke; ++k)
+                {
+                    entries[ranges[p][k].end++] = {gidx, zidx, zone.get()};
+                }
+                zidx++;
+            }
+            gidx++;
+        }
+    }
+}
+} // namespace scxt::engine
@@ -0,0 +1,81 @@
+/*
+ * Shortcircuit XT - a Surge Synth Team product
+ *
+ * A fully featured creative sampler, available as a standalone
+ * and plugin for multiple platforms.
+ *
+ * Copyright 2019 - 2024, Various authors, as described in the github
+ * transaction log.
+ *
+ * ShortcircuitXT is released under the Gnu General Public Licence
+ * V3 or later (GPL-3.0-or-later). The license is found in the file
+ * "LICENSE" in the root of this repository or at
+ * https://www.gnu.org/licenses/gpl-3.0.en.html
+ *
+ * Individual sections of code which comprises ShortcircuitXT in this
+ * repository may also be used under an MIT license. Please see the
+ * section  "Licensing" in "README.md" for details.
+ *
+ * ShortcircuitXT is inspired by, and shares code with, the
+ * commercial product Shortcircuit 1 and 2, released by VemberTech
+ * in the mid 2000s. The code for Shortcircuit 2 was opensourced in
+ * 2020 at the outset of this project.
+ *
+ * All source for ShortcircuitXT is available at
+ * https://github.com/surge-synthesizer/shortcircuit-xt
+ */
+
+#ifndef SCXT_SRC_ENGINE_ZONE_LOOKUP_H
+#define SCXT_SRC_ENGINE_ZONE_LOOKUP_H
+
+#include <array>
+#include <cstdint>
+#include <vector>
+
+#include "configuration.h"
+#include "utils.h"
+
+namespace scxt::engine
+{
+struct Patch;
+struct Zone;
+
+/**
+ * The ZoneLookupIndex is a precomputed (part, key) -> zone list map which lets
+ * note on avoid walking every zone in every group in every part. It is built
+ * on the serialization thread from a stable patch (see Engine::updateZoneLookupIfNeeded)
+ * and handed to the audio thread, which owns it from then on.
+ *
+ * Part channel and mute are cheap and change independently of structure, so they
+ * are checked at lookup time. Velocity is also checked at lookup time against the
+ * live zone mapping, so each entry just needs the path and the zone pointer.
+ *
+ * The index is tagged with the structure generation it was built from. If the engine
+ * generation has moved on, the index is considered stale and the engine falls back to
+ * a full scan until the serialization thread delivers a replacement.
+ */
+struct ZoneLookupIndex : MoveableOnly<ZoneLookupIndex>
+{
+    static constexpr int16_t numKeys{128};
+
+    struct Entry
+    {
+        uint32_t group{0};
+        uint32_t zone{0};
+        Zone *zonePtr{nullptr};
+    };
+
+    struct Range
+    {
+        uint32_t begin{0}, end{0};
+    };
+
+    uint64_t generation{0};
+    std::array<std::array<Range, numKeys>, numParts> ranges{};
+    std::vector<Entry> entries;
+
+    void build(const Patch &patch, uint64_t gen);
+};
+} // namespace scxt::engine
+
+#endif // SCXT_SRC_ENGINE_ZONE_LOOKUP_H
@@ -27,6 +27,7 @@
 
 #include "infrastructure/file_map_view.h"
 #include <cstdio>
+#include <algorithm>
 #if WINDOWS
 #include <windows.h>
 #else
@@ -160,4 +161,37 @@ size_t FileMapView::dataSize() { return as(impl.get())->dataSize; }
 
 bool FileMapView::isMapped() { return as(impl.get())->isMapped; }
 
+void FileMapView::adviseWillNeed(size_t offset, size_t size)
+{
+    auto im = as(impl.get());
+    if (!im->isMapped || offset >= im->dataSize)
+        return;
+    size = std::min(size, im->dataSize - offset);
+#if WINDOWS
+    // We open with FILE_FLAG_SEQUENTIAL_SCAN which already asks for read ahead
+#else
+    // madvise wants a page aligned start
+    auto page = (size_t)sysconf(_SC_PAGESIZE);
+    auto start = offset - offset % page;
+    madvise((uint8_t *)im->data + start, size + (offset - start), MADV_WILLNEED);
+#endif
+}
+
+void FileMapView::prefault(size_t offset, size_t size)
+{
+    auto im = as(impl.get());
+    if (!im->isMapped || offset >= im->dataSize)
+        return;
+    size = std::min(size, im->dataSize - offset);
+    adviseWillNeed(offset, size);
+
+    static constexpr size_t touchStride{4096}; // no larger than a page anywhere we run
+    auto *d = (const volatile uint8_t *)im->data + offset;
+    uint8_t sink{0};
+    for (size_t i = 0; i < size; i += touchStride)
+        sink ^= d[i];
+    sink ^= d[size - 1];
+    (void)sink;
+}
+
 } // namespace scxt::infrastructure
\ No newline at end of file
@@ -62,6 +62,20 @@ class FileMapView
     void *data();
     size_t dataSize();
 
+    /**
+     * Hint to the OS that we will soon read the given byte range, so it can start
+     * paging it in. This is advisory only and a no-op where unsupported.
+     */
+    void adviseWillNeed(size_t offset, size_t size);
+
+    /**
+     * Advise, then read a byte from every page of the given range so it is resident
+     * when we return. Call this off the audio thread. The pages are file backed and
+     * clean, so under memory pressure the OS can still drop them and a later read
+     * faults them back in from disk.
+     */
+    void prefault(size_t offset, size_t size);
+
     struct Impl
     {
         virtual ~Impl() = default;
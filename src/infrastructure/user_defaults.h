@@ -42,6 +42,17 @@ enum DefaultKeys
     colormapPathIfFile,
     welcomeScreenSeen,
     playModeExpanded,
+    useDiskStreaming,
+    partRenderThreads,
+    voiceLimit,
+    voiceStealingMode,
+    cpuGovernorTarget,
+    voiceSilenceThresholdDb,
+    packI24Samples,
+    useMemoryMappedSamples,
+    shareSamplesAcrossInstances,
+    sampleMemoryBudgetMB,
+    decodedSampleCacheMB,
 
     nKeys // must be last K?
 };
@@ -67,6 +78,28 @@ inline std::string defaultKeyToString(DefaultKeys k)
         return "welcomeScreenSeen";
     case playModeExpanded:
         return "playModeExpanded";
+    case useDiskStreaming:
+        return "useDiskStreaming";
+    case partRenderThreads:
+        return "partRenderThreads";
+    case voiceLimit:
+        return "voiceLimit";
+    case voiceStealingMode:
+        return "voiceStealingMode";
+    case cpuGovernorTarget:
+        return "cpuGovernorTarget";
+    case voiceSilenceThresholdDb:
+        return "voiceSilenceThresholdDb";
+    case packI24Samples:
+        return "packI24Samples";
+    case useMemoryMappedSamples:
+        return "useMemoryMappedSamples";
+    case shareSamplesAcrossInstances:
+        return "shareSamplesAcrossInstances";
+    case sampleMemoryBudgetMB:
+        return "sampleMemoryBudgetMB";
+    case decodedSampleCacheMB:
+        return "decodedSampleCacheMB";
     default:
         std::terminate(); // for now
     }
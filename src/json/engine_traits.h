@@ -96,6 +96,8 @@ SC_STREAMDEF(scxt::engine::Engine, SC_FROM({
 
                  // and finally set the sample rate
                  to.getPatch()->setSampleRate(to.getSampleRate());
+
+                 to.invalidateZoneLookup();
              }))
 
 SC_STREAMDEF(scxt::engine::Patch, SC_FROM({
@@ -139,12 +141,17 @@ SC_STREAMDEF(scxt::engine::Macro, SC_FROM({
 
 SC_STREAMDEF(
     scxt::engine::Part::PartConfiguration,
-    SC_FROM(v = {{"a", from.active}, {"c", from.channel}, {"m", from.mute}, {"s", from.solo}};),
+    SC_FROM(v = {{"a", from.active},
+                 {"c", from.channel},
+                 {"m", from.mute},
+                 {"s", from.solo},
+                 {"pl", from.polyphonyLimit}};),
     SC_TO({
         findOrSet(v, "c", scxt::engine::Part::PartConfiguration::omniChannel, to.channel);
         findOrSet(v, "a", true, to.active);
         findOrSet(v, "m", false, to.mute);
         findOrSet(v, "s", false, to.solo);
+        findOrSet(v, "pl", (int16_t)0, to.polyphonyLimit);
     }));
 
 SC_STREAMDEF(
@@ -177,7 +184,7 @@ SC_STREAMDEF(scxt::engine::Group::GroupOutputInfo, SC_FROM({
                  v = {{"amplitude", t.amplitude},   {"pan", t.pan},
                       {"oversample", t.oversample}, {"velocitySensitivity", t.velocitySensitivity},
                       {"muted", t.muted},           {"procRouting", t.procRouting},
-                      {"routeTo", (int)t.routeTo}};
+                      {"routeTo", (int)t.routeTo},  {"polyphonyLimit", t.polyphonyLimit}};
              }),
              SC_TO({
                  findIf(v, "amplitude", result.amplitude);
@@ -189,6 +196,7 @@ SC_STREAMDEF(scxt::engine::Group::GroupOutputInfo, SC_FROM({
                  int rt{engine::BusAddress::DEFAULT_BUS};
                  findIf(v, "routeTo", rt);
                  result.routeTo = (engine::BusAddress)(rt);
+                 findOrSet(v, "polyphonyLimit", (int16_t)0, result.polyphonyLimit);
              }));
 
 SC_STREAMDEF(scxt::engine::Group, SC_FROM({
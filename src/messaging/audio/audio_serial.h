@@ -54,6 +54,7 @@ enum AudioToSerializationMessageId
     a2s_processor_refresh,
     a2s_macro_updated,
     a2s_delete_this_pointer,
+    a2s_memory_pool_refill,
 };
 
 /**
@@ -72,6 +73,7 @@ struct AudioToSerialization
         {
             engine_Zone,
             engine_Group,
+            engine_ZoneLookupIndex,
         } type;
     };
 
@@ -103,6 +103,17 @@
         typedef className T;                                                                       \
     };
 
+/*
+ * Opt a message into the fixed size binary client to serialization path. Only
+ * takes effect if the payload is trivially copyable and fits in a record; otherwise
+ * the message quietly keeps using msgpack.
+ */
+#define CLIENT_TO_SERIAL_FAST_PATH(className)                                                      \
+    template <> struct ClientToSerializationFastPath<className>                                    \
+    {                                                                                              \
+        static constexpr bool value{true};                                                         \
+    };
+
 #define SERIAL_TO_CLIENT(className, s2id, s2payloadType, cliMethod)                                \
     struct className                                                                               \
     {                                                                                              \
@@ -216,6 +216,15 @@ template <SerializationToClientMessageIds id> struct SerializationToClientType
     typedef unimpl_t T;
 };
 
+/*
+ * Set by CLIENT_TO_SERIAL_FAST_PATH for messages which can use the binary fast
+ * path in MessageController rather than msgpack
+ */
+template <typename T> struct ClientToSerializationFastPath
+{
+    static constexpr bool value{false};
+};
+
 template <typename T> void clientSendToSerialization(const T &message, MessageController &mc);
 template <typename T>
 void serializationSendToClient(SerializationToClientMessageIds id, const T &payload,
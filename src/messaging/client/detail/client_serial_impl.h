@@ -41,6 +41,9 @@
 
 #include "messaging/client/detail/client_json_details.h"
 
+#include <new>
+#include <type_traits>
+
 // This is a 'details only' file which you can safely ignore
 // once it works, basically.
 namespace scxt::messaging::client
@@ -157,12 +160,77 @@ auto executeOnClientFor(size_t ft, typename tao::json::basic_value<Traits> &o, C
     return fnc[ft](o, c);
 }
 
+template <typename T> constexpr bool usesFastPath()
+{
+    if constexpr (!ClientToSerializationFastPath<T>::value)
+    {
+        return false;
+    }
+    else
+    {
+        using P = typename T::c2s_payload_t;
+        using R = MessageController::ClientToSerializationFastMessage;
+        return std::is_trivially_copy_constructible_v<P> && std::is_trivially_destructible_v<P> &&
+               sizeof(P) <= R::maxPayloadBytes && alignof(P) <= alignof(std::max_align_t);
+    }
+}
+
+template <size_t I>
+void doExecFastOnSerialization(const MessageController::ClientToSerializationFastMessage &m,
+                               engine::Engine &e, MessageController &mc)
+{
+    typedef typename ClientToSerializationType<(ClientToSerializationMessagesIds)I>::T handler_t;
+    if constexpr (std::is_same<handler_t, unimpl_t>::value)
+    {
+        assert(false);
+        return;
+    }
+    else if constexpr (!usesFastPath<handler_t>())
+    {
+        // If you hit this the client sent a fast record for a msgpack-only message
+        assert(false);
+        return;
+    }
+    else
+    {
+        auto payload =
+            std::launder(reinterpret_cast<const typename handler_t::c2s_payload_t *>(m.payload));
+        handler_t::executeOnSerialization(*payload, e, mc);
+    }
+}
+
+template <size_t... Is>
+auto executeFastOnSerializationFor(size_t ft,
+                                   const MessageController::ClientToSerializationFastMessage &m,
+                                   engine::Engine &e, MessageController &mc,
+                                   std::index_sequence<Is...>)
+{
+    using vtOp_t = void (*)(const MessageController::ClientToSerializationFastMessage &,
+                            engine::Engine &, MessageController &);
+    constexpr vtOp_t fnc[] = {detail::doExecFastOnSerialization<Is>...};
+    return fnc[ft](m, e, mc);
+}
+
 } // namespace detail
 
 template <typename T>
 inline void clientSendToSerialization(const T &msg, messaging::MessageController &mc)
 {
     assert(mc.threadingChecker.isClientThread());
+    if constexpr (detail::usesFastPath<T>())
+    {
+        auto rec = mc.beginFastFromClient();
+        if (rec)
+        {
+            rec->id = (int32_t)T::c2s_id;
+            new (rec->payload) typename T::c2s_payload_t(msg.payload);
+            mc.commitFastFromClient(sizeof(typename T::c2s_payload_t));
+            return;
+        }
+        // Ring is full. msgpack still keeps the order correct, just slower.
+        mc.c2sFastMessageFallbacks++;
+    }
+
     auto mw = detail::MessageWrapper(msg);
     detail::client_message_value v = mw;
     auto res = encoder::to_string(v);
@@ -174,6 +242,9 @@ inline void clientSendToSerialization(const T &msg, messaging::MessageController
         SCLOG("Client -> Serial Message Count : " << mc.c2sMessageCount << " size "
                                                   << mc.c2sMessageBytes << " avgmsg: "
                                                   << 1.f * mc.c2sMessageBytes / mc.c2sMessageCount);
+        SCLOG("Client -> Serial Fast Message Count : "
+              << mc.c2sFastMessageCount << " size " << mc.c2sFastMessageBytes
+              << " ring-full fallbacks: " << mc.c2sFastMessageFallbacks);
     }
 #endif
     mc.sendRawFromClient(res);
@@ -235,6 +306,18 @@ inline void serializationThreadExecuteClientMessage(const std::string &msgView,
             size_t)ClientToSerializationMessagesIds::num_clientToSerializationMessages>());
 }
 
+inline void serializationThreadExecuteFastClientMessage(
+    const MessageController::ClientToSerializationFastMessage &m, engine::Engine &e,
+    MessageController &mc)
+{
+    assert(mc.threadingChecker.isSerialThread());
+    assert(m.id >= 0 && m.id < ClientToSerializationMessagesIds::num_clientToSerializationMessages);
+    detail::executeFastOnSerializationFor(
+        (ClientToSerializationMessagesIds)m.id, m, e, mc,
+        std::make_index_sequence<(
+            size_t)ClientToSerializationMessagesIds::num_clientToSerializationMessages>());
+}
+
 template <typename Client>
 inline void clientThreadExecuteSerializationMessage(const std::string &msgView, Client *c)
 {
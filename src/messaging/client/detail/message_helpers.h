@@ -68,6 +68,12 @@ updateZoneLeadMemberValue(M m, const diffMsg_t<VT> &payload, const engine::Engin
                 {
                     *(VT *)(((uint8_t *)&dat) + d) = v;
                 }
+                // Keyboard ranges live in the mapping and feed the note lookup index
+                if constexpr (std::is_same_v<std::remove_reference_t<decltype(dat)>,
+                                             engine::Zone::ZoneMappingData>)
+                {
+                    eng.invalidateZoneLookup();
+                }
             },
             responseCB);
     }
@@ -44,6 +44,7 @@ CLIENT_TO_SERIAL_CONSTRAINED(UpdateGroupOutputFloatValue, c2s_update_group_outpu
                              detail::diffMsg_t<float>, engine::Group::GroupOutputInfo,
                              detail::updateGroupMemberValue(&engine::Group::outputInfo, payload,
                                                             engine, cont));
+CLIENT_TO_SERIAL_FAST_PATH(UpdateGroupOutputFloatValue);
 
 CLIENT_TO_SERIAL_CONSTRAINED(UpdateGroupOutputInt16TValue, c2s_update_group_output_int16_t_value,
                              detail::diffMsg_t<int16_t>, engine::Group::GroupOutputInfo,
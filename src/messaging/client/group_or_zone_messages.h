@@ -41,6 +41,7 @@ CLIENT_TO_SERIAL_CONSTRAINED(UpdateZoneOrGroupEGFloatValue, c2s_update_zone_or_g
                              detail::updateZoneOrGroupIndexedMemberValue(&engine::Zone::egStorage,
                                                                          &engine::Group::gegStorage,
                                                                          payload, engine, cont));
+CLIENT_TO_SERIAL_FAST_PATH(UpdateZoneOrGroupEGFloatValue);
 
 CLIENT_TO_SERIAL_CONSTRAINED(
     UpdateZoneOrGroupModStorageFloatValue, c2s_update_zone_or_group_modstorage_float_value,
@@ -48,6 +49,7 @@ CLIENT_TO_SERIAL_CONSTRAINED(
     detail::updateZoneOrGroupIndexedMemberValue(&engine::Zone::modulatorStorage,
                                                 &engine::Group::modulatorStorage, payload, engine,
                                                 cont));
+CLIENT_TO_SERIAL_FAST_PATH(UpdateZoneOrGroupModStorageFloatValue);
 
 CLIENT_TO_SERIAL_CONSTRAINED(
     UpdateZoneOrGroupModStorageBoolValue, c2s_update_zone_or_group_modstorage_bool_value,
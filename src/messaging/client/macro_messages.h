@@ -109,6 +109,7 @@ inline void updateMacroValue(const macroValue_t &t, const engine::Engine &engine
 }
 CLIENT_TO_SERIAL(SetMacroValue, c2s_set_macro_value, macroValue_t,
                  updateMacroValue(payload, engine, cont));
+CLIENT_TO_SERIAL_FAST_PATH(SetMacroValue);
 
 using macroBeginEndEdit_t = std::tuple<bool, int16_t, int16_t>; // begin=true, id, val
 inline void doMacroBeginEndEdit(const macroBeginEndEdit_t &payload, const engine::Engine &e,
@@ -89,6 +89,7 @@ inline void doUpdateZoneRoutingRow(const zoneRoutingRowPayload_t &payload,
 }
 CLIENT_TO_SERIAL(UpdateZoneRoutingRow, c2s_update_zone_routing_row, zoneRoutingRowPayload_t,
                  doUpdateZoneRoutingRow(payload, engine, cont));
+CLIENT_TO_SERIAL_FAST_PATH(UpdateZoneRoutingRow);
 
 // which row, what data, and force a full update
 typedef std::tuple<int, modulation::GroupMatrix::RoutingTable::Routing, bool>
@@ -129,6 +130,7 @@ inline void doUpdateGroupRoutingRow(const updateGroupRoutingRowPayload_t &payloa
 }
 CLIENT_TO_SERIAL(UpdateGroupRoutingRow, c2s_update_group_routing_row,
                  updateGroupRoutingRowPayload_t, doUpdateGroupRoutingRow(payload, engine, cont));
+CLIENT_TO_SERIAL_FAST_PATH(UpdateGroupRoutingRow);
 
 // forzone, active, which, data
 typedef std::tuple<bool, bool, int, modulation::ModulatorStorage> indexedModulatorStorageUpdate_t;
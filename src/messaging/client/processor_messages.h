@@ -55,6 +55,11 @@ inline void setProcessorType(const setProcessorPayload_t &whichToType, const eng
                              messaging::MessageController &cont)
 {
     const auto &[forZone, w, id] = whichToType;
+
+    // The memory pool can't grow on the audio thread, so get the new type's blocks now
+    dsp::processor::preReserveProcessorMemory((dsp::processor::ProcessorType)id,
+                                              engine.getMemoryPool().get());
+
     if (!forZone)
     {
         auto sg = engine.getSelectionManager()->currentlySelectedGroups();
@@ -131,6 +136,7 @@ CLIENT_TO_SERIAL_CONSTRAINED(
     detail::updateZoneOrGroupIndexedMemberValue(&engine::Zone::processorStorage,
                                                 &engine::Group::processorStorage, payload, engine,
                                                 cont));
+CLIENT_TO_SERIAL_FAST_PATH(UpdateZoneOrGroupProcessorFloatValue);
 
 CLIENT_TO_SERIAL_CONSTRAINED(
     UpdateZoneOrGroupProcessorInt32TValue, c2s_update_single_processor_int32_t_value,
@@ -59,6 +59,7 @@ inline void doUpdateLeadZoneMapping(const engine::Zone::ZoneMappingData &payload
             [zs = *sz, mapv = mapping](auto &eng) {
                 auto [p, g, z] = zs;
                 eng.getPatch()->getPart(p)->getGroup(g)->getZone(z)->mapping = mapv;
+                eng.invalidateZoneLookup();
             },
             [p = sz->part](const auto &eng) {
                 serializationSendToClient(
@@ -77,6 +78,7 @@ CLIENT_TO_SERIAL_CONSTRAINED(UpdateZoneMappingFloatValue, c2s_update_zone_mappin
                              detail::diffMsg_t<float>, engine::Zone::ZoneMappingData,
                              detail::updateZoneLeadMemberValue(&engine::Zone::mapping, payload,
                                                                engine, cont));
+CLIENT_TO_SERIAL_FAST_PATH(UpdateZoneMappingFloatValue);
 CLIENT_TO_SERIAL_CONSTRAINED(
     UpdateZoneMappingInt16TValue, c2s_update_zone_mapping_int16_t, detail::diffMsg_t<int16_t>,
     engine::Zone::ZoneMappingData,
@@ -126,6 +128,7 @@ CLIENT_TO_SERIAL_CONSTRAINED(UpdateZoneOutputFloatValue, c2s_update_zone_output_
                              detail::diffMsg_t<float>, engine::Zone::ZoneOutputInfo,
                              detail::updateZoneMemberValue(&engine::Zone::outputInfo, payload,
                                                            engine, cont));
+CLIENT_TO_SERIAL_FAST_PATH(UpdateZoneOutputFloatValue);
 
 CLIENT_TO_SERIAL_CONSTRAINED(UpdateZoneOutputInt16TValue, c2s_update_zone_output_int16_t_value,
                              detail::diffMsg_t<int16_t>, engine::Zone::ZoneOutputInfo,
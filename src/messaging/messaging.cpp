@@ -86,9 +86,18 @@ void MessageController::parseAudioMessageOnSerializationThread(
             delete g;
         }
         break;
+        case audio::AudioToSerialization::ToBeDeleted::engine_ZoneLookupIndex:
+        {
+            auto zli = (engine::ZoneLookupIndex *)(as.payload.delThis.ptr);
+            delete zli;
+        }
+        break;
         }
     }
     break;
+    case audio::a2s_memory_pool_refill:
+        engine.getMemoryPool()->refillPools();
+        break;
     case audio::a2s_none:
         break;
     }
@@ -202,6 +211,8 @@ void MessageController::runSerialization()
         {
             std::unique_lock<std::mutex> lock(clientToSerializationMutex);
             while (shouldRun && clientToSerializationQueue.empty() &&
+                   fastClientRingRead.load(std::memory_order_relaxed) ==
+                       fastClientRingWrite.load(std::memory_order_acquire) &&
                    (audioToSerializationQueue.empty()) && !audioStateChanged)
             {
                 clientToSerializationConditionVar.wait_for(lock, 50ms);
@@ -216,14 +227,24 @@ void MessageController::runSerialization()
         }
         if (shouldRun)
         {
+            // Fast messages sent before 'inbound' have to run before it
+            drainFastClientMessages();
+
             if (receivedMessageFromClient)
             {
+                structuralClientMessagesStarted++;
                 std::lock_guard<std::mutex> g(engine.modifyStructureMutex);
+                auto st = std::chrono::steady_clock::now();
                 client::serializationThreadExecuteClientMessage(inbound, engine, *this);
+                inboundClientMessageTime += std::chrono::steady_clock::now() - st;
                 inboundClientMessageCount++;
                 if (inboundClientMessageCount % 1000 == 0)
                 {
-                    SCLOG("Client -> Serial Message Count: " << inboundClientMessageCount);
+                    SCLOG("Client -> Serial Message Count: "
+                          << inboundClientMessageCount << " msgpack in "
+                          << inboundClientMessageTime.count() / 1000 << "us; "
+                          << inboundFastClientMessageCount << " fast in "
+                          << inboundFastClientMessageTime.count() / 1000 << "us");
                 }
             }
 
@@ -247,6 +268,9 @@ void MessageController::runSerialization()
                     tryToDrain = false;
             }
             serializationThreadPostAudioQueueDrain();
+
+            engine.updateZoneLookupIfNeeded();
+            engine.updateSampleResidencyIfNeeded();
         }
         else
         {
@@ -325,10 +349,45 @@ void MessageController::sendRawFromClient(const clientToSerializationMessage_t &
     {
         std::lock_guard<std::mutex> g(clientToSerializationMutex);
         clientToSerializationQueue.push(s);
+        structuralClientMessagesQueued++;
     }
     clientToSerializationConditionVar.notify_one();
 }
 
+void MessageController::commitFastFromClient(size_t payloadBytes)
+{
+    fastClientRingWrite.fetch_add(1, std::memory_order_release);
+    c2sFastMessageCount++;
+    c2sFastMessageBytes += payloadBytes;
+
+    // We don't take the mutex here so the serialization thread can miss this wakeup
+    // if it is just about to wait. That costs at most one wait_for timeout.
+    clientToSerializationConditionVar.notify_one();
+}
+
+void MessageController::drainFastClientMessages()
+{
+    assert(threadingChecker.isSerialThread());
+    auto r = fastClientRingRead.load(std::memory_order_relaxed);
+    while (r != fastClientRingWrite.load(std::memory_order_acquire))
+    {
+        const auto &msg = fastClientRing[r % fastClientRingSize];
+        if (msg.afterStructuralMessage > structuralClientMessagesStarted)
+            break;
+
+        {
+            std::lock_guard<std::mutex> g(engine.modifyStructureMutex);
+            auto st = std::chrono::steady_clock::now();
+            client::serializationThreadExecuteFastClientMessage(msg, engine, *this);
+            inboundFastClientMessageTime += std::chrono::steady_clock::now() - st;
+        }
+        inboundFastClientMessageCount++;
+
+        r++;
+        fastClientRingRead.store(r, std::memory_order_release);
+    }
+}
+
 void MessageController::reportErrorToClient(const std::string &title, const std::string &body)
 {
     SCLOG("Error: [" << title << "]");
@@ -37,6 +37,8 @@
 #include <queue>
 #include <stack>
 #include <chrono>
+#include <array>
+#include <cstddef>
 
 #include "client/client_serial.h"
 #include "audio/audio_serial.h"
@@ -221,6 +223,40 @@ struct MessageController : MoveableOnly<MessageController>
      */
     void sendRawFromClient(const clientToSerializationMessage_t &s);
 
+    /**
+     * High rate messages (parameter drags, macro values, matrix row edits) whose
+     * payload is small and trivially copyable skip msgpack and the locked queue and
+     * instead are written straight into a fixed size record in a preallocated
+     * single-producer / single-consumer ring. Messages opt in with
+     * CLIENT_TO_SERIAL_FAST_PATH; everything structural still uses msgpack.
+     *
+     * Each record remembers how many msgpack messages were queued before it, so the
+     * serialization thread executes the two paths in the order the client sent them.
+     */
+    struct ClientToSerializationFastMessage
+    {
+        static constexpr size_t maxPayloadBytes{192};
+        int32_t id{-1};
+        uint64_t afterStructuralMessage{0};
+        alignas(std::max_align_t) unsigned char payload[maxPayloadBytes];
+    };
+
+    /**
+     * Client thread only. Returns the next free record or nullptr if the ring is full,
+     * in which case the caller should use the msgpack path. Fill in id and payload
+     * then call commitFastFromClient.
+     */
+    ClientToSerializationFastMessage *beginFastFromClient()
+    {
+        auto w = fastClientRingWrite.load(std::memory_order_relaxed);
+        if (w - fastClientRingRead.load(std::memory_order_acquire) >= fastClientRingSize)
+            return nullptr;
+        auto &res = fastClientRing[w % fastClientRingSize];
+        res.afterStructuralMessage = structuralClientMessagesQueued;
+        return &res;
+    }
+    void commitFastFromClient(size_t payloadBytes);
+
     typedef audio::SerializationToAudio serializationToAudioMessage_t;
     typedef audio::AudioToSerialization audioToSerializationMessage_t;
 
@@ -313,6 +349,7 @@ struct MessageController : MoveableOnly<MessageController>
      * Some stats on messages back
      */
     uint64_t c2sMessageCount{0}, c2sMessageBytes{0};
+    uint64_t c2sFastMessageCount{0}, c2sFastMessageBytes{0}, c2sFastMessageFallbacks{0};
 
     /*
      * This is a function which causes the plugin to issue a callback.
@@ -357,6 +394,9 @@ struct MessageController : MoveableOnly<MessageController>
 
   private:
     uint64_t inboundClientMessageCount{0};
+    uint64_t inboundFastClientMessageCount{0};
+    std::chrono::nanoseconds inboundClientMessageTime{0}, inboundFastClientMessageTime{0};
+    void drainFastClientMessages();
     void runSerialization();
     void parseAudioMessageOnSerializationThread(const audio::AudioToSerialization &as);
     void prepareSerializationThreadForAudioQueueDrain();
@@ -384,6 +424,13 @@ struct MessageController : MoveableOnly<MessageController>
   private:
     std::queue<clientToSerializationMessage_t> clientToSerializationQueue;
     std::mutex clientToSerializationMutex;
+    // msgpack messages queued (client thread) and begun executing (serialization thread)
+    uint64_t structuralClientMessagesQueued{0};
+    uint64_t structuralClientMessagesStarted{0};
+
+    static constexpr size_t fastClientRingSize{1024};
+    std::array<ClientToSerializationFastMessage, fastClientRingSize> fastClientRing{};
+    std::atomic<uint64_t> fastClientRingWrite{0}, fastClientRingRead{0};
     std::condition_variable clientToSerializationConditionVar;
 
     int serializationToClientCallback;
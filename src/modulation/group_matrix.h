@@ -90,6 +90,11 @@ struct GroupMatrixConfig
 struct GroupMatrix : sst::basic_blocks::mod_matrix::FixedMatrix<GroupMatrixConfig>
 {
     bool forUIMode{false};
+    // Groups only bind when their routing changes, not per voice, so they don't use a plan
+    scxt::modulation::shared::RoutingPlan<GroupMatrixConfig::SourceIdentifier,
+                                          GroupMatrixConfig::TargetIdentifier,
+                                          GroupMatrixConfig::FixedMatrixSize> *routingPlan{
+        nullptr};
     std::unordered_map<GroupMatrixConfig::TargetIdentifier, datamodel::pmd> activeTargetsToPMD;
     std::unordered_map<GroupMatrixConfig::TargetIdentifier, float> activeTargetsToBaseValue;
 };
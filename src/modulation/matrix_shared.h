@@ -28,7 +28,9 @@
 #ifndef SCXT_SRC_MODULATION_MATRIX_SHARED_H
 #define SCXT_SRC_MODULATION_MATRIX_SHARED_H
 
+#include <array>
 #include <cstdint>
+#include <type_traits>
 #include <utility>
 #include <ostream>
 #include <string>
@@ -193,6 +195,73 @@ template <typename TG, uint32_t gn> struct ProcessorTargetEndpointData
     }
 };
 
+/*
+ * A routing plan is a flat summary of a routing table, compiled when the table changes,
+ * so a voice start only binds the sources and targets the table actually refers to.
+ * Targets which nothing routes to read their base value directly without going through
+ * the matrix, and the depth scale of routed targets (their metadata range) is cached
+ * the first time it is needed rather than described again at every voice start.
+ */
+template <typename SR, typename TG, size_t N> struct RoutingPlan
+{
+    struct Target
+    {
+        TG target{};
+        float depthScale{0.f};
+        bool depthScaleKnown{false};
+    };
+    std::array<Target, N> targets{};
+    size_t targetCount{0};
+    std::array<SR, 2 * N> sources{};
+    size_t sourceCount{0};
+
+    // Inactive rows count too since the matrix may still look them up when preparing
+    template <typename RT> void compile(const RT &rt)
+    {
+        targetCount = 0;
+        sourceCount = 0;
+        for (const auto &r : rt.routes)
+        {
+            if (r.source.has_value())
+                addSource(*r.source);
+            if (r.sourceVia.has_value())
+                addSource(*r.sourceVia);
+            if (r.target.has_value() && !findTarget(*r.target))
+                targets[targetCount++] = Target{*r.target};
+        }
+    }
+
+    // Target metadata depends on things like processor type, so re-describe on next bind
+    void invalidateDepthScales()
+    {
+        for (size_t i = 0; i < targetCount; ++i)
+            targets[i].depthScaleKnown = false;
+    }
+
+    bool usesSource(const SR &s) const
+    {
+        for (size_t i = 0; i < sourceCount; ++i)
+            if (sources[i] == s)
+                return true;
+        return false;
+    }
+
+    Target *findTarget(const TG &t)
+    {
+        for (size_t i = 0; i < targetCount; ++i)
+            if (targets[i].target == t)
+                return &targets[i];
+        return nullptr;
+    }
+
+  private:
+    void addSource(const SR &s)
+    {
+        if (!usesSource(s))
+            sources[sourceCount++] = s;
+    }
+};
+
 template <typename Matrix, typename P>
 void bindEl(Matrix &m, const P &payload, typename Matrix::TR::TargetIdentifier &tg, float &tgs,
             const float *&p, std::optional<datamodel::pmd> providedMetadata = std::nullopt)
@@ -216,6 +285,18 @@ void bindEl(Matrix &m, const P &payload, typename Matrix::TR::TargetIdentifier &
         return;
     }
 
+    typename std::remove_pointer_t<decltype(m.routingPlan)>::Target *planTarget{nullptr};
+    if (m.routingPlan)
+    {
+        planTarget = m.routingPlan->findTarget(tg);
+        if (!planTarget)
+        {
+            // Nothing modulates this so it can read the base value directly
+            p = &tgs;
+            return;
+        }
+    }
+
     m.bindTargetBaseValue(tg, tgs);
     p = m.getTargetValuePointer(tg);
 
@@ -230,25 +311,37 @@ void bindEl(Matrix &m, const P &payload, typename Matrix::TR::TargetIdentifier &
     }
 #endif
 
-    auto idxIt = m.targetToOutputIndex.find(tg);
-    if (idxIt != m.targetToOutputIndex.end())
-    {
-        datamodel::pmd tmd;
+    auto describe = [&]() {
         if (!providedMetadata.has_value())
+            return datamodel::describeValue(payload, tgs);
+        return *providedMetadata;
+    };
+
+    float depthScale{0.f};
+    if (planTarget)
+    {
+        if (!planTarget->depthScaleKnown)
         {
-            tmd = datamodel::describeValue(payload, tgs);
-        }
-        else
-        {
-            tmd = *providedMetadata;
+            auto tmd = describe();
+            planTarget->depthScale = tmd.maxVal - tmd.minVal;
+            planTarget->depthScaleKnown = true;
         }
-        auto pt = m.getTargetValuePointer(tg);
-        for (auto &r : m.routingValuePointers)
+        depthScale = planTarget->depthScale;
+    }
+    else
+    {
+        auto idxIt = m.targetToOutputIndex.find(tg);
+        if (idxIt == m.targetToOutputIndex.end())
+            return;
+        auto tmd = describe();
+        depthScale = tmd.maxVal - tmd.minVal;
+    }
+
+    for (auto &r : m.routingValuePointers)
+    {
+        if (r.target == p)
         {
-            if (r.target == pt)
-            {
-                r.depthScale = tmd.maxVal - tmd.minVal;
-            }
+            r.depthScale = depthScale;
         }
     }
 };
@@ -32,6 +32,6 @@ namespace scxt::modulation
 std::vector<ModulationCurves::CurveIdentifier> ModulationCurves::allCurves;
 std::unordered_map<ModulationCurves::CurveIdentifier, std::pair<std::string, std::string>>
     ModulationCurves::curveNames;
-std::unordered_map<ModulationCurves::CurveIdentifier, std::function<float(float)>>
-    ModulationCurves::curveImpls;
+float ModulationCurves::sinTable[ModulationCurves::sinTableSize + 1]{};
+std::atomic<bool> ModulationCurves::curvesInitialized{false};
 } // namespace scxt::modulation
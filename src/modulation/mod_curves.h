@@ -28,6 +28,9 @@
 #ifndef SCXT_SRC_MODULATION_MOD_CURVES_H
 #define SCXT_SRC_MODULATION_MOD_CURVES_H
 
+#include <algorithm>
+#include <array>
+#include <atomic>
 #include <cmath>
 #include <cstdint>
 #include <thread>
@@ -47,9 +50,173 @@ struct ModulationCurves
 
     using CurveIdentifier = uint32_t;
 
+    /*
+     * Curves are evaluated by kind through a switch rather than a std::function per
+     * curve, so a caller which knows the kind gets an inlined body and the matrix,
+     * which wants a function, gets a plain function pointer per kind. The waveform
+     * curves read a small sine table rather than calling std::sin / std::cos.
+     */
+    enum Kind : uint8_t
+    {
+        X2,
+        X3,
+        UNIP,
+        ABSX,
+        HWPO,
+        HWNE,
+        UWPO,
+        UWNE,
+        CMP0,
+        CMN0,
+        CMPH,
+        CMNH,
+        SINX,
+        COSX,
+        TRIX,
+        TRIP,
+        D_1,
+        D_01,
+
+        numKinds,
+        UNKNOWN = numKinds
+    };
+
+    // The streaming id of each kind. Never change these
+    static constexpr CurveIdentifier idForKind[numKinds]{
+        'x2  ', 'x3  ', 'unip', 'absx', 'hwpo', 'hwne', 'uwpo', 'uwne', 'cmp0',
+        'cmn0', 'cmph', 'cmnh', 'sinx', 'cosx', 'trix', 'trip', 'd.1 ', 'd.01'};
+
+    static Kind kindFor(CurveIdentifier id)
+    {
+        for (int k = 0; k < numKinds; ++k)
+            if (idForKind[k] == id)
+                return (Kind)k;
+        return UNKNOWN;
+    }
+
     static std::vector<CurveIdentifier> allCurves;
     static std::unordered_map<CurveIdentifier, std::pair<std::string, std::string>> curveNames;
-    static std::unordered_map<CurveIdentifier, std::function<float(float)>> curveImpls;
+
+    static constexpr int sinTableSize{1024};
+    static float sinTable[sinTableSize + 1];
+    // Set once initializeCurves has filled sinTable and the curve lists
+    static std::atomic<bool> curvesInitialized;
+
+    // sin(2 pi x), linearly interpolated from sinTable. 0 for non finite x.
+    static inline float sin2pi(float x)
+    {
+        if (!std::isfinite(x))
+            return 0.f;
+        auto ph = x - std::floor(x);
+        auto fi = ph * sinTableSize;
+        // ph can round up to exactly 1 for tiny negative x
+        auto i = std::clamp((int)fi, 0, sinTableSize - 1);
+        auto f = fi - i;
+        return sinTable[i] + f * (sinTable[i + 1] - sinTable[i]);
+    }
+
+    static inline float evaluate(Kind k, float x)
+    {
+        switch (k)
+        {
+        case X2:
+            return x * x;
+        case X3:
+            return x * x * x;
+        case UNIP:
+            return (x + 1.f) * 0.5f;
+        case ABSX:
+            return std::fabs(x);
+        case HWPO:
+            return std::max(x, 0.f);
+        case HWNE:
+            return std::min(x, 0.f);
+        case UWPO:
+            return std::max(x, 0.5f);
+        case UWNE:
+            return std::min(x, 0.5f);
+        case CMP0:
+            return x > 0.f ? 1.f : 0.f;
+        case CMN0:
+            return x < 0.f ? 1.f : 0.f;
+        case CMPH:
+            return x > 0.5f ? 1.f : 0.f;
+        case CMNH:
+            return x < 0.5f ? 1.f : 0.f;
+        case SINX:
+            return sin2pi(x);
+        case COSX:
+            return sin2pi(x + 0.25f);
+        case TRIX:
+        {
+            if (x < 0)
+                x += 1;
+            if (x < 0.25f)
+            {
+                // 0 -> 0.25 maps to 0 -> 1
+                return 4 * x;
+            }
+            if (x < 0.75f)
+            {
+                // 0.25 -> 0.75 maps to 1 -> -1
+                return 1.f - 4 * (x - 0.25f);
+            }
+            // 0.75 -> 1 maps to -1 to 0
+            return (x - 1) * 4;
+        }
+        case TRIP:
+        {
+            if (x < 0)
+                x += 1;
+            if (x < 0.5f)
+            {
+                // 0 -> 0.5 maps to -1 -> 1
+                return 4 * x - 1.f;
+            }
+            // 0.5 -> 1 maps to 1 -> -1
+            return 1.f - 4 * (x - 0.5f);
+        }
+        case D_1:
+            return x * 0.1f;
+        case D_01:
+            return x * 0.01f;
+        case numKinds:
+            break;
+        }
+        return x;
+    }
+
+    template <Kind K> static float evaluateAs(float x) { return evaluate(K, x); }
+
+    // Apply a curve in place over a block of values, one loop per kind
+    template <Kind K> static void evaluateBlockAs(float *__restrict x, size_t n)
+    {
+        for (size_t i = 0; i < n; ++i)
+            x[i] = evaluate(K, x[i]);
+    }
+
+    using curveFn_t = float (*)(float);
+    using curveBlockFn_t = void (*)(float *__restrict, size_t);
+
+    static constexpr std::array<curveFn_t, numKinds> curveFns{
+        &evaluateAs<X2>, &evaluateAs<X3>, &evaluateAs<UNIP>, &evaluateAs<ABSX>, &evaluateAs<HWPO>,
+        &evaluateAs<HWNE>, &evaluateAs<UWPO>, &evaluateAs<UWNE>, &evaluateAs<CMP0>,
+        &evaluateAs<CMN0>, &evaluateAs<CMPH>, &evaluateAs<CMNH>, &evaluateAs<SINX>,
+        &evaluateAs<COSX>, &evaluateAs<TRIX>, &evaluateAs<TRIP>, &evaluateAs<D_1>,
+        &evaluateAs<D_01>};
+    static constexpr std::array<curveBlockFn_t, numKinds> curveBlockFns{
+        &evaluateBlockAs<X2>, &evaluateBlockAs<X3>, &evaluateBlockAs<UNIP>, &evaluateBlockAs<ABSX>,
+        &evaluateBlockAs<HWPO>, &evaluateBlockAs<HWNE>, &evaluateBlockAs<UWPO>,
+        &evaluateBlockAs<UWNE>, &evaluateBlockAs<CMP0>, &evaluateBlockAs<CMN0>,
+        &evaluateBlockAs<CMPH>, &evaluateBlockAs<CMNH>, &evaluateBlockAs<SINX>,
+        &evaluateBlockAs<COSX>, &evaluateBlockAs<TRIX>, &evaluateBlockAs<TRIP>,
+        &evaluateBlockAs<D_1>, &evaluateBlockAs<D_01>};
+
+    static inline void evaluateBlock(Kind k, float *__restrict x, size_t n)
+    {
+        if (k < numKinds)
+            curveBlockFns[k](x, n);
+    }
 
     static inline void initializeCurves()
     {
@@ -59,85 +226,57 @@ struct ModulationCurves
         if (!allCurves.empty())
             return;
 
-        auto add = [](uint32_t tag, const std::string &cat, const std::string &nm,
-                      std::function<float(float)> fn) {
+        for (int i = 0; i <= sinTableSize; ++i)
+            sinTable[i] = (float)std::sin(2.0 * M_PI * i / sinTableSize);
+
+        auto add = [](uint32_t tag, const std::string &cat, const std::string &nm) {
             auto ci = CurveIdentifier{tag};
             assert(curveNames.find(ci) == curveNames.end());
+            assert(kindFor(ci) != UNKNOWN);
             allCurves.push_back(ci);
             curveNames.insert_or_assign(ci, std::make_pair(cat, nm));
-            curveImpls.insert_or_assign(ci, fn);
         };
         // change anything you want *except* the first argument
         // which is the streaming id. the menu is created with empty
         // cat first then the others in order
-        add('x2  ', "", "x^2", [](auto x) { return x * x; });
-        add('x3  ', "", "x^3", [](auto x) { return x * x * x; });
-        add('unip', "", "(x+1)/2", [](auto x) { return (x + 1.f) / 2.f; });
-        add('absx', "Rectifiers", "|x|", [](auto x) { return std::fabs(x); });
-        add('hwpo', "Rectifiers", "max(x,0)", [](auto x) { return std::max(x, 0.f); });
-        add('hwne', "Rectifiers", "min(x,0)", [](auto x) { return std::min(x, 0.f); });
-        add('uwpo', "Rectifiers", "max(x,1/2)", [](auto x) { return std::max(x, 0.5f); });
-        add('uwne', "Rectifiers", "min(x,1/2)", [](auto x) { return std::min(x, 0.5f); });
-
-        add('cmp0', "Comparators", "x > 0", [](auto x) { return x > 0.f ? 1.f : 0.f; });
-        add('cmn0', "Comparators", "x < 0", [](auto x) { return x < 0.f ? 1.f : 0.f; });
-        add('cmph', "Comparators", "x > 1/2", [](auto x) { return x > 0.5f ? 1.f : 0.f; });
-        add('cmnh', "Comparators", "x < 1/2", [](auto x) { return x < 0.5f ? 1.f : 0.f; });
-
-        add('sinx', "Waveforms", std::string("sin(2") + u8"\U000003C0" + "x)", // thats pi
-            [](auto x) { return std::sin(2.0 * M_PI * x); });
-        add('cosx', "Waveforms", std::string("cos(2") + u8"\U000003C0" + "x)", // thats pi
-            [](auto x) { return std::cos(2.0 * M_PI * x); });
-        add('trix', "Waveforms", std::string("tri(x)"), [](auto x) -> float {
-            auto res = 0.f;
-            if (x < 0)
-                x += 1;
-            if (x < 0.25)
-            {
-                // 0 -> 0.25 maps to 0 -> 1
-                res = 4 * x;
-            }
-            else if (x < 0.75)
-            {
-                // 0.25 -> 0.75 maps to 1 -> -1
-                res = (1.f - 4 * (x - 0.25));
-            }
-            else
-            {
-                // 0.75 -> 1 maps to -1 to 0
-                res = (x - 1) * 4;
-            }
-            return res;
-        });
-        add('trip', "Waveforms", "tri(x+1/4)", [](auto x) -> float {
-            auto res = 0.f;
-            if (x < 0)
-                x += 1;
-            if (x < 0.5)
-            {
-                // 0 -> 0.5 maps to -1 -> 1
-                res = 4 * x - 1.f;
-            }
-            else
-            {
-                // 0.5 -> 1 maps to 1 -> -1
-                res = (1.f - 4 * (x - 0.5));
-            }
-            return res;
-        });
+        add('x2  ', "", "x^2");
+        add('x3  ', "", "x^3");
+        add('unip', "", "(x+1)/2");
+        add('absx', "Rectifiers", "|x|");
+        add('hwpo', "Rectifiers", "max(x,0)");
+        add('hwne', "Rectifiers", "min(x,0)");
+        add('uwpo', "Rectifiers", "max(x,1/2)");
+        add('uwne', "Rectifiers", "min(x,1/2)");
+
+        add('cmp0', "Comparators", "x > 0");
+        add('cmn0', "Comparators", "x < 0");
+        add('cmph', "Comparators", "x > 1/2");
+        add('cmnh', "Comparators", "x < 1/2");
 
-        add('d.1 ', "Scale", "x / 10", [](auto x) { return x * 0.1; });
-        add('d.01', "Scale", "x / 100", [](auto x) { return x * 0.01; });
+        add('sinx', "Waveforms", std::string("sin(2") + u8"\U000003C0" + "x)"); // thats pi
+        add('cosx', "Waveforms", std::string("cos(2") + u8"\U000003C0" + "x)"); // thats pi
+        add('trix', "Waveforms", std::string("tri(x)"));
+        add('trip', "Waveforms", "tri(x+1/4)");
+
+        add('d.1 ', "Scale", "x / 10");
+        add('d.01', "Scale", "x / 100");
+
+        curvesInitialized.store(true, std::memory_order_release);
     }
 
+    // The matrix wants a std::function. Wrapping a plain function pointer needs no map
+    // lookup and no allocation, and the call lands on the inlined switch for the kind.
     static std::function<float(float)> getCurveOperator(CurveIdentifier id)
     {
-        auto ptr = curveImpls.find(id);
-        assert(ptr != curveImpls.end());
-        if (ptr == curveImpls.end())
+        // The engine initializes these as it starts, but an operator is no use without them
+        if (!curvesInitialized.load(std::memory_order_acquire))
+            initializeCurves();
+
+        auto k = kindFor(id);
+        assert(k != UNKNOWN);
+        if (k == UNKNOWN)
             return nullptr;
-        else
-            return ptr->second;
+        return curveFns[k];
     }
 };
 } // namespace scxt::modulation
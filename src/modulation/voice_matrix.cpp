@@ -41,7 +41,6 @@ namespace scxt::voice::modulation
 std::unordered_set<MatrixConfig::TargetIdentifier> MatrixConfig::multiplicativeTargets;
 
 namespace shmo = scxt::modulation::shared;
-sst::basic_blocks::dsp::RNG rng;
 
 void MatrixEndpoints::bindTargetBaseValues(scxt::voice::modulation::Matrix &m, engine::Zone &z)
 {
@@ -98,7 +97,7 @@ void MatrixEndpoints::ProcessorTarget::bind(scxt::voice::modulation::Matrix &m,
     }
 }
 
-float randomRoll(bool bipolar, int distribution)
+float randomRoll(sst::basic_blocks::dsp::RNG &rng, bool bipolar, int distribution)
 {
     if (bipolar)
     {
@@ -127,32 +126,45 @@ float randomRoll(bool bipolar, int distribution)
 void MatrixEndpoints::Sources::bind(scxt::voice::modulation::Matrix &m, engine::Zone &z,
                                     voice::Voice &v)
 {
+    // With a plan we only bind what the routing table refers to
+    const auto *plan = m.routingPlan;
+    auto uses = [plan](const SR &s) { return !plan || plan->usesSource(s); };
+
     lfoSources.bind(m, v, zeroSource);
 
-    m.bindSourceValue(aegSource, v.aeg.outBlock0);
-    m.bindSourceValue(eg2Source, v.eg2.outBlock0);
+    if (uses(aegSource))
+        m.bindSourceValue(aegSource, v.aeg.outBlock0);
+    if (uses(eg2Source))
+        m.bindSourceValue(eg2Source, v.eg2.outBlock0);
 
-    m.bindSourceValue(midiSources.modWheelSource,
-                      z.parentGroup->parentPart->midiCCSmoothers[1].output);
-    m.bindSourceValue(midiSources.velocitySource, v.velocity);
+    if (uses(midiSources.modWheelSource))
+        m.bindSourceValue(midiSources.modWheelSource,
+                          z.parentGroup->parentPart->midiCCSmoothers[1].output);
+    if (uses(midiSources.velocitySource))
+        m.bindSourceValue(midiSources.velocitySource, v.velocity);
 
     for (int i = 0; i < scxt::numTransportPhasors; ++i)
     {
-        m.bindSourceValue(transportSources.phasors[i], z.getEngine()->transportPhasors[i]);
-        m.bindSourceValue(transportSources.voicePhasors[i], v.transportPhasors[i]);
+        if (uses(transportSources.phasors[i]))
+            m.bindSourceValue(transportSources.phasors[i], z.getEngine()->transportPhasors[i]);
+        if (uses(transportSources.voicePhasors[i]))
+            m.bindSourceValue(transportSources.voicePhasors[i], v.transportPhasors[i]);
     }
 
+    auto *part = z.parentGroup->parentPart;
     for (int i = 0; i < 8; ++i)
     {
+        if (!uses(rngSources.randoms[i]))
+            continue;
         bool bip = (i % 4 > 1) ? false : true;
         int dist = (i < 4) ? 0 : 1;
-        m.bindSourceConstantValue(rngSources.randoms[i], randomRoll(bip, dist));
+        m.bindSourceConstantValue(rngSources.randoms[i], randomRoll(part->rng, bip, dist));
     }
 
-    auto *part = z.parentGroup->parentPart;
     for (int i = 0; i < macrosPerPart; ++i)
     {
-        m.bindSourceValue(macroSources.macros[i], part->macros[i].value);
+        if (uses(macroSources.macros[i]))
+            m.bindSourceValue(macroSources.macros[i], part->macros[i].value);
     }
 }
 
@@ -93,9 +93,16 @@ struct MatrixConfig
 
 namespace scxt::voice::modulation
 {
+using RoutingPlan =
+    scxt::modulation::shared::RoutingPlan<MatrixConfig::SourceIdentifier,
+                                          MatrixConfig::TargetIdentifier,
+                                          MatrixConfig::FixedMatrixSize>;
+
 struct Matrix : sst::basic_blocks::mod_matrix::FixedMatrix<MatrixConfig>
 {
     bool forUIMode{false};
+    // The zone's compiled plan, if any. See RoutingPlan and Zone::onRoutingChanged
+    RoutingPlan *routingPlan{nullptr};
     std::unordered_map<MatrixConfig::TargetIdentifier, datamodel::pmd> activeTargetsToPMD;
     std::unordered_map<MatrixConfig::TargetIdentifier, float> activeTargetsToBaseValue;
 };
@@ -0,0 +1,156 @@
+/*
+ * Shortcircuit XT - a Surge Synth Team product
+ *
+ * A fully featured creative sampler, available as a standalone
+ * and plugin for multiple platforms.
+ *
+ * Copyright 2019 - 2024, Various authors, as described in the github
+ * transaction log.
+ *
+ * ShortcircuitXT is released under the Gnu General Public Licence
+ * V3 or later (GPL-3.0-or-later). The license is found in the file
+ * "LICENSE" in the root of this repository or at
+ * https://www.gnu.org/licenses/gpl-3.0.en.html
+ *
+ * Individual sections of code which comprises ShortcircuitXT in this
+ * repository may also be used under an MIT license. Please see the
+ * section  "Licensing" in "README.md" for details.
+ *
+ * ShortcircuitXT is inspired by, and shares code with, the
+ * commercial product Shortcircuit 1 and 2, released by VemberTech
+ * in the mid 2000s. The code for Shortcircuit 2 was opensourced in
+ * 2020 at the outset of this project.
+ *
+ * All source for ShortcircuitXT is available at
+ * https://github.com/surge-synthesizer/shortcircuit-xt
+ */
+
+#include "decoded_sample_cache.h"
+#include "sample.h"
+
+#include <algorithm>
+#include <functional>
+#include <thread>
+#include <tuple>
+#include <vector>
+
+namespace scxt::sample
+{
+static constexpr const char *decodedCacheExtension{".scxtpcm"};
+
+DecodedSampleCache::DecodedSampleCache(const fs::path &d, uint64_t mb) : dir(d), maxBytes(mb)
+{
+    std::error_code ec;
+    fs::create_directories(dir, ec);
+    if (ec)
+    {
+        SCLOG("Unable to create decoded sample cache at " << dir.u8string() << " : "
+                                                          << ec.message());
+    }
+}
+
+bool DecodedSampleCache::isCacheable(const fs::path &source)
+{
+    return extensionMatches(source, ".flac") || extensionMatches(source, ".mp3");
+}
+
+fs::path DecodedSampleCache::entryPath(const std::string &md5) const
+{
+    return dir / (md5 + decodedCacheExtension);
+}
+
+bool DecodedSampleCache::load(Sample &s, const fs::path &source, const std::string &md5)
+{
+    if (md5.empty())
+        return false;
+
+    auto p = entryPath(md5);
+    std::error_code ec;
+    if (!fs::exists(p, ec) || !s.loadDecodedCacheFile(p, source))
+    {
+        misses++;
+        return false;
+    }
+
+    // Keep recently used entries at the back of the line for trim
+    fs::last_write_time(p, fs::file_time_type::clock::now(), ec);
+    hits++;
+    return true;
+}
+
+void DecodedSampleCache::store(const Sample &s, const std::string &md5)
+{
+    if (md5.empty() || s.getDataSize() > maxBytes)
+        return;
+
+    auto dest = entryPath(md5);
+    auto tmp = dir / fmt::format("{}.{:x}.tmp", md5,
+                                 std::hash<std::thread::id>{}(std::this_thread::get_id()));
+    std::error_code ec;
+    if (!s.writeDecodedCacheFile(tmp))
+    {
+        SCLOG("Unable to write decoded sample cache entry for " << s.getPath().u8string());
+        fs::remove(tmp, ec);
+        return;
+    }
+    fs::rename(tmp, dest, ec);
+    if (ec)
+    {
+        fs::remove(tmp, ec);
+        return;
+    }
+    stores++;
+
+    auto sz = fs::file_size(dest, ec);
+    std::lock_guard<std::mutex> g(sizeMutex);
+    if (!sizeKnown || ec)
+    {
+        trimLocked();
+        return;
+    }
+    // Replacing an entry counts it twice, which just brings the next scan forward
+    estimatedBytes += sz;
+    if (estimatedBytes > maxBytes)
+        trimLocked();
+}
+
+void DecodedSampleCache::trimLocked()
+{
+    std::vector<std::tuple<fs::file_time_type, uint64_t, fs::path>> entries;
+    uint64_t total{0};
+    std::error_code ec;
+    for (auto it = fs::directory_iterator(dir, ec); !ec && it != fs::directory_iterator();
+         it.increment(ec))
+    {
+        const auto &p = it->path();
+        if (p.extension().u8string() != decodedCacheExtension)
+            continue;
+        std::error_code fec;
+        auto sz = fs::file_size(p, fec);
+        auto mt = fs::last_write_time(p, fec);
+        if (fec)
+            continue;
+        total += sz;
+        entries.emplace_back(mt, sz, p);
+    }
+    sizeKnown = true;
+    estimatedBytes = total;
+    if (total <= maxBytes)
+        return;
+
+    std::sort(entries.begin(), entries.end(),
+              [](const auto &a, const auto &b) { return std::get<0>(a) < std::get<0>(b); });
+    for (const auto &[mt, sz, p] : entries)
+    {
+        if (total <= maxBytes)
+            break;
+        std::error_code rec;
+        if (fs::remove(p, rec))
+        {
+            total -= sz;
+            evictions++;
+        }
+    }
+    estimatedBytes = total;
+}
+} // namespace scxt::sample
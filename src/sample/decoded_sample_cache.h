@@ -0,0 +1,85 @@
+/*
+ * Shortcircuit XT - a Surge Synth Team product
+ *
+ * A fully featured creative sampler, available as a standalone
+ * and plugin for multiple platforms.
+ *
+ * Copyright 2019 - 2024, Various authors, as described in the github
+ * transaction log.
+ *
+ * ShortcircuitXT is released under the Gnu General Public Licence
+ * V3 or later (GPL-3.0-or-later). The license is found in the file
+ * "LICENSE" in the root of this repository or at
+ * https://www.gnu.org/licenses/gpl-3.0.en.html
+ *
+ * Individual sections of code which comprises ShortcircuitXT in this
+ * repository may also be used under an MIT license. Please see the
+ * section  "Licensing" in "README.md" for details.
+ *
+ * ShortcircuitXT is inspired by, and shares code with, the
+ * commercial product Shortcircuit 1 and 2, released by VemberTech
+ * in the mid 2000s. The code for Shortcircuit 2 was opensourced in
+ * 2020 at the outset of this project.
+ *
+ * All source for ShortcircuitXT is available at
+ * https://github.com/surge-synthesizer/shortcircuit-xt
+ */
+
+#ifndef SCXT_SRC_SAMPLE_DECODED_SAMPLE_CACHE_H
+#define SCXT_SRC_SAMPLE_DECODED_SAMPLE_CACHE_H
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <string>
+
+#include "utils.h"
+#include "infrastructure/filesystem_import.h"
+
+namespace scxt::sample
+{
+struct Sample;
+
+/**
+ * The DecodedSampleCache keeps the PCM we decode from compressed files (FLAC and MP3) on
+ * disk, keyed by the md5 of the source, so later loads map it rather than decoding again.
+ * See Sample::writeDecodedCacheFile for the format.
+ *
+ * Entries are written under a temporary name and renamed into place so other loaders, in
+ * this process or another, never see a partial one. When the cache outgrows maxBytes we
+ * remove the least recently used entries by modification time, which a hit refreshes.
+ * A removed entry stays readable by anyone who has it mapped. Everything here is safe to
+ * call from loader threads.
+ */
+struct DecodedSampleCache : MoveableOnly<DecodedSampleCache>
+{
+    DecodedSampleCache(const fs::path &dir, uint64_t maxBytes);
+
+    static bool isCacheable(const fs::path &source);
+
+    // Map the entry for this md5 into s, returning false on a miss
+    bool load(Sample &s, const fs::path &source, const std::string &md5);
+    // Write an entry for a freshly decoded s, trimming the cache if that takes it over size
+    void store(const Sample &s, const std::string &md5);
+
+    std::atomic<uint64_t> hits{0}, misses{0}, stores{0}, evictions{0};
+
+  private:
+    fs::path entryPath(const std::string &md5) const;
+    // Scan the directory for the real size and drop the oldest entries down to maxBytes
+    void trimLocked();
+
+    fs::path dir;
+    uint64_t maxBytes{0};
+    /*
+     * A running total of the cache size, so a batch load doesn't scan the directory on
+     * every store. We scan on the first store and whenever the total passes maxBytes,
+     * which also catches up with entries other processes wrote.
+     */
+    uint64_t estimatedBytes{0};
+    bool sizeKnown{false};
+    std::mutex sizeMutex;
+};
+} // namespace scxt::sample
+
+#endif // SCXT_SRC_SAMPLE_DECODED_SAMPLE_CACHE_H
@@ -0,0 +1,234 @@
+/*
+ * Shortcircuit XT - a Surge Synth Team product
+ *
+ * A fully featured creative sampler, available as a standalone
+ * and plugin for multiple platforms.
+ *
+ * Copyright 2019 - 2024, Various authors, as described in the github
+ * transaction log.
+ *
+ * ShortcircuitXT is released under the Gnu General Public Licence
+ * V3 or later (GPL-3.0-or-later). The license is found in the file
+ * "LICENSE" in the root of this repository or at
+ * https://www.gnu.org/licenses/gpl-3.0.en.html
+ *
+ * Individual sections of code which comprises ShortcircuitXT in this
+ * repository may also be used under an MIT license. Please see the
+ * section  "Licensing" in "README.md" for details.
+ *
+ * ShortcircuitXT is inspired by, and shares code with, the
+ * commercial product Shortcircuit 1 and 2, released by VemberTech
+ * in the mid 2000s. The code for Shortcircuit 2 was opensourced in
+ * 2020 at the outset of this project.
+ *
+ * All source for ShortcircuitXT is available at
+ * https://github.com/surge-synthesizer/shortcircuit-xt
+ */
+
+#include "disk_streamer.h"
+#include "sample.h"
+
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+
+namespace scxt::sample
+{
+DiskStreamer::DiskStreamer()
+{
+    if (!allocateChunk())
+        SCLOG("Unable to allocate disk streaming banks. Streamed samples will only play heads");
+
+    ioThread = std::make_unique<std::thread>([this]() { run(); });
+}
+
+DiskStreamer::~DiskStreamer()
+{
+    keepRunning = false;
+    wakeCondition.notify_all();
+    if (ioThread)
+    {
+        ioThread->join();
+        ioThread.reset();
+    }
+    for (auto *c : bankChunks)
+        free(c);
+}
+
+bool DiskStreamer::allocateChunk()
+{
+    auto chunk = allocatedStreams.load() / streamsPerChunk;
+    if (chunkAllocationFailed || chunk >= bankChunks.size())
+        return false;
+
+    // Size every bank for the widest (F32) format so any stream can serve any sample
+    auto bankBytes = bankFrames * sizeof(float);
+    auto chunkBytes = bankBytes * streamsPerChunk * 4;
+    auto *mem = (uint8_t *)malloc(chunkBytes);
+    if (!mem)
+    {
+        chunkAllocationFailed = true;
+        return false;
+    }
+    memset(mem, 0, chunkBytes);
+    bankChunks[chunk] = mem;
+
+    for (uint32_t i = 0; i < streamsPerChunk; ++i)
+    {
+        auto &s = streams[chunk * streamsPerChunk + i];
+        for (int b = 0; b < 2; ++b)
+        {
+            for (int c = 0; c < 2; ++c)
+            {
+                s.bankData[b][c] = mem;
+                mem += bankBytes;
+            }
+        }
+        s.state.store(Stream::FREE, std::memory_order_release);
+    }
+    allocatedStreams += streamsPerChunk;
+    return true;
+}
+
+DiskStreamer::Stream *DiskStreamer::acquire(Sample *smp)
+{
+    for (auto &s : streams)
+    {
+        int32_t expected{Stream::FREE};
+        if (s.state.compare_exchange_strong(expected, Stream::ACTIVE, std::memory_order_acq_rel))
+        {
+            s.sample = smp;
+            s.front = 0;
+            s.frontValid = false;
+            s.backState.store(Stream::IDLE, std::memory_order_release);
+            activeStreams++;
+            return &s;
+        }
+    }
+    acquireFailures++;
+    return nullptr;
+}
+
+void DiskStreamer::release(Stream *s)
+{
+    assert(s && s->state == Stream::ACTIVE);
+    activeStreams--;
+    s->state.store(Stream::RELEASED, std::memory_order_release);
+}
+
+bool DiskStreamer::requestWindow(Stream *s, int64_t start)
+{
+    if (s->backState.load(std::memory_order_acquire) == Stream::REQUESTED)
+        return false;
+
+    s->requestedStart = start;
+    s->backState.store(Stream::REQUESTED, std::memory_order_release);
+    return true;
+}
+
+bool DiskStreamer::swapIfReady(Stream *s)
+{
+    if (s->backState.load(std::memory_order_acquire) != Stream::READY)
+        return false;
+
+    s->front = s->back();
+    s->frontValid = true;
+    s->backState.store(Stream::IDLE, std::memory_order_release);
+    return true;
+}
+
+void DiskStreamer::forgetSample(Sample *smp)
+{
+    std::lock_guard<std::mutex> g(ioMutex);
+    for (auto &s : streams)
+    {
+        Sample *expected{smp};
+        s.sample.compare_exchange_strong(expected, nullptr);
+    }
+}
+
+void DiskStreamer::fill(Stream &s)
+{
+    std::lock_guard<std::mutex> g(ioMutex);
+
+    auto bank = s.back();
+    auto start = s.requestedStart;
+    auto *smp = s.sample.load();
+    if (smp)
+    {
+        for (int c = 0; c < smp->channels; ++c)
+        {
+            smp->decodeStreamedFrames(c, start - dsp::FIRoffset, bankFrames, s.bankData[bank][c]);
+        }
+    }
+    else
+    {
+        // The sample has gone away under a releasing voice. Hand back silence.
+        memset(s.bankData[bank][0], 0, bankFrames * sizeof(float));
+        memset(s.bankData[bank][1], 0, bankFrames * sizeof(float));
+    }
+    s.bankStart[bank] = start;
+    windowsRead++;
+    s.backState.store(Stream::READY, std::memory_order_release);
+}
+
+void DiskStreamer::run()
+{
+    using namespace std::chrono_literals;
+
+    while (keepRunning)
+    {
+        bool didWork{false};
+        uint32_t freeStreams{0};
+        for (auto &s : streams)
+        {
+            auto st = s.state.load(std::memory_order_acquire);
+            if (st == Stream::RELEASED)
+            {
+                std::lock_guard<std::mutex> g(ioMutex);
+                s.sample = nullptr;
+                s.backState = Stream::IDLE;
+                s.state.store(Stream::FREE, std::memory_order_release);
+                freeStreams++;
+            }
+            else if (st == Stream::FREE)
+            {
+                freeStreams++;
+            }
+            else if (st == Stream::ACTIVE &&
+                     s.backState.load(std::memory_order_acquire) == Stream::REQUESTED)
+            {
+                fill(s);
+                didWork = true;
+            }
+        }
+
+        if (freeStreams < streamsPerChunk / 2 && !chunkAllocationFailed &&
+            allocatedStreams < maxStreams)
+        {
+            if (allocateChunk())
+                didWork = true;
+            else
+                SCLOG("Unable to allocate more disk streams beyond " << allocatedStreams.load());
+        }
+
+        auto failures = acquireFailures.load();
+        if (failures != reportedAcquireFailures)
+        {
+            SCLOG(failures - reportedAcquireFailures
+                  << " voices started without a disk stream and will only play their sample "
+                     "head. Streams allocated: "
+                  << allocatedStreams.load());
+            reportedAcquireFailures = failures;
+        }
+
+        if (!didWork)
+        {
+            // The audio thread doesn't signal us (it can't block) so we poll at a rate
+            // well inside the time it takes to play through windowOverlap frames.
+            std::unique_lock<std::mutex> lk(wakeMutex);
+            wakeCondition.wait_for(lk, 1ms);
+        }
+    }
+}
+} // namespace scxt::sample
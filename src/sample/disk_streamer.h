@@ -0,0 +1,161 @@
+/*
+ * Shortcircuit XT - a Surge Synth Team product
+ *
+ * A fully featured creative sampler, available as a standalone
+ * and plugin for multiple platforms.
+ *
+ * Copyright 2019 - 2024, Various authors, as described in the github
+ * transaction log.
+ *
+ * ShortcircuitXT is released under the Gnu General Public Licence
+ * V3 or later (GPL-3.0-or-later). The license is found in the file
+ * "LICENSE" in the root of this repository or at
+ * https://www.gnu.org/licenses/gpl-3.0.en.html
+ *
+ * Individual sections of code which comprises ShortcircuitXT in this
+ * repository may also be used under an MIT license. Please see the
+ * section  "Licensing" in "README.md" for details.
+ *
+ * ShortcircuitXT is inspired by, and shares code with, the
+ * commercial product Shortcircuit 1 and 2, released by VemberTech
+ * in the mid 2000s. The code for Shortcircuit 2 was opensourced in
+ * 2020 at the outset of this project.
+ *
+ * All source for ShortcircuitXT is available at
+ * https://github.com/surge-synthesizer/shortcircuit-xt
+ */
+
+#ifndef SCXT_SRC_SAMPLE_DISK_STREAMER_H
+#define SCXT_SRC_SAMPLE_DISK_STREAMER_H
+
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+
+#include "configuration.h"
+#include "utils.h"
+#include "dsp/resampling.h"
+
+namespace scxt::sample
+{
+struct Sample;
+
+/**
+ * The DiskStreamer owns a set of streams, each of which a playing voice of a disk
+ * streamed sample can hold. A stream has two banks of windowFrames frames. The voice
+ * plays from the front bank (or from the resident head / loop of the sample) and asks
+ * for the next window in the back bank; the I/O thread decodes that window from the
+ * mapped file and hands it back.
+ *
+ * There is a stream for every voice the engine can play, plus room for released streams
+ * the I/O thread hasn't recycled yet. Bank memory for all of them is a lot, so we
+ * allocate the first streamsPerChunk up front and the I/O thread allocates another chunk
+ * whenever free streams run low. The audio thread never allocates or locks. A voice
+ * which can't get a stream anyway plays its resident head and then underruns; we count
+ * those in acquireFailures and the I/O thread logs them.
+ *
+ * The protocol is lock free between audio and I/O. The audio thread acquires and
+ * releases streams and moves the back bank IDLE/READY -> REQUESTED. The I/O thread
+ * moves REQUESTED -> READY and returns RELEASED streams to FREE. The serialization
+ * thread calls forgetSample when a streamed sample is destroyed, which is the only
+ * place the ioMutex is contended.
+ */
+struct DiskStreamer : MoveableOnly<DiskStreamer>
+{
+    static constexpr uint32_t streamsPerChunk{32};
+    static constexpr uint32_t maxStreams{maxVoices + streamsPerChunk};
+    static constexpr uint32_t windowFrames{1 << 15};
+    // How far back into the new window we request so the play point is covered on swap
+    static constexpr uint32_t windowOverlap{windowFrames >> 2};
+    static constexpr uint32_t bankFrames{windowFrames + dsp::FIRipol_N};
+
+    struct Stream
+    {
+        enum State : int32_t
+        {
+            UNALLOCATED,
+            FREE,
+            ACTIVE,
+            RELEASED
+        };
+        enum BankState : int32_t
+        {
+            IDLE,
+            REQUESTED,
+            READY
+        };
+        std::atomic<int32_t> state{UNALLOCATED};
+        std::atomic<int32_t> backState{IDLE};
+        std::atomic<Sample *> sample{nullptr};
+
+        // Audio thread only, other than requestedStart which is handed over by backState
+        int32_t front{0};
+        bool frontValid{false};
+        int64_t requestedStart{0};
+
+        // bankStart[b] is written by the I/O thread before it marks the bank READY
+        int64_t bankStart[2]{0, 0};
+        // [bank][channel]. Each holds [bankStart - FIRoffset, bankStart + windowFrames +
+        // FIRoffset)
+        void *bankData[2][2]{{nullptr, nullptr}, {nullptr, nullptr}};
+
+        int back() const { return 1 - front; }
+        bool frontCovers(int64_t lo, int64_t hi) const
+        {
+            return frontValid && bankCovers(front, lo, hi);
+        }
+        bool bankCovers(int bank, int64_t lo, int64_t hi) const
+        {
+            return lo >= bankStart[bank] - dsp::FIRoffset &&
+                   hi <= bankStart[bank] + windowFrames + dsp::FIRoffset;
+        }
+    };
+
+    DiskStreamer();
+    ~DiskStreamer();
+
+    /*
+     * Audio thread API
+     */
+    Stream *acquire(Sample *s);
+    void release(Stream *s);
+    // Ask for the window starting at start in the back bank. Returns false if a fill is
+    // already in flight, in which case try again next block.
+    bool requestWindow(Stream *s, int64_t start);
+    // If the back bank is ready, make it the front.
+    bool swapIfReady(Stream *s);
+
+    /*
+     * Serialization thread API
+     */
+    void forgetSample(Sample *s);
+
+    std::atomic<uint64_t> underrunCount{0};
+    std::atomic<uint64_t> windowsRead{0};
+    std::atomic<uint32_t> activeStreams{0};
+    std::atomic<uint64_t> acquireFailures{0};
+    std::atomic<uint32_t> allocatedStreams{0};
+
+  private:
+    void run();
+    void fill(Stream &s);
+    bool allocateChunk();
+
+    static_assert(maxStreams % streamsPerChunk == 0);
+    std::array<Stream, maxStreams> streams;
+    std::array<void *, maxStreams / streamsPerChunk> bankChunks{};
+    bool chunkAllocationFailed{false};
+    uint64_t reportedAcquireFailures{0};
+
+    std::mutex ioMutex;
+    std::mutex wakeMutex;
+    std::condition_variable wakeCondition;
+    std::atomic<bool> keepRunning{true};
+    std::unique_ptr<std::thread> ioThread;
+};
+} // namespace scxt::sample
+
+#endif // SCXT_SRC_SAMPLE_DISK_STREAMER_H
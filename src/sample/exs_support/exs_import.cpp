@@ -31,6 +31,7 @@
 #include <cstdint>
 #include "utils.h"
 #include "exs_import.h"
+#include "messaging/messaging.h"
 
 namespace scxt::exs_support
 {
@@ -559,14 +560,36 @@ bool importEXS(const fs::path &p, engine::Engine &e)
     std::unordered_map<int, SampleID> exsIndexToSampleId;
     std::vector<SampleID> sampleIDByOrder;
 
+    std::vector<fs::path> samplePaths;
     for (auto &s : samples)
     {
-        auto p = fs::path{s.filePath} / s.fileName;
-        auto lsid = e.getSampleManager()->loadSampleByPath(p);
+        samplePaths.push_back(fs::path{s.filePath} / s.fileName);
+    }
+
+    std::vector<std::optional<SampleID>> loadedIds;
+    {
+        auto &cont = *e.getMessageController();
+        auto cng = messaging::MessageController::ClientActivityNotificationGuard(
+            "Loading EXS Samples", cont);
+        loadedIds = e.getSampleManager()->loadSamplesByPath(samplePaths, [&cont](auto done,
+                                                                                  auto total) {
+            if (done % 16 == 0 || done == total)
+            {
+                cont.updateClientActivityNotification("Loading EXS Samples (" +
+                                                          std::to_string(done) + "/" +
+                                                          std::to_string(total) + ")",
+                                                      1);
+            }
+        });
+    }
+
+    for (auto i = 0U; i < samples.size(); ++i)
+    {
+        const auto &lsid = loadedIds[i];
         if (lsid.has_value())
         {
             sampleIDByOrder.push_back(*lsid);
-            exsIndexToSampleId[s.within.index] = *lsid;
+            exsIndexToSampleId[samples[i].within.index] = *lsid;
         }
     }
 
@@ -0,0 +1,158 @@
+/*
+ * Shortcircuit XT - a Surge Synth Team product
+ *
+ * A fully featured creative sampler, available as a standalone
+ * and plugin for multiple platforms.
+ *
+ * Copyright 2019 - 2024, Various authors, as described in the github
+ * transaction log.
+ *
+ * ShortcircuitXT is released under the Gnu General Public Licence
+ * V3 or later (GPL-3.0-or-later). The license is found in the file
+ * "LICENSE" in the root of this repository or at
+ * https://www.gnu.org/licenses/gpl-3.0.en.html
+ *
+ * Individual sections of code which comprises ShortcircuitXT in this
+ * repository may also be used under an MIT license. Please see the
+ * section  "Licensing" in "README.md" for details.
+ *
+ * ShortcircuitXT is inspired by, and shares code with, the
+ * commercial product Shortcircuit 1 and 2, released by VemberTech
+ * in the mid 2000s. The code for Shortcircuit 2 was opensourced in
+ * 2020 at the outset of this project.
+ *
+ * All source for ShortcircuitXT is available at
+ * https://github.com/surge-synthesizer/shortcircuit-xt
+ */
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+
+#include "sample/sample.h"
+#include "infrastructure/file_map_view.h"
+
+namespace scxt::sample
+{
+namespace detail
+{
+/*
+ * A decoded cache file is this header then each channel exactly as we hold it in memory,
+ * including the zero frames either side, at aligned strides so it can be played straight
+ * from a mapping. It is in native byte order since it never leaves this machine.
+ */
+struct DecodedCacheHeader
+{
+    char magic[8]{'S', 'C', 'X', 'T', 'P', 'C', 'M', 0};
+    uint32_t version{1};
+    uint32_t sampleRate{0};
+    uint32_t sampleLength{0};
+    uint32_t channels{0};
+    uint32_t bitDepth{0};
+    // The zero padding either side of each channel, which sets where the frames start
+    uint32_t firOffset{0};
+    uint64_t dataOffset{0};
+    uint64_t channelStride{0};
+};
+
+static constexpr uint64_t decodedCacheAlignment{64};
+inline uint64_t decodedCacheAlign(uint64_t v)
+{
+    return (v + decodedCacheAlignment - 1) & ~(decodedCacheAlignment - 1);
+}
+inline uint64_t decodedCacheChannelBytes(uint32_t length, Sample::BitDepth bd)
+{
+    return ((uint64_t)length + dsp::FIRipol_N) * Sample::bitDepthByteSize(bd);
+}
+} // namespace detail
+
+bool Sample::writeDecodedCacheFile(const fs::path &dest) const
+{
+    if (isMemoryMapped || isDiskStreamed || channels < 1 || channels > 2 || !sampleData[0])
+        return false;
+
+    auto bytes = detail::decodedCacheChannelBytes(sample_length, bitDepth);
+    detail::DecodedCacheHeader h;
+    h.sampleRate = sample_rate;
+    h.sampleLength = sample_length;
+    h.channels = channels;
+    h.bitDepth = bitDepth;
+    h.firOffset = dsp::FIRoffset;
+    h.dataOffset = detail::decodedCacheAlign(sizeof(h));
+    h.channelStride = detail::decodedCacheAlign(bytes);
+
+    std::ofstream of(dest, std::ios::binary | std::ios::trunc);
+    if (!of)
+        return false;
+
+    static const char zeros[detail::decodedCacheAlignment]{};
+    of.write((const char *)&h, sizeof(h));
+    of.write(zeros, h.dataOffset - sizeof(h));
+    for (int c = 0; c < channels; ++c)
+    {
+        of.write((const char *)sampleData[c], bytes);
+        of.write(zeros, h.channelStride - bytes);
+    }
+    return of.good();
+}
+
+bool Sample::loadDecodedCacheFile(const fs::path &cacheFile, const fs::path &source)
+{
+    auto fmv = std::make_unique<infrastructure::FileMapView>(cacheFile);
+    if (!fmv->isMapped() || fmv->dataSize() < sizeof(detail::DecodedCacheHeader))
+        return false;
+
+    detail::DecodedCacheHeader h, expected;
+    memcpy(&h, fmv->data(), sizeof(h));
+    if (memcmp(h.magic, expected.magic, sizeof(h.magic)) != 0 || h.version != expected.version)
+        return false;
+    if (h.channels < 1 || h.channels > 2 || h.bitDepth > BD_I24)
+        return false;
+    // Written by a build with different interpolator padding; we would read the wrong frames
+    if (h.firOffset != dsp::FIRoffset)
+        return false;
+
+    // Every channel must start aligned, past the header, and end inside the file. Check
+    // the bounds by division so a corrupt stride can't overflow past them.
+    auto bd = (BitDepth)h.bitDepth;
+    auto fileSize = (uint64_t)fmv->dataSize();
+    if (h.dataOffset < sizeof(h) || h.dataOffset % detail::decodedCacheAlignment != 0 ||
+        h.channelStride % detail::decodedCacheAlignment != 0 || h.dataOffset > fileSize)
+        return false;
+    if (h.channelStride < detail::decodedCacheChannelBytes(h.sampleLength, bd) ||
+        h.channelStride > (fileSize - h.dataOffset) / h.channels)
+        return false;
+
+    clear_data();
+    sample_rate = h.sampleRate;
+    sample_length = h.sampleLength;
+    channels = h.channels;
+    bitDepth = bd;
+    for (int c = 0; c < channels; ++c)
+    {
+        auto offset = h.dataOffset + c * h.channelStride;
+        sampleData[c] = (uint8_t *)fmv->data() + offset;
+        fmv->prefault(offset, h.channelStride);
+    }
+    isMemoryMapped = true;
+    isFromDecodedCache = true;
+    memoryMap = std::move(fmv);
+
+    // Match what the decoders and load() set
+    mFileName = source;
+    displayName = fmt::format("{}", source.filename().u8string());
+    if (extensionMatches(source, ".flac"))
+    {
+        type = FLAC_FILE;
+        instrument = 0;
+        region = 0;
+    }
+    else
+    {
+        type = MP3_FILE;
+    }
+    publishResidentSnapshot();
+    sample_loaded = true;
+    return true;
+}
+} // namespace scxt::sample
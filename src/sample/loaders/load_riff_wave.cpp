@@ -122,6 +122,44 @@ bool Sample::save_wave_file(const fs::path &filename)
     return true;
 }
 
+bool Sample::setupMemoryMappedData(int formatTag, int bitsPerSample, uint8_t *frames,
+                                   uint32_t frameCount)
+{
+    // The generator wants each channel contiguous, so only mono data can play in place
+    if (channels != 1 || frameCount < minMappedFrames)
+        return false;
+
+    // WAV data is little endian, as are all our targets, so these need no conversion
+    BitDepth bd{BD_I16};
+    if (formatTag == WAVE_FORMAT_PCM && bitsPerSample == 16)
+        bd = BD_I16;
+    else if (formatTag == WAVE_FORMAT_IEEE_FLOAT && bitsPerSample == 32)
+        bd = BD_F32;
+    else if (formatTag == WAVE_FORMAT_PCM && bitsPerSample == 24 && packI24)
+        bd = BD_I24;
+    else
+        return false;
+
+    // We read the data in place as its storage type, so it needs that type's alignment.
+    // Packed 24 bit is a byte array and can sit anywhere.
+    size_t align{alignof(int16_t)};
+    if (bd == BD_F32)
+        align = alignof(float);
+    else if (bd == BD_I24)
+        align = alignof(dsp::PackedI24);
+    if ((uintptr_t)frames % align != 0)
+        return false;
+
+    auto bytes = bitDepthByteSize(bd);
+
+    // Sit FIRoffset frames early like an allocated buffer so GetSamplePtr* work as usual.
+    // Those frames are the wav header and are never read since voices set unpadded.
+    sampleData[0] = frames - dsp::FIRoffset * bytes;
+    bitDepth = bd;
+    isMemoryMapped = true;
+    return true;
+}
+
 // TODO [prior] parse INAM etc etc metadata
 bool Sample::parse_riff_wave(void *data, size_t filesize, bool skip_riffchunk)
 {
@@ -193,47 +231,60 @@ bool Sample::parse_riff_wave(void *data, size_t filesize, bool skip_riffchunk)
         return false;
     }
 
-    if (wh.wFormatTag == WAVE_FORMAT_PCM)
+    if (mapWavData)
+        setupMemoryMappedData(wh.wFormatTag, wh.wBitsPerSample, loaddata, WaveDataSamples);
+
+    // When disk streaming, only decode the head of the file here
+    auto residentFrames = WaveDataSamples;
+    if (!isMemoryMapped && diskStreamHeadFrames > 0 &&
+        WaveDataSamples > 2 * (int64_t)diskStreamHeadFrames)
+        residentFrames = diskStreamHeadFrames;
+
+    if (isMemoryMapped)
+    {
+        // Nothing to decode, we play from the file
+    }
+    else if (wh.wFormatTag == WAVE_FORMAT_PCM)
     {
         if (wh.wBitsPerSample == 8)
         {
             if (channels == 2)
             {
-                load_data_ui8(0, loaddata, WaveDataSamples, 2);
-                load_data_ui8(1, loaddata + 1, WaveDataSamples, 2);
+                load_data_ui8(0, loaddata, residentFrames, 2);
+                load_data_ui8(1, loaddata + 1, residentFrames, 2);
             }
             else
-                load_data_ui8(0, loaddata, WaveDataSamples, 1);
+                load_data_ui8(0, loaddata, residentFrames, 1);
         }
         else if (wh.wBitsPerSample == 16)
         {
             if (channels == 2)
             {
-                load_data_i16(0, loaddata, WaveDataSamples, 4);
-                load_data_i16(1, loaddata + 2, WaveDataSamples, 4);
+                load_data_i16(0, loaddata, residentFrames, 4);
+                load_data_i16(1, loaddata + 2, residentFrames, 4);
             }
             else
-                load_data_i16(0, loaddata, WaveDataSamples, 2);
+                load_data_i16(0, loaddata, residentFrames, 2);
         }
         else if (wh.wBitsPerSample == 24)
         {
             if (channels == 2)
             {
-                load_data_i24(0, loaddata, WaveDataSamples, 6);
-                load_data_i24(1, loaddata + 3, WaveDataSamples, 6);
+                load_data_i24(0, loaddata, residentFrames, 6);
+                load_data_i24(1, loaddata + 3, residentFrames, 6);
             }
             else
-                load_data_i24(0, loaddata, WaveDataSamples, 3);
+                load_data_i24(0, loaddata, residentFrames, 3);
         }
         else if (wh.wBitsPerSample == 32)
         {
             if (channels == 2)
             {
-                load_data_i32(0, loaddata, WaveDataSamples, 8);
-                load_data_i32(1, loaddata + 4, WaveDataSamples, 8);
+                load_data_i32(0, loaddata, residentFrames, 8);
+                load_data_i32(1, loaddata + 4, residentFrames, 8);
             }
             else
-                load_data_i32(0, loaddata, WaveDataSamples, 4);
+                load_data_i32(0, loaddata, residentFrames, 4);
         }
         else
         {
@@ -248,21 +299,21 @@ bool Sample::parse_riff_wave(void *data, size_t filesize, bool skip_riffchunk)
         {
             if (channels == 2)
             {
-                load_data_f32(0, loaddata, WaveDataSamples, 8);
-                load_data_f32(1, loaddata + 4, WaveDataSamples, 8);
+                load_data_f32(0, loaddata, residentFrames, 8);
+                load_data_f32(1, loaddata + 4, residentFrames, 8);
             }
             else
-                load_data_f32(0, loaddata, WaveDataSamples, 4);
+                load_data_f32(0, loaddata, residentFrames, 4);
         }
         else if (wh.wBitsPerSample == 64)
         {
             if (channels == 2)
             {
-                load_data_f64(0, loaddata, WaveDataSamples, 16);
-                load_data_f64(1, loaddata + 8, WaveDataSamples, 16);
+                load_data_f64(0, loaddata, residentFrames, 16);
+                load_data_f64(1, loaddata + 8, residentFrames, 16);
             }
             else
-                load_data_f64(0, loaddata, WaveDataSamples, 8);
+                load_data_f64(0, loaddata, residentFrames, 8);
         }
         else
         {
@@ -280,6 +331,21 @@ bool Sample::parse_riff_wave(void *data, size_t filesize, bool skip_riffchunk)
               << std::setfill('0') << WAVE_FORMAT_PCM << ")");
         return false;
     }
+
+    if (residentFrames != WaveDataSamples)
+    {
+        auto bps = wh.wBitsPerSample / 8;
+        auto fmt = DS_PCM16;
+        if (wh.wFormatTag == WAVE_FORMAT_PCM)
+        {
+            fmt = (bps == 1) ? DS_PCM8 : (bps == 2) ? DS_PCM16 : (bps == 3) ? DS_PCM24 : DS_PCM32;
+        }
+        else
+        {
+            fmt = (bps == 4) ? DS_F32 : DS_F64;
+        }
+        setupDiskStream(fmt, loaddata, bps * channels, bps);
+    }
     this->sample_loaded = true;
 
     // read smpl chunk
@@ -307,6 +373,7 @@ bool Sample::parse_riff_wave(void *data, size_t filesize, bool skip_riffchunk)
                 meta.playmode = pm_forward_loop;
         }
     }
+    setupResidentLoopRegion();
 
     // read inst chunk
     mf.SeekI(wr);
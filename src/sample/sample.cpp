@@ -31,6 +31,7 @@
 #include "infrastructure/md5support.h"
 #include "dsp/resampling.h"
 #include "sample.h"
+#include "disk_streamer.h"
 
 namespace scxt::sample
 {
@@ -38,12 +39,34 @@ namespace scxt::sample
 // Fine in a cpp
 using namespace sst::basic_blocks::mechanics;
 
+struct Sample::DiskStreamSource
+{
+    std::unique_ptr<infrastructure::FileMapView> map;
+    DiskStreamFormat format{DS_PCM16};
+    const uint8_t *frames{nullptr};
+    uint32_t frameStride{0};
+    uint32_t bytesPerSample{0};
+};
+
+// Out of line so the members we only forward declare are complete here
+Sample::Sample() : id(SampleID::next()) {}
+Sample::Sample(const SampleID &sid) : displayName(sid.to_string()), id(sid) {}
+
 Sample::~Sample()
 {
-    if (sampleData[0])
+    if (diskStreamer)
+        diskStreamer->forgetSample(this);
+
+    // A memory mapped sample's data belongs to the mapping
+    if (sampleData[0] && !isMemoryMapped)
         free(sampleData[0]);
-    if (sampleData[1])
+    if (sampleData[1] && !isMemoryMapped)
         free(sampleData[1]);
+    for (auto *r : {&residentLoop, &residentLoopEnd})
+    {
+        free(r->data[0]);
+        free(r->data[1]);
+    }
 }
 
 bool Sample::load(const fs::path &path)
@@ -51,7 +74,8 @@ bool Sample::load(const fs::path &path)
     if (!fs::exists(path))
         return false;
 
-    md5Sum = infrastructure::createMD5SumFromFile(path);
+    // md5Sum is filled in by the SampleManager, which can use its cache and hash
+    // concurrently with this decode
 
     // If you add a type here add it in Browser::isLoadableFile also to stay in sync
     if (extensionMatches(path, ".wav"))
@@ -66,6 +90,22 @@ bool Sample::load(const fs::path &path)
         if (!r)
             return false;
 
+        if (isMemoryMapped)
+        {
+            // sampleData points into the mapped file, so keep it open
+            auto bytes = bitDepthByteSize(bitDepth);
+            auto offset =
+                (uint8_t *)sampleData[0] + scxt::dsp::FIRoffset * bytes - (uint8_t *)data;
+            fmv->prefault(offset, (size_t)sample_length * channels * bytes);
+            memoryMap = std::move(fmv);
+        }
+        else if (isDiskStreamed)
+        {
+            // The streamer decodes the body from the mapped file, so keep it open
+            diskStreamSource->map = std::move(fmv);
+        }
+
+        publishResidentSnapshot();
         sample_loaded = true;
         mFileName = path;
         displayName = fmt::format("{}", path.filename().u8string());
@@ -76,6 +116,7 @@ bool Sample::load(const fs::path &path)
     {
         if (parseFlac(path))
         {
+            publishResidentSnapshot();
             sample_loaded = true;
             type = FLAC_FILE;
             mFileName = path;
@@ -87,6 +128,7 @@ bool Sample::load(const fs::path &path)
     {
         if (parseMP3(path))
         {
+            publishResidentSnapshot();
             sample_loaded = true;
             type = MP3_FILE;
             mFileName = path;
@@ -104,6 +146,7 @@ bool Sample::load(const fs::path &path)
 
         bool r = parse_aiff(data, datasize);
         // TODO deal with return value
+        publishResidentSnapshot();
         type = AIFF_FILE;
         sample_loaded = true;
         mFileName = path;
@@ -157,6 +200,7 @@ bool Sample::loadFromSF2(const fs::path &p, sf2::File *f, int presetNum, int ins
         // >> 1 here because void* -> int16_t is byte to two bytes
         load_data_i16(0, buf.pStart, buf.Size >> 1, sfsample->GetFrameSize());
         sfsample->ReleaseSampleData();
+        publishResidentSnapshot();
         return true;
     }
     else if (frameSize == 4 && sfsample->GetChannelCount() == 2 &&
@@ -177,6 +221,7 @@ bool Sample::loadFromSF2(const fs::path &p, sf2::File *f, int presetNum, int ins
             load_data_i16(0, (int16_t *)(buf.pStart) + 1, buf.Size >> 2, sfsample->GetFrameSize());
         }
         sfsample->ReleaseSampleData();
+        publishResidentSnapshot();
         return true;
     }
     else if (sfsample->GetFrameSize() == 3 && sfsample->GetChannelCount() == 1)
@@ -185,6 +230,7 @@ bool Sample::loadFromSF2(const fs::path &p, sf2::File *f, int presetNum, int ins
         channels = 1;
         auto buf = sfsample->LoadSampleData();
         load_data_i24(0, (void *)(buf.pStart), buf.Size, sfsample->GetFrameSize());
+        publishResidentSnapshot();
         return true;
     }
 
@@ -212,6 +258,14 @@ float *Sample::GetSamplePtrF32(int Channel)
         return nullptr;
     return &((float *)sampleData[Channel])[scxt::dsp::FIRoffset];
 }
+dsp::PackedI24 *Sample::GetSamplePtrI24(int Channel)
+{
+    if (bitDepth != BD_I24)
+        return nullptr;
+    if (!sampleData[Channel])
+        return nullptr;
+    return &((dsp::PackedI24 *)sampleData[Channel])[scxt::dsp::FIRoffset];
+}
 
 // TODO: What the heck is this doing?
 bool Sample::allocateI16(int Channel, int Samples)
@@ -250,6 +304,24 @@ bool Sample::allocateF32(int Channel, int Samples)
 
     return true;
 }
+bool Sample::allocateI24(int Channel, int Samples)
+{
+    static constexpr size_t sz{sizeof(dsp::PackedI24)};
+    int samplesizewithmargin = Samples + scxt::dsp::FIRipol_N;
+    if (sampleData[Channel])
+        free(sampleData[Channel]);
+    sampleData[Channel] = malloc(sz * samplesizewithmargin);
+    if (!sampleData[Channel])
+        return false;
+    bitDepth = BD_I24;
+
+    // clear pre/post zero area
+    memset(sampleData[Channel], 0, scxt::dsp::FIRoffset * sz);
+    memset((char *)sampleData[Channel] + (Samples + scxt::dsp::FIRoffset) * sz, 0,
+           scxt::dsp::FIRoffset * sz);
+
+    return true;
+}
 
 bool Sample::load_data_ui8(int channel, void *data, unsigned int samplesize, unsigned int stride)
 {
@@ -326,6 +398,19 @@ bool Sample::load_data_i32BE(int channel, void *data, unsigned int samplesize, u
 
 bool Sample::load_data_i24(int channel, void *data, unsigned int samplesize, unsigned int stride)
 {
+    if (packI24)
+    {
+        allocateI24(channel, samplesize);
+        auto *sampledata = GetSamplePtrI24(channel);
+
+        for (int i = 0; i < samplesize; i++)
+        {
+            unsigned char *cval = (unsigned char *)data + i * stride;
+            sampledata[i] = {{cval[0], cval[1], cval[2]}};
+        }
+        return true;
+    }
+
     allocateF32(channel, samplesize);
     float *sampledata = GetSamplePtrF32(channel);
 
@@ -342,6 +427,19 @@ bool Sample::load_data_i24(int channel, void *data, unsigned int samplesize, uns
 
 bool Sample::load_data_i24BE(int channel, void *data, unsigned int samplesize, unsigned int stride)
 {
+    if (packI24)
+    {
+        allocateI24(channel, samplesize);
+        auto *sampledata = GetSamplePtrI24(channel);
+
+        for (int i = 0; i < samplesize; i++)
+        {
+            unsigned char *cval = (unsigned char *)data + i * stride;
+            sampledata[i] = {{cval[2], cval[1], cval[0]}};
+        }
+        return true;
+    }
+
     allocateF32(channel, samplesize);
     float *sampledata = GetSamplePtrF32(channel);
 
@@ -380,6 +478,183 @@ bool Sample::load_data_f64(int channel, void *data, unsigned int samplesize, uns
     return true;
 }
 
+size_t Sample::getResidentDataSize() const
+{
+    if (isMemoryMapped)
+        return 0;
+    if (!isDiskStreamed)
+        return getDataSize();
+
+    size_t res = (size_t)residentHeadFrames * bitDepthByteSize(bitDepth) * channels;
+    for (auto *r : {&residentLoop, &residentLoopEnd})
+        if (r->isValid())
+            res += (r->end - r->start) * bitDepthByteSize(bitDepth) * channels;
+    return res;
+}
+
+void Sample::setupDiskStream(DiskStreamFormat fmt, const uint8_t *frames, uint32_t frameStride,
+                             uint32_t bytesPerSample)
+{
+    diskStreamSource = std::make_unique<DiskStreamSource>();
+    diskStreamSource->format = fmt;
+    diskStreamSource->frames = frames;
+    diskStreamSource->frameStride = frameStride;
+    diskStreamSource->bytesPerSample = bytesPerSample;
+
+    isDiskStreamed = true;
+    residentHeadFrames = diskStreamHeadFrames;
+}
+
+void Sample::setupResidentLoopRegion()
+{
+    if (!isDiskStreamed || !meta.loop_present || meta.loop_end <= meta.loop_start)
+        return;
+
+    int64_t start = std::max((int64_t)meta.loop_start - (int64_t)diskStreamLoopPreroll, (int64_t)0);
+    int64_t end = std::min((int64_t)meta.loop_end, (int64_t)sample_length);
+
+    // Already covered by the head
+    if (end <= residentHeadFrames)
+        return;
+
+    if (end - start <=
+        std::max(4 * (int64_t)residentHeadFrames, 2 * (int64_t)diskStreamLoopWrapFrames))
+    {
+        setupResidentRegion(residentLoop, start, end);
+        return;
+    }
+
+    // Too long to keep, so keep each side of the wrap and stream the middle
+    auto startEnd = (int64_t)meta.loop_start + diskStreamLoopWrapFrames;
+    if (startEnd > residentHeadFrames)
+        setupResidentRegion(residentLoop, start, startEnd);
+    auto endStart = std::max(end - (int64_t)diskStreamLoopWrapFrames, startEnd);
+    setupResidentRegion(residentLoopEnd, endStart, end);
+}
+
+void Sample::setupResidentRegion(ResidentRegion &r, int64_t start, int64_t end)
+{
+    auto frames = (uint32_t)(end - start) + scxt::dsp::FIRipol_N;
+    for (int c = 0; c < channels; ++c)
+    {
+        r.data[c] = malloc(frames * bitDepthByteSize(bitDepth));
+        if (!r.data[c])
+        {
+            SCLOG("Unable to allocate resident loop for " << getDisplayName());
+            for (auto &d : r.data)
+            {
+                free(d);
+                d = nullptr;
+            }
+            return;
+        }
+        decodeStreamedFrames(c, start - scxt::dsp::FIRoffset, frames, r.data[c]);
+    }
+    r.start = start;
+    r.end = end;
+}
+
+void Sample::swapResidentData(Sample &o)
+{
+    assert(o.channels == channels && o.bitDepth == bitDepth && o.sample_length == sample_length);
+    assert(!isMemoryMapped && !o.isMemoryMapped);
+    std::swap(sampleData[0], o.sampleData[0]);
+    std::swap(sampleData[1], o.sampleData[1]);
+    std::swap(residentLoop, o.residentLoop);
+    std::swap(residentLoopEnd, o.residentLoopEnd);
+    std::swap(residentHeadFrames, o.residentHeadFrames);
+    std::swap(isDiskStreamed, o.isDiskStreamed);
+
+    // The streamer's I/O thread may still be filling a released stream through our
+    // source, so once we have one we keep it. Until then nothing can be reading it.
+    if (!diskStreamSource)
+        std::swap(diskStreamSource, o.diskStreamSource);
+
+    // Each snapshot travels with the buffers it describes, so a reader holding the old
+    // one keeps seeing the old buffers, which the retired sample holds on to for a while.
+    // Publish last so a reader who sees a streamed head also sees our stream source.
+    assert(residentSnapshotData && o.residentSnapshotData);
+    std::swap(residentSnapshotData, o.residentSnapshotData);
+    residentSnapshot.store(residentSnapshotData.get(), std::memory_order_release);
+    o.residentSnapshot.store(o.residentSnapshotData.get(), std::memory_order_release);
+}
+
+void Sample::publishResidentSnapshot()
+{
+    residentSnapshotData = std::make_unique<ResidentSnapshot>();
+    residentSnapshotData->data[0] = sampleData[0];
+    residentSnapshotData->data[1] = sampleData[1];
+    residentSnapshotData->frames = getResidentSampleLength();
+    residentSnapshot.store(residentSnapshotData.get(), std::memory_order_release);
+}
+
+Sample::ResidentSnapshot Sample::getResidentSnapshot() const
+{
+    if (auto *r = residentSnapshot.load(std::memory_order_acquire))
+        return *r;
+
+    // Only published samples can be swapped, so these fields are stable
+    ResidentSnapshot res;
+    res.data[0] = sampleData[0];
+    res.data[1] = sampleData[1];
+    res.frames = getResidentSampleLength();
+    return res;
+}
+
+void Sample::decodeStreamedFrames(int channel, int64_t start, uint32_t count, void *dest) const
+{
+    assert(diskStreamSource);
+    const auto &ds = *diskStreamSource;
+
+    auto decode = [&, this](auto *out, auto conv) {
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            auto f = start + i;
+            if (f < 0 || f >= sample_length)
+                out[i] = {};
+            else
+                out[i] = conv(ds.frames + f * ds.frameStride + channel * ds.bytesPerSample);
+        }
+    };
+
+    // These conversions need to match the load_data_ family exactly
+    switch (ds.format)
+    {
+    case DS_PCM8:
+        decode((short *)dest, [](const uint8_t *d) { return (short)(((short)*d - 128) << 8); });
+        break;
+    case DS_PCM16:
+        decode((short *)dest,
+               [](const uint8_t *d) { return (short)endian_read_int16LE(*(short *)d); });
+        break;
+    case DS_PCM24:
+        if (bitDepth == BD_I24)
+        {
+            decode((dsp::PackedI24 *)dest,
+                   [](const uint8_t *d) { return dsp::PackedI24{{d[0], d[1], d[2]}}; });
+            break;
+        }
+        decode((float *)dest, [](const uint8_t *d) {
+            int value = (d[2] << 16) | (d[1] << 8) | d[0];
+            value -= (value & 0x800000) << 1;
+            return 0.00000011920928955078f * float(value);
+        });
+        break;
+    case DS_PCM32:
+        decode((float *)dest, [](const uint8_t *d) {
+            int x = endian_read_int32LE(*(int *)d);
+            return (4.6566128730772E-10f) * (float)x;
+        });
+        break;
+    case DS_F32:
+        decode((float *)dest, [](const uint8_t *d) { return *(float *)d; });
+        break;
+    case DS_F64:
+        decode((float *)dest, [](const uint8_t *d) { return (float)(*(double *)d); });
+        break;
+    }
+}
+
 bool Sample::SetMeta(unsigned int Channels, unsigned int SampleRate, unsigned int SampleLength)
 {
     if (Channels > 2)
@@ -431,7 +706,7 @@ void Sample::dumpInformationToLog()
             auto *dat = GetSamplePtrI16(c);
             auto mxv = std::numeric_limits<int16_t>::min();
             auto mnv = std::numeric_limits<int16_t>::max();
-            for (int i = 0; i < sample_length; ++i)
+            for (int i = 0; i < getResidentSampleLength(); ++i)
             {
                 mxv = std::max(mxv, dat[i]);
                 mnv = std::min(mnv, dat[i]);
@@ -449,6 +724,24 @@ void Sample::dumpInformationToLog()
         SCLOG("TODO: Implement Sapmle Scan for F32");
     }
     break;
+    case BD_I24:
+    {
+        for (int c = 0; c < channels; ++c)
+        {
+            auto *dat = GetSamplePtrI24(c);
+            auto mxv = std::numeric_limits<int32_t>::min();
+            auto mnv = std::numeric_limits<int32_t>::max();
+            for (int i = 0; i < getResidentSampleLength(); ++i)
+            {
+                mxv = std::max(mxv, dat[i].toInt());
+                mnv = std::min(mnv, dat[i].toInt());
+            }
+            SCLOG("Min/Max = " << mxv << " " << mnv);
+            SCLOG("Min/Max Float Scaled = " << mxv * dsp::I24InvScale << " "
+                                            << mnv * dsp::I24InvScale);
+        }
+    }
+    break;
     }
 }
 
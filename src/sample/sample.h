@@ -27,12 +27,21 @@
 #ifndef SCXT_SRC_SAMPLE_SAMPLE_H
 #define SCXT_SRC_SAMPLE_SAMPLE_H
 
+#include <atomic>
+#include <memory>
 #include "utils.h"
 #include "infrastructure/filesystem_import.h"
 #include "SF.h"
+#include "dsp/resampling.h"
+
+namespace scxt::infrastructure
+{
+class FileMapView;
+}
 
 namespace scxt::sample
 {
+struct DiskStreamer;
 
 struct alignas(16) Sample : MoveableOnly<Sample>
 {
@@ -46,8 +55,8 @@ struct alignas(16) Sample : MoveableOnly<Sample>
         MULTISAMPLE_FILE,
     } type{WAV_FILE};
 
-    Sample() : id(SampleID::next()) {}
-    Sample(const SampleID &sid) : displayName(sid.to_string()), id(sid) {}
+    Sample();
+    Sample(const SampleID &sid);
     virtual ~Sample();
 
     void dumpInformationToLog();
@@ -94,6 +103,17 @@ struct alignas(16) Sample : MoveableOnly<Sample>
 
     size_t getDataSize() const { return sample_length * bitDepthByteSize(bitDepth) * channels; }
     size_t getSampleLength() const { return sample_length; }
+    // The bytes of sample data we hold in our own memory; memory mapped samples hold none
+    size_t getResidentDataSize() const;
+    size_t getMappedDataSize() const { return isMemoryMapped ? getDataSize() : 0; }
+    /*
+     * The number of frames from the start of the sample which are available
+     * in sampleData. This is the sample_length unless the sample is disk streamed.
+     */
+    size_t getResidentSampleLength() const
+    {
+        return isDiskStreamed ? residentHeadFrames : sample_length;
+    }
     std::string getBitDepthText() const { return bitDepthName(bitDepth); }
 
     bool parseFlac(const fs::path &p);
@@ -101,14 +121,142 @@ struct alignas(16) Sample : MoveableOnly<Sample>
 
     void *__restrict sampleData[2]{nullptr, nullptr};
 
+    /*
+     * Disk Streaming. If diskStreamHeadFrames is non-zero when we load, a long
+     * enough uncompressed WAV file keeps only its first diskStreamHeadFrames
+     * (and its smpl loop region, if it has one and it is short enough) in memory.
+     * The remainder stays in the mapped file and is decoded on demand into
+     * per-voice windows by the DiskStreamer I/O thread. Compressed formats and
+     * short files are always loaded fully. A loop too long to keep keeps just
+     * diskStreamLoopWrapFrames either side of the wrap (residentLoop holds the
+     * start and residentLoopEnd the end) so voices can jump across it while the
+     * stream catches up.
+     */
+    uint32_t diskStreamHeadFrames{0};
+    bool isDiskStreamed{false};
+    /*
+     * If set before we load, 24 bit PCM stays packed in memory as BD_I24 rather than
+     * being promoted to F32 and the generator converts as it interpolates. This saves
+     * a quarter of the memory for those samples.
+     */
+    bool packI24{false};
+
+    /*
+     * Memory mapped playback. If mapWavData is set before we load a long enough mono
+     * 16 bit or float WAV (or 24 bit, with packI24) we keep the file mapped and point
+     * sampleData straight into it. Nothing is copied and the OS page cache shares the
+     * frames across plugin instances and processes. The mapping has no zero padding so
+     * voices have the generator pad at the edges. Stereo files are interleaved, which
+     * the generator can't read in place, so they load as usual. We fault every page of
+     * the sample data in at load, off the audio thread. The OS may still drop clean
+     * pages under memory pressure, and a voice reading one afterwards waits on the disk
+     * on the audio thread, so mapping trades that risk for the memory it saves.
+     */
+    bool mapWavData{false};
+    bool isMemoryMapped{false};
+    static constexpr uint32_t minMappedFrames{4096};
+    /*
+     * Samples from the DecodedSampleCache are memory mapped too, but the file holds our
+     * data exactly as we would allocate it, zero padding and all, so it plays as is.
+     */
+    bool isFromDecodedCache{false};
+    bool loadDecodedCacheFile(const fs::path &cacheFile, const fs::path &source);
+    bool writeDecodedCacheFile(const fs::path &dest) const;
+    uint32_t residentHeadFrames{0};
+    struct ResidentRegion
+    {
+        // Each channel holds [start - FIRoffset, end + FIRoffset) of real sample data
+        void *data[2]{nullptr, nullptr};
+        int64_t start{0}, end{0};
+        bool isValid() const { return data[0] != nullptr; }
+    } residentLoop, residentLoopEnd;
+    DiskStreamer *diskStreamer{nullptr};
+
+    /*
+     * Memory budget residency; see SampleManager::setMemoryBudget. An evicted sample was
+     * loaded in full and now holds only a streamed head. The audio thread stamps
+     * residencyStamp at each voice start and raises reloadRequested if we are evicted. It
+     * also makes the swaps, so it is the only writer of isEvicted.
+     */
+    std::atomic<uint64_t> residencyStamp{0};
+    std::atomic<bool> reloadRequested{false};
+    std::atomic<int64_t> reloadRequestedAt{0}; // steady_clock ticks
+    bool isEvicted{false};
+    // Serialization thread only
+    bool residencyPending{false}, residencyPinned{false};
+    /*
+     * Exchange our resident data (and whether we stream) with other, which was loaded
+     * from the same file. Audio thread, with no voice reading our data; this doesn't
+     * allocate or free.
+     */
+    void swapResidentData(Sample &other);
+
+    /*
+     * The resident data and the number of frames it holds, published together. The
+     * audio thread swaps these when the memory budget evicts or reloads us, so other
+     * threads (the UI, analytics) should take a snapshot rather than pair
+     * getResidentSampleLength with GetSamplePtr*. The snapshot's buffers stay valid for
+     * SampleManager::residencyRetireGrace after a swap.
+     */
+    struct ResidentSnapshot
+    {
+        void *data[2]{nullptr, nullptr};
+        size_t frames{0};
+
+        // Like GetSamplePtr*, this skips the leading FIRoffset padding
+        template <typename T> const T *channel(int c) const
+        {
+            return data[c] ? (const T *)data[c] + dsp::FIRoffset : nullptr;
+        }
+    };
+    ResidentSnapshot getResidentSnapshot() const;
+
+    /*
+     * Decode count frames of channel starting at start (which may be negative
+     * or past the end, in which case those frames are zero) into dest, in the
+     * resident bitDepth. Safe to call from the streamer thread.
+     */
+    void decodeStreamedFrames(int channel, int64_t start, uint32_t count, void *dest) const;
+
     // TODO: Review evertyhing from here down before moving it above this comment
     bool parse_riff_wave(void *data, size_t filesize, bool skip_riffchunk = false);
     bool parse_aiff(void *data, size_t filesize);
     short *GetSamplePtrI16(int Channel);
     float *GetSamplePtrF32(int Channel);
+    dsp::PackedI24 *GetSamplePtrI24(int Channel);
     char *GetName();
 
+    // How far before a resident loop we also keep, so loop crossfades can read
+    static constexpr uint32_t diskStreamLoopPreroll{4096};
+    // How much of each end of a long loop we keep
+    static constexpr uint32_t diskStreamLoopWrapFrames{1 << 14};
+
   private:
+    enum DiskStreamFormat
+    {
+        DS_PCM8,
+        DS_PCM16,
+        DS_PCM24,
+        DS_PCM32,
+        DS_F32,
+        DS_F64
+    };
+    struct DiskStreamSource;
+    std::unique_ptr<DiskStreamSource> diskStreamSource;
+    void setupDiskStream(DiskStreamFormat fmt, const uint8_t *frames, uint32_t frameStride,
+                         uint32_t bytesPerSample);
+    void setupResidentLoopRegion();
+    void setupResidentRegion(ResidentRegion &r, int64_t start, int64_t end);
+
+    // Written once a load completes; swapResidentData exchanges them with the data
+    std::unique_ptr<ResidentSnapshot> residentSnapshotData;
+    std::atomic<const ResidentSnapshot *> residentSnapshot{nullptr};
+    void publishResidentSnapshot();
+
+    std::unique_ptr<infrastructure::FileMapView> memoryMap;
+    bool setupMemoryMappedData(int formatTag, int bitsPerSample, uint8_t *frames,
+                               uint32_t frameCount);
+
     bool parse_sf2_sample(void *data, size_t filesize, unsigned int sampleid);
     bool parse_dls_sample(void *data, size_t filesize, unsigned int sampleid);
 
@@ -120,12 +268,13 @@ struct alignas(16) Sample : MoveableOnly<Sample>
     // public data
     enum BitDepth
     {
-        // Right now 8 -> I16 at load and 24 -> F32 at load and noone supports 12 so just make this
+        // Right now 8 -> I16 at load and 24 -> F32 at load unless packI24 is set, and noone
+        // supports 12 so just make this
         // BD_I8,
         // BD_I12,
         BD_I16,
-        // BD_I24,
-        BD_F32
+        BD_F32,
+        BD_I24 // packed, three bytes a sample; see dsp::PackedI24
     } bitDepth{BD_F32};
 
     static std::string bitDepthName(BitDepth bd)
@@ -136,6 +285,8 @@ struct alignas(16) Sample : MoveableOnly<Sample>
             return "I16";
         case BD_F32:
             return "F32";
+        case BD_I24:
+            return "I24";
         default:
             return "UNKWN";
         }
@@ -149,6 +300,8 @@ struct alignas(16) Sample : MoveableOnly<Sample>
             return 2;
         case BD_F32:
             return 4;
+        case BD_I24:
+            return 3;
         default:
             return 1;
         }
@@ -215,6 +368,7 @@ struct alignas(16) Sample : MoveableOnly<Sample>
   public:
     bool allocateI16(int Channel, int Samples);
     bool allocateF32(int Channel, int Samples);
+    bool allocateI24(int Channel, int Samples);
 
     bool load_data_ui8(int channel, void *data, unsigned int samplesize, unsigned int stride);
     bool load_data_i8(int channel, void *data, unsigned int samplesize, unsigned int stride);
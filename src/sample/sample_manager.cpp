@@ -25,8 +25,16 @@
  * https://github.com/surge-synthesizer/shortcircuit-xt
  */
 
+#include <algorithm>
+#include <atomic>
 #include <cassert>
+#include <condition_variable>
+#include <deque>
+#include <future>
+#include <mutex>
+#include <thread>
 #include "sample_manager.h"
+#include "shared_sample_store.h"
 #include "infrastructure/md5support.h"
 
 namespace scxt::sample
@@ -34,6 +42,9 @@ namespace scxt::sample
 
 void SampleManager::restoreFromSampleAddressesAndIDs(const sampleAddressesAndIds_t &r)
 {
+    // Plain files can all decode at once; the container formats share open files so
+    // they stay in order on this thread
+    std::vector<std::pair<fs::path, SampleID>> byPath;
     for (const auto &[id, addr] : r)
     {
         if (!fs::exists(addr.path))
@@ -49,7 +60,7 @@ void SampleManager::restoreFromSampleAddressesAndIDs(const sampleAddressesAndIds
             case Sample::MP3_FILE:
             case Sample::AIFF_FILE:
             {
-                loadSampleByPathToID(addr.path, id);
+                byPath.emplace_back(addr.path, id);
             }
             break;
             case Sample::SF2_FILE:
@@ -66,18 +77,152 @@ void SampleManager::restoreFromSampleAddressesAndIDs(const sampleAddressesAndIds
             }
         }
     }
+
+    if (!byPath.empty())
+    {
+        loadSamplesByPathToIDs(byPath);
+    }
 }
 
-SampleManager::~SampleManager() { SCLOG("Destroying Sample Manager"); }
+/*
+ * The residency worker loads replacements for samples changing residency, one at a time,
+ * so a burst of reloads doesn't compete with the streamer for the disk.
+ */
+struct SampleManager::ResidencyWorker
+{
+    struct Job
+    {
+        std::shared_ptr<Sample> sample;
+        // Empty if the load failed or didn't give us what we need
+        std::shared_ptr<Sample> replacement;
+        bool toFullyResident{false};
+    };
+
+    ResidencyWorker() { thread = std::thread([this]() { run(); }); }
+    ~ResidencyWorker()
+    {
+        {
+            std::lock_guard<std::mutex> g(mutex);
+            keepRunning = false;
+        }
+        cv.notify_all();
+        thread.join();
+    }
 
-std::optional<SampleID> SampleManager::loadSampleByPath(const fs::path &p)
+    void push(Job &&j)
+    {
+        {
+            std::lock_guard<std::mutex> g(mutex);
+            todo.push_back(std::move(j));
+        }
+        cv.notify_one();
+    }
+
+    std::vector<Job> takeDone()
+    {
+        std::lock_guard<std::mutex> g(mutex);
+        std::vector<Job> res;
+        res.swap(done);
+        return res;
+    }
+
+  private:
+    void run()
+    {
+        while (true)
+        {
+            Job job;
+            {
+                std::unique_lock<std::mutex> lk(mutex);
+                cv.wait(lk, [this]() { return !keepRunning || !todo.empty(); });
+                if (!keepRunning)
+                    return;
+                job = std::move(todo.front());
+                todo.pop_front();
+            }
+
+            load(job);
+
+            std::lock_guard<std::mutex> g(mutex);
+            done.push_back(std::move(job));
+        }
+    }
+
+    static void load(Job &job)
+    {
+        const auto &s = *job.sample;
+        auto r = std::make_shared<Sample>(s.id);
+        r->packI24 = s.packI24;
+        r->diskStreamHeadFrames = job.toFullyResident ? 0 : diskStreamHeadFrames;
+        try
+        {
+            if (r->load(s.getPath()) && r->isDiskStreamed != job.toFullyResident &&
+                r->bitDepth == s.bitDepth && r->channels == s.channels &&
+                r->sample_length == s.sample_length)
+            {
+                job.replacement = r;
+            }
+        }
+        catch (const std::exception &e)
+        {
+            SCLOG("Exception reloading '" << s.getPath().u8string() << "' : " << e.what());
+        }
+    }
+
+    std::mutex mutex;
+    std::condition_variable cv;
+    std::deque<Job> todo;
+    std::vector<Job> done;
+    bool keepRunning{true};
+    std::thread thread;
+};
+
+SampleManager::SampleManager(const ThreadingChecker &t) : threadingChecker(t) {}
+
+SampleManager::~SampleManager()
 {
-    for (const auto &[alreadyId, sm] : samples)
+    SCLOG("Destroying Sample Manager");
+    residencyWorker.reset();
+    inFlightResidency.clear();
+    retiredResidentData.clear();
+    for (const auto &[id, smp] : samples)
     {
-        if (sm->getPath() == p)
+        releaseShared(smp);
+    }
+    if (diskStreamer)
+    {
+        // Stop the I/O thread while the samples are still alive, and make sure
+        // any sample held beyond us doesn't call back into a dead streamer
+        for (auto &[id, smp] : samples)
         {
-            return alreadyId;
+            smp->diskStreamer = nullptr;
         }
+        diskStreamer.reset();
+    }
+}
+
+void SampleManager::enableDiskStreaming()
+{
+    if (diskStreamer)
+        return;
+    SCLOG("Enabling disk streaming with " << diskStreamHeadFrames << " frame heads");
+    diskStreamer = std::make_unique<DiskStreamer>();
+}
+
+std::optional<SampleID> SampleManager::findSampleByPath(const fs::path &p) const
+{
+    auto it = samplesByPath.find(p.u8string());
+    if (it != samplesByPath.end())
+        return it->second;
+    return std::nullopt;
+}
+
+std::optional<SampleID> SampleManager::loadSampleByPath(const fs::path &p)
+{
+    auto already = findSampleByPath(p);
+    if (already.has_value())
+    {
+        return already;
     }
 
     return loadSampleByPathToID(p, SampleID::next());
@@ -88,30 +233,284 @@ std::optional<SampleID> SampleManager::loadSampleByPathToID(const fs::path &p, c
     assert(threadingChecker.isSerialThread());
     SampleID::guaranteeNextAbove(id);
 
-    for (const auto &[alreadyId, sm] : samples)
+    auto already = findSampleByPath(p);
+    if (already.has_value())
     {
-        if (sm->getPath() == p)
-        {
-            SCLOG("Potential concern: Asked to load '"
-                  << p.u8string() << "' into " << id.to_string() << " but it already exists at "
-                  << alreadyId.to_string());
-            return alreadyId;
-        }
+        SCLOG("Potential concern: Asked to load '"
+              << p.u8string() << "' into " << id.to_string() << " but it already exists at "
+              << already->to_string());
+        return already;
     }
 
     SCLOG("Loading [" << p.u8string() << "]  @ [" << id.to_string() << "]");
 
+    auto shared = acquireShared({Sample::WAV_FILE, p}, mapWavSamples,
+                                [this, &p]() { return md5ForFile(p); });
+    if (shared)
+    {
+        SCLOG("Using shared copy of [" << p.u8string() << "]");
+        samples[id] = shared;
+        samplesByPath[p.u8string()] = id;
+        updateSampleMemory();
+        return id;
+    }
+
     auto sp = std::make_shared<Sample>(id);
+    sp->packI24 = packI24Samples;
+    sp->mapWavData = mapWavSamples;
+    if (diskStreamer)
+    {
+        sp->diskStreamHeadFrames = diskStreamHeadFrames;
+    }
 
-    if (!sp->load(p))
+    if (!loadSampleWithMD5(*sp, p))
     {
         SCLOG("Failed to load sample from '" << p.u8string() << "'");
         return std::nullopt;
     }
+    if (sp->isDiskStreamed)
+    {
+        sp->diskStreamer = diskStreamer.get();
+    }
 
-    samples[sp->id] = sp;
+    // Another engine may have published this file while we decoded; if so use theirs
+    samples[id] = publishShared(sp);
+    samplesByPath[p.u8string()] = id;
     updateSampleMemory();
-    return sp->id;
+    return id;
+}
+
+bool SampleManager::fileCacheKey(const fs::path &p, uint64_t &size, int64_t &mtime) const
+{
+    std::error_code ec;
+    size = fs::file_size(p, ec);
+    if (ec)
+        return false;
+    mtime = fs::last_write_time(p, ec).time_since_epoch().count();
+    return !ec;
+}
+
+std::string SampleManager::md5ForFile(const fs::path &p)
+{
+    uint64_t size{0};
+    int64_t mtime{0};
+    auto haveKey = fileCacheKey(p, size, mtime);
+    if (haveKey && md5CacheLookup)
+    {
+        auto cached = md5CacheLookup(p, size, mtime);
+        if (cached.has_value())
+            return *cached;
+    }
+
+    auto res = infrastructure::createMD5SumFromFile(p);
+    if (haveKey && md5CacheStore && !res.empty())
+        md5CacheStore(p, size, mtime, res);
+    return res;
+}
+
+void SampleManager::enableDecodedSampleCache(const fs::path &dir, uint64_t maxBytes)
+{
+    SCLOG("Caching decoded samples in " << dir.u8string() << " up to " << (maxBytes >> 20)
+                                        << "MB");
+    decodedSampleCache = std::make_unique<DecodedSampleCache>(dir, maxBytes);
+}
+
+bool SampleManager::loadSampleWithMD5(Sample &s, const fs::path &p)
+{
+    auto useDecodedCache = decodedSampleCache && DecodedSampleCache::isCacheable(p);
+
+    uint64_t size{0};
+    int64_t mtime{0};
+    auto haveKey = fileCacheKey(p, size, mtime);
+    if (haveKey && md5CacheLookup)
+    {
+        auto cached = md5CacheLookup(p, size, mtime);
+        if (cached.has_value())
+        {
+            s.md5Sum = *cached;
+            if (useDecodedCache && decodedSampleCache->load(s, p, s.md5Sum))
+                return true;
+
+            auto res = s.load(p);
+            if (res && useDecodedCache)
+                decodedSampleCache->store(s, s.md5Sum);
+            return res;
+        }
+    }
+
+    // On a miss hash alongside the decode rather than reading the file twice in a row.
+    // The decoded cache is keyed by md5 so we can't look there without it, but we can
+    // still fill it for next time.
+    auto hash = std::async(std::launch::async,
+                           [p]() { return infrastructure::createMD5SumFromFile(p); });
+    auto res = s.load(p);
+    s.md5Sum = hash.get();
+    if (res && haveKey && md5CacheStore && !s.md5Sum.empty())
+        md5CacheStore(p, size, mtime, s.md5Sum);
+    if (res && useDecodedCache && !s.md5Sum.empty())
+        decodedSampleCache->store(s, s.md5Sum);
+    return res;
+}
+
+std::vector<std::optional<SampleID>>
+SampleManager::loadSamplesByPath(const std::vector<fs::path> &paths,
+                                 const loadProgressCallback_t &progress)
+{
+    std::vector<std::optional<SampleID>> ids(paths.size());
+    return loadSamplesInParallel(paths, ids, progress);
+}
+
+std::vector<std::optional<SampleID>>
+SampleManager::loadSamplesByPathToIDs(const std::vector<std::pair<fs::path, SampleID>> &pathsAndIds,
+                                      const loadProgressCallback_t &progress)
+{
+    std::vector<fs::path> paths;
+    std::vector<std::optional<SampleID>> ids;
+    paths.reserve(pathsAndIds.size());
+    ids.reserve(pathsAndIds.size());
+    for (const auto &[p, id] : pathsAndIds)
+    {
+        SampleID::guaranteeNextAbove(id);
+        paths.push_back(p);
+        ids.push_back(id);
+    }
+    return loadSamplesInParallel(paths, ids, progress);
+}
+
+std::vector<std::optional<SampleID>>
+SampleManager::loadSamplesInParallel(const std::vector<fs::path> &paths,
+                                     const std::vector<std::optional<SampleID>> &ids,
+                                     const loadProgressCallback_t &progress)
+{
+    assert(threadingChecker.isSerialThread());
+    assert(paths.size() == ids.size());
+
+    std::vector<std::optional<SampleID>> res(paths.size());
+
+    struct Job
+    {
+        fs::path path;
+        SampleID id;
+        std::shared_ptr<Sample> sample;
+        bool loaded{false};
+    };
+    std::vector<Job> jobs;
+    std::vector<int> jobForRequest(paths.size(), -1);
+    std::unordered_map<std::string, size_t> jobByPath;
+
+    for (auto i = 0U; i < paths.size(); ++i)
+    {
+        auto already = findSampleByPath(paths[i]);
+        if (already.has_value())
+        {
+            res[i] = already;
+            continue;
+        }
+
+        auto key = paths[i].u8string();
+        auto jp = jobByPath.find(key);
+        if (jp != jobByPath.end())
+        {
+            jobForRequest[i] = jp->second;
+            continue;
+        }
+
+        auto id = ids[i].has_value() ? *ids[i] : SampleID::next();
+        auto shared = acquireShared({Sample::WAV_FILE, paths[i]}, mapWavSamples,
+                                    [this, &p = paths[i]]() { return md5ForFile(p); });
+        if (shared)
+        {
+            samples[id] = shared;
+            samplesByPath[key] = id;
+            res[i] = id;
+            continue;
+        }
+
+        auto sp = std::make_shared<Sample>(id);
+        sp->packI24 = packI24Samples;
+        sp->mapWavData = mapWavSamples;
+        if (diskStreamer)
+        {
+            sp->diskStreamHeadFrames = diskStreamHeadFrames;
+        }
+
+        jobByPath[key] = jobs.size();
+        jobForRequest[i] = jobs.size();
+        jobs.push_back({paths[i], id, sp, false});
+    }
+
+    if (!jobs.empty())
+    {
+        auto hw = std::max(1U, std::thread::hardware_concurrency());
+        auto nThreads = std::min({jobs.size(), maxLoadThreads, (size_t)hw});
+        SCLOG("Loading " << jobs.size() << " samples on " << nThreads << " threads");
+
+        std::atomic<size_t> nextJob{0}, jobsDone{0};
+        auto work = [&](bool isCaller) {
+            size_t j;
+            while ((j = nextJob.fetch_add(1)) < jobs.size())
+            {
+                auto &job = jobs[j];
+                try
+                {
+                    job.loaded = loadSampleWithMD5(*job.sample, job.path);
+                }
+                catch (const std::exception &e)
+                {
+                    SCLOG("Exception loading '" << job.path.u8string() << "' : " << e.what());
+                    job.loaded = false;
+                }
+                auto done = ++jobsDone;
+                if (isCaller && progress)
+                {
+                    progress(done, jobs.size());
+                }
+            }
+        };
+
+        std::vector<std::thread> workers;
+        for (auto t = 1U; t < nThreads; ++t)
+        {
+            workers.emplace_back(work, false);
+        }
+        work(true);
+        for (auto &w : workers)
+        {
+            w.join();
+        }
+        if (progress)
+        {
+            progress(jobs.size(), jobs.size());
+        }
+    }
+
+    for (auto &job : jobs)
+    {
+        if (!job.loaded)
+        {
+            SCLOG("Failed to load sample from '" << job.path.u8string() << "'");
+            continue;
+        }
+        if (job.sample->isDiskStreamed)
+        {
+            job.sample->diskStreamer = diskStreamer.get();
+        }
+        job.sample = publishShared(job.sample);
+        samples[job.id] = job.sample;
+        samplesByPath[job.path.u8string()] = job.id;
+    }
+
+    for (auto i = 0U; i < paths.size(); ++i)
+    {
+        auto j = jobForRequest[i];
+        if (j >= 0 && jobs[j].loaded)
+        {
+            res[i] = jobs[j].id;
+        }
+    }
+
+    updateSampleMemory();
+    return res;
 }
 
 std::optional<SampleID> SampleManager::loadSampleFromSF2(const fs::path &p, sf2::File *f,
@@ -134,8 +533,7 @@ std::optional<SampleID> SampleManager::loadSampleFromSF2ToID(const fs::path &p,
 
                 auto riff = std::make_unique<RIFF::File>(p.u8string());
                 auto sf = std::make_unique<sf2::File>(riff.get());
-                sf2FilesByPath[p.u8string()] = {std::move(riff), std::move(sf),
-                                                infrastructure::createMD5SumFromFile(p)};
+                sf2FilesByPath[p.u8string()] = {std::move(riff), std::move(sf), md5ForFile(p)};
             }
             catch (RIFF::Exception e)
             {
@@ -156,16 +554,26 @@ std::optional<SampleID> SampleManager::loadSampleFromSF2ToID(const fs::path &p,
         }
     }
 
+    auto shared = acquireShared({Sample::SF2_FILE, p, {}, preset, instrument, region}, false,
+                                [this, &p]() { return std::get<2>(sf2FilesByPath[p.u8string()]); });
+    if (shared)
+    {
+        samples[sid] = shared;
+        updateSampleMemory();
+        return sid;
+    }
+
     auto sp = std::make_shared<Sample>(sid);
+    sp->packI24 = packI24Samples;
 
     if (!sp->loadFromSF2(p, f, preset, instrument, region))
         return {};
 
     sp->md5Sum = std::get<2>(sf2FilesByPath[p.u8string()]);
 
-    samples[sp->id] = sp;
+    samples[sid] = publishShared(sp);
     updateSampleMemory();
-    return sp->id;
+    return sid;
 }
 
 std::optional<SampleID> SampleManager::setupSampleFromMultifile(const fs::path &p, int idx,
@@ -173,6 +581,7 @@ std::optional<SampleID> SampleManager::setupSampleFromMultifile(const fs::path &
 {
     auto sid = SampleID::next();
     auto sp = std::make_shared<Sample>(sid);
+    sp->packI24 = packI24Samples;
 
     sp->parse_riff_wave(data, dataSize);
     sp->type = Sample::MULTISAMPLE_FILE;
@@ -195,6 +604,7 @@ std::optional<SampleID> SampleManager::loadSampleFromMultiSample(const fs::path
         return std::nullopt;
 
     auto sp = std::make_shared<Sample>(id);
+    sp->packI24 = packI24Samples;
 
     size_t ssize;
     auto data = mz_zip_reader_extract_to_heap(&za->zip_archive, idx, &ssize, 0);
@@ -217,11 +627,23 @@ void SampleManager::purgeUnreferencedSamples()
     auto b = samples.begin();
     while (b != samples.end())
     {
+        /*
+         * Each manager using a shared sample holds a reference, so a count no higher than
+         * that means no zone anywhere uses it. We can't tell our zones from another
+         * engine's, so a shared sample only we stopped using stays until they stop too.
+         */
         auto ct = b->second.use_count();
-        if (ct <= 1)
+        auto held = std::max(1, SharedSampleStore::get().usersOf(b->second.get()));
+        if (ct <= held)
         {
             SCLOG("Purging sample " << b->first.to_string() << " from "
                                     << b->second->mFileName.u8string())
+            auto pp = samplesByPath.find(b->second->getPath().u8string());
+            if (pp != samplesByPath.end() && pp->second == b->first)
+            {
+                samplesByPath.erase(pp);
+            }
+            releaseShared(b->second);
             b = samples.erase(b);
         }
         else
@@ -237,13 +659,210 @@ void SampleManager::purgeUnreferencedSamples()
     updateSampleMemory();
 }
 
+void SampleManager::setMemoryBudget(uint64_t bytes)
+{
+    if (bytes > 0 && !diskStreamer)
+    {
+        SCLOG("Sample memory budget needs disk streaming; ignoring it");
+        return;
+    }
+    memoryBudget = bytes;
+    if (memoryBudget > 0 && !residencyWorker)
+    {
+        SCLOG("Keeping sample memory within " << (memoryBudget >> 20) << "MB");
+        residencyWorker = std::make_unique<ResidencyWorker>();
+    }
+}
+
+void SampleManager::noteSampleStarted(Sample *s)
+{
+    s->residencyStamp.store(++residencyClock, std::memory_order_relaxed);
+    if (!s->isEvicted)
+    {
+        residencyStats.hits++;
+        return;
+    }
+
+    residencyStats.misses++;
+    if (!s->reloadRequested.load(std::memory_order_relaxed))
+    {
+        s->reloadRequestedAt.store(std::chrono::steady_clock::now().time_since_epoch().count(),
+                                   std::memory_order_relaxed);
+        s->reloadRequested.store(true, std::memory_order_release);
+    }
+}
+
+bool SampleManager::isEvictable(const Sample &s) const
+{
+    // The worker reloads by path and only WAV files stream. Another engine could be
+    // playing a shared sample, and we can only check our own voices, so it has to be
+    // ours alone; our own use counts one in the store.
+    return s.type == Sample::WAV_FILE && !s.isMemoryMapped && !s.isDiskStreamed &&
+           !s.residencyPinned && s.sample_length > 2 * diskStreamHeadFrames &&
+           SharedSampleStore::get().usersOf(&s) <= 1;
+}
+
+std::vector<SampleManager::ResidencyChange> SampleManager::updateResidency()
+{
+    assert(threadingChecker.isSerialThread());
+    std::vector<ResidencyChange> res;
+    if (!residencyWorker)
+        return res;
+
+    auto now = std::chrono::steady_clock::now();
+    retiredResidentData.erase(
+        std::remove_if(retiredResidentData.begin(), retiredResidentData.end(),
+                       [now](const auto &r) { return now - r.first > residencyRetireGrace; }),
+        retiredResidentData.end());
+
+    for (auto &job : residencyWorker->takeDone())
+    {
+        if (!job.replacement)
+        {
+            // The file changed or won't stream, so leave this sample as it is from now on
+            SCLOG("Unable to " << (job.toFullyResident ? "reload " : "evict ")
+                               << job.sample->getPath().u8string());
+            job.sample->residencyPending = false;
+            job.sample->residencyPinned = true;
+            residencyStats.failures++;
+            continue;
+        }
+        res.push_back({job.sample.get(), job.replacement.get(), job.toFullyResident});
+        inFlightResidency.push_back(
+            {std::move(job.sample), std::move(job.replacement), job.toFullyResident});
+    }
+
+    if (now - lastResidencyScan < residencyScanInterval)
+        return res;
+    lastResidencyScan = now;
+
+    int64_t projected = sampleMemoryInBytes;
+    std::vector<std::shared_ptr<Sample>> candidates;
+    for (const auto &[id, smp] : samples)
+    {
+        if (smp->residencyPending || smp->residencyPinned)
+            continue;
+
+        if (smp->isEvicted)
+        {
+            // A voice is waiting on each of these so they go ahead whatever the budget
+            if (smp->reloadRequested.load(std::memory_order_acquire))
+            {
+                smp->residencyPending = true;
+                projected += smp->getDataSize() - smp->getResidentDataSize();
+                residencyWorker->push({smp, nullptr, true});
+            }
+        }
+        else if (isEvictable(*smp))
+        {
+            candidates.push_back(smp);
+        }
+    }
+
+    if (projected <= (int64_t)memoryBudget)
+        return res;
+
+    std::sort(candidates.begin(), candidates.end(), [](const auto &a, const auto &b) {
+        return a->residencyStamp.load(std::memory_order_relaxed) <
+               b->residencyStamp.load(std::memory_order_relaxed);
+    });
+    for (auto &c : candidates)
+    {
+        if (projected <= (int64_t)memoryBudget)
+            break;
+        // Another engine may have acquired it since we looked
+        if (useSharedSampleStore && !SharedSampleStore::get().tryMarkEvicting(c.get()))
+            continue;
+        c->residencyPending = true;
+        projected -= c->getResidentDataSize() -
+                     (int64_t)diskStreamHeadFrames * Sample::bitDepthByteSize(c->bitDepth) *
+                         c->channels;
+        residencyWorker->push({c, nullptr, false});
+    }
+    return res;
+}
+
+void SampleManager::residencyChangeDone(const ResidencyChange &c)
+{
+    assert(threadingChecker.isSerialThread());
+    auto it = std::find_if(inFlightResidency.begin(), inFlightResidency.end(), [&c](auto &f) {
+        return f.sample.get() == c.sample && f.replacement.get() == c.replacement;
+    });
+    if (it == inFlightResidency.end())
+        return;
+
+    auto &smp = *it->sample;
+    smp.residencyPending = false;
+    auto now = std::chrono::steady_clock::now();
+    if (c.toFullyResident)
+    {
+        auto at = std::chrono::steady_clock::time_point(
+            std::chrono::steady_clock::duration(smp.reloadRequestedAt.load()));
+        uint64_t us = std::chrono::duration_cast<std::chrono::microseconds>(now - at).count();
+        smp.reloadRequested = false;
+        residencyStats.reloads++;
+        residencyStats.reloadLatencyTotalUs += us;
+        if (us > residencyStats.reloadLatencyMaxUs)
+            residencyStats.reloadLatencyMaxUs = us;
+        SCLOG("Reloaded " << smp.getPath().u8string() << " in " << us / 1000 << "ms");
+    }
+    else if (smp.isEvicted)
+    {
+        residencyStats.evictions++;
+        SCLOG("Evicted " << smp.getPath().u8string());
+    }
+    // otherwise a voice was playing it so we try again next scan
+
+    retiredResidentData.emplace_back(now, std::move(it->replacement));
+    inFlightResidency.erase(it);
+    updateSampleMemory();
+}
+
 void SampleManager::updateSampleMemory()
 {
-    uint64_t res = 0;
+    uint64_t res = 0, mapped = 0, shared = 0;
     for (const auto &[id, smp] : samples)
     {
-        res += smp->sample_length * smp->channels * (smp->bitDepth == Sample::BD_I16 ? 4 : 8);
+        // What each sample actually holds in memory, at its resident bit depth
+        res += smp->getResidentDataSize();
+        mapped += smp->getMappedDataSize();
+        if (useSharedSampleStore && SharedSampleStore::get().usersOf(smp.get()) > 1)
+            shared += smp->getResidentDataSize();
     }
     sampleMemoryInBytes = res;
+    mappedSampleMemoryInBytes = mapped;
+    sharedSampleMemoryInBytes = shared;
+}
+
+std::shared_ptr<Sample> SampleManager::acquireShared(const Sample::SampleFileAddress &a,
+                                                     bool mapWavData,
+                                                     const std::function<std::string()> &md5)
+{
+    if (!useSharedSampleStore)
+        return {};
+
+    auto &store = SharedSampleStore::get();
+    auto s = store.find(a, packI24Samples, mapWavData);
+    if (!s)
+        return {};
+
+    // The md5 is only worked out once we have a candidate, and outside the store lock
+    auto sum = md5();
+    if (sum.empty() || s->getMD5Sum() != sum || !store.acquire(s))
+        return {};
+    return s;
+}
+
+std::shared_ptr<Sample> SampleManager::publishShared(const std::shared_ptr<Sample> &s)
+{
+    if (!useSharedSampleStore || s->isDiskStreamed || s->getMD5Sum().empty())
+        return s;
+    return SharedSampleStore::get().publish(s);
+}
+
+void SampleManager::releaseShared(const std::shared_ptr<Sample> &s)
+{
+    if (useSharedSampleStore)
+        SharedSampleStore::get().release(s.get());
 }
 } // namespace scxt::sample
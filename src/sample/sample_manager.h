@@ -30,10 +30,15 @@
 
 #include "utils.h"
 #include "sample.h"
+#include "disk_streamer.h"
+#include "decoded_sample_cache.h"
 
 #include "infrastructure/filesystem_import.h"
 
 #include <filesystem>
+#include <chrono>
+#include <cstdint>
+#include <functional>
 #include <unordered_map>
 #include <optional>
 #include <vector>
@@ -73,7 +78,7 @@ struct ZipArchiveHolder : scxt::MoveableOnly<ZipArchiveHolder>
 struct SampleManager : MoveableOnly<SampleManager>
 {
     const ThreadingChecker &threadingChecker;
-    SampleManager(const ThreadingChecker &t) : threadingChecker(t) {}
+    SampleManager(const ThreadingChecker &t);
     ~SampleManager();
 
     std::optional<SampleID> loadSampleByFileAddress(const Sample::SampleFileAddress &);
@@ -83,6 +88,34 @@ struct SampleManager : MoveableOnly<SampleManager>
     std::optional<SampleID> loadSampleByPath(const fs::path &);
     std::optional<SampleID> loadSampleByPathToID(const fs::path &, const SampleID &id);
 
+    /*
+     * Batch loading for importers. Each file decodes on a small pool of threads and the
+     * results are registered here on the calling (serialization) thread once all are
+     * done, so the loaded set is the same as loading one at a time. Paths which are
+     * already loaded, or repeat within the batch, resolve to the same ID. The result is
+     * parallel to the input. progress is called on the calling thread as files finish.
+     */
+    using loadProgressCallback_t = std::function<void(size_t /* done */, size_t /* total */)>;
+    std::vector<std::optional<SampleID>>
+    loadSamplesByPath(const std::vector<fs::path> &,
+                      const loadProgressCallback_t &progress = nullptr);
+    std::vector<std::optional<SampleID>>
+    loadSamplesByPathToIDs(const std::vector<std::pair<fs::path, SampleID>> &,
+                           const loadProgressCallback_t &progress = nullptr);
+    static constexpr size_t maxLoadThreads{8};
+
+    /*
+     * The md5 of a file, from the persistent cache if we have seen this path with
+     * this size and modification time, otherwise hashed (and stored). The engine
+     * points the cache hooks at the browser database; both may be called from
+     * loader threads.
+     */
+    std::string md5ForFile(const fs::path &);
+    std::function<std::optional<std::string>(const fs::path &, uint64_t, int64_t)>
+        md5CacheLookup{nullptr};
+    std::function<void(const fs::path &, uint64_t, int64_t, const std::string &)> md5CacheStore{
+        nullptr};
+
     std::optional<SampleID> loadSampleFromSF2(const fs::path &,
                                               sf2::File *f, // if this is null I will re-open it
                                               int preset, int instrument, int region);
@@ -120,8 +153,14 @@ struct SampleManager : MoveableOnly<SampleManager>
 
     void reset()
     {
+        for (const auto &[id, smp] : samples)
+        {
+            releaseShared(smp);
+        }
         samples.clear();
+        samplesByPath.clear();
         sf2FilesByPath.clear();
+        retiredResidentData.clear();
         streamingVersion = 0x2112'01'01;
         updateSampleMemory();
     }
@@ -132,11 +171,129 @@ struct SampleManager : MoveableOnly<SampleManager>
     uint64_t streamingVersion{0x2112'01'01}; // see comment in patch.h
 
     std::atomic<uint64_t> sampleMemoryInBytes{0};
+    // Sample data played straight from memory mapped files, which the OS page cache holds
+    std::atomic<uint64_t> mappedSampleMemoryInBytes{0};
+    // The part of sampleMemoryInBytes which other engines in the process also use
+    std::atomic<uint64_t> sharedSampleMemoryInBytes{0};
+
+    /*
+     * Disk streaming. Once enabled, long uncompressed samples loaded by path keep only
+     * their head (and loop) resident and voices stream the rest. Enable this before
+     * audio starts; it cannot be turned off since streamed samples depend on it.
+     */
+    static constexpr uint32_t diskStreamHeadFrames{1 << 16};
+    void enableDiskStreaming();
+    bool isDiskStreamingEnabled() const { return diskStreamer != nullptr; }
+    const std::unique_ptr<DiskStreamer> &getDiskStreamer() const { return diskStreamer; }
+
+    /*
+     * If set, samples we load from here on keep 24 bit PCM packed in memory (see
+     * Sample::packI24) rather than promoting it to float. Samples already loaded
+     * keep whatever format they have.
+     */
+    bool packI24Samples{false};
+
+    /*
+     * If set, suitable WAV files we load by path from here on play straight from a
+     * memory mapping of the file (see Sample::mapWavData) rather than being copied in.
+     */
+    bool mapWavSamples{false};
+
+    /*
+     * If set, samples we load by path or from SF2 from here on come from and go into the
+     * process wide SharedSampleStore, so other engines loading the same file with the same
+     * options use one copy. Set this before loading; we release what we took on purge and
+     * reset. Disk streamed and multisample samples stay private.
+     */
+    bool useSharedSampleStore{false};
+
+    /*
+     * If enabled, FLAC and MP3 files we load by path from here on decode once into the
+     * DecodedSampleCache in dir and later loads map the decoded data from there.
+     */
+    void enableDecodedSampleCache(const fs::path &dir, uint64_t maxBytes);
+    const std::unique_ptr<DecodedSampleCache> &getDecodedSampleCache() const
+    {
+        return decodedSampleCache;
+    }
+
+    /*
+     * Memory budget. With a budget set (which needs disk streaming) we keep sample memory
+     * under it by evicting the least recently started fully resident WAV samples down to
+     * a disk streamed head. A voice starting on an evicted sample plays the head and
+     * streams the rest while we reload the sample in full on a worker thread. Memory
+     * mapped samples and samples another engine shares are never evicted; one in the
+     * SharedSampleStore which only we use leaves the store as we evict it.
+     *
+     * The serialization thread calls updateResidency each time round its loop and the
+     * engine swaps the changes it returns into the samples on the audio thread, then
+     * calls residencyChangeDone. The audio thread itself only calls noteSampleStarted.
+     */
+    void setMemoryBudget(uint64_t bytes);
+    uint64_t getMemoryBudget() const { return memoryBudget; }
+
+    void noteSampleStarted(Sample *);
+
+    struct ResidencyChange
+    {
+        Sample *sample{nullptr};
+        // The data to swap in, which holds the swapped out data afterwards
+        Sample *replacement{nullptr};
+        bool toFullyResident{false};
+    };
+    std::vector<ResidencyChange> updateResidency();
+    void residencyChangeDone(const ResidencyChange &);
+
+    struct ResidencyStats
+    {
+        // Voice starts on resident and on evicted samples
+        std::atomic<uint64_t> hits{0}, misses{0};
+        std::atomic<uint64_t> evictions{0}, reloads{0}, failures{0};
+        // From the voice start which asked for a reload to the swap
+        std::atomic<uint64_t> reloadLatencyTotalUs{0}, reloadLatencyMaxUs{0};
+    } residencyStats;
+
+    static constexpr std::chrono::milliseconds residencyScanInterval{250};
+    // How long swapped out data outlives the swap, since a UI redraw may still be reading it
+    static constexpr std::chrono::seconds residencyRetireGrace{2};
 
   private:
     void updateSampleMemory();
 
+    std::shared_ptr<Sample> acquireShared(const Sample::SampleFileAddress &, bool mapWavData,
+                                          const std::function<std::string()> &md5);
+    std::shared_ptr<Sample> publishShared(const std::shared_ptr<Sample> &);
+    void releaseShared(const std::shared_ptr<Sample> &);
+
+    std::optional<SampleID> findSampleByPath(const fs::path &) const;
+    bool loadSampleWithMD5(Sample &, const fs::path &);
+    bool fileCacheKey(const fs::path &, uint64_t &size, int64_t &mtime) const;
+    std::vector<std::optional<SampleID>>
+    loadSamplesInParallel(const std::vector<fs::path> &,
+                          const std::vector<std::optional<SampleID>> &ids,
+                          const loadProgressCallback_t &progress);
+
+    std::unique_ptr<DiskStreamer> diskStreamer;
+    std::unique_ptr<DecodedSampleCache> decodedSampleCache;
+
+    bool isEvictable(const Sample &) const;
+    uint64_t memoryBudget{0};
+    std::atomic<uint64_t> residencyClock{0};
+    std::chrono::steady_clock::time_point lastResidencyScan{};
+    struct ResidencyWorker;
+    std::unique_ptr<ResidencyWorker> residencyWorker;
+    struct InFlightResidencyChange
+    {
+        std::shared_ptr<Sample> sample, replacement;
+        bool toFullyResident{false};
+    };
+    std::vector<InFlightResidencyChange> inFlightResidency;
+    std::vector<std::pair<std::chrono::steady_clock::time_point, std::shared_ptr<Sample>>>
+        retiredResidentData;
+
     std::unordered_map<SampleID, std::shared_ptr<Sample>> samples;
+    // Samples loaded by path (wav, flac, etc...) keyed by path, so repeat loads don't scan
+    std::unordered_map<std::string, SampleID> samplesByPath;
     std::unordered_map<std::string, std::tuple<std::unique_ptr<RIFF::File>,
                                                std::unique_ptr<sf2::File>, std::string>>
         sf2FilesByPath; // last is the md5sum
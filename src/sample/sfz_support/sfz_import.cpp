@@ -63,6 +63,98 @@ int parseMidiNote(const std::string &s)
     return std::atol(s.c_str());
 }
 
+fs::path regionSampleFile(const SFZParser::opCodes_t &groupOpcodes,
+                          const SFZParser::opCodes_t &regionOpcodes)
+{
+    std::string sampleFileString = "<-->";
+    for (auto &oc : groupOpcodes)
+    {
+        if (oc.name == "sample")
+        {
+            sampleFileString = oc.value;
+        }
+    }
+    for (auto &oc : regionOpcodes)
+    {
+        if (oc.name == "sample")
+        {
+            sampleFileString = oc.value;
+        }
+    }
+    // fs always works with / and on windows also works with back. Quotes are
+    // stripped by the parser now
+    std::replace(sampleFileString.begin(), sampleFileString.end(), '\\', '/');
+    return fs::path{sampleFileString};
+}
+
+fs::path controlSampleDir(const SFZParser::opCodes_t &list, const fs::path &rootDir,
+                          const fs::path &current)
+{
+    auto res = current;
+    for (const auto &oc : list)
+    {
+        if (oc.name == "default_path")
+        {
+            auto vv = oc.value;
+            std::replace(vv.begin(), vv.end(), '\\', '/');
+            res = rootDir / vv;
+        }
+    }
+    return res;
+}
+
+/*
+ * Walk the document resolving each region's sample the same way the import pass
+ * does and decode them all at once in parallel. The import pass then finds them
+ * already loaded.
+ */
+void preloadRegionSamples(const SFZParser::document_t &doc, const fs::path &rootDir,
+                          engine::Engine &e)
+{
+    std::vector<fs::path> paths;
+    auto sampleDir = rootDir;
+    SFZParser::opCodes_t currentGroupOpcodes;
+    for (const auto &[r, list] : doc)
+    {
+        switch (r.type)
+        {
+        case SFZParser::Header::group:
+            currentGroupOpcodes = list;
+            break;
+        case SFZParser::Header::control:
+            sampleDir = controlSampleDir(list, rootDir, sampleDir);
+            break;
+        case SFZParser::Header::region:
+        {
+            auto sampleFile = regionSampleFile(currentGroupOpcodes, list);
+            auto samplePath = (sampleDir / sampleFile).lexically_normal();
+            if (fs::exists(samplePath))
+                paths.push_back(samplePath);
+            else if (fs::exists(sampleFile))
+                paths.push_back(sampleFile);
+        }
+        break;
+        default:
+            break;
+        }
+    }
+
+    if (paths.empty())
+        return;
+
+    auto &cont = *e.getMessageController();
+    auto cng = messaging::MessageController::ClientActivityNotificationGuard("Loading SFZ Samples",
+                                                                             cont);
+    e.getSampleManager()->loadSamplesByPath(paths, [&cont](auto done, auto total) {
+        if (done % 16 == 0 || done == total)
+        {
+            cont.updateClientActivityNotification(
+                "Loading SFZ Samples (" + std::to_string(done) + "/" + std::to_string(total) + ")",
+                1);
+        }
+    });
+}
+
 bool importSFZ(const fs::path &f, engine::Engine &e)
 {
     assert(e.getMessageController()->threadingChecker.isSerialThread());
@@ -73,6 +165,8 @@ bool importSFZ(const fs::path &f, engine::Engine &e)
     auto rootDir = f.parent_path();
     auto sampleDir = rootDir;
 
+    preloadRegionSamples(doc, rootDir, e);
+
     auto pt = std::clamp(e.getSelectionManager()->selectedPart, (int16_t)0, (int16_t)numParts);
 
     auto &part = e.getPatch()->getPart(pt);
@@ -116,25 +210,7 @@ bool importSFZ(const fs::path &f, engine::Engine &e)
             auto &group = part->getGroup(groupId);
 
             // Find the sample
-            std::string sampleFileString = "<-->";
-            for (auto &oc : currentGroupOpcodes)
-            {
-                if (oc.name == "sample")
-                {
-                    sampleFileString = oc.value;
-                }
-            }
-            for (auto &oc : list)
-            {
-                if (oc.name == "sample")
-                {
-                    sampleFileString = oc.value;
-                }
-            }
-            // fs always works with / and on windows also works with back. Quotes are
-            // stripped by the parser now
-            std::replace(sampleFileString.begin(), sampleFileString.end(), '\\', '/');
-            auto sampleFile = fs::path{sampleFileString};
+            auto sampleFile = regionSampleFile(currentGroupOpcodes, list);
             auto samplePath = (sampleDir / sampleFile).lexically_normal();
 
             SampleID sid;
@@ -337,15 +413,12 @@ bool importSFZ(const fs::path &f, engine::Engine &e)
         break;
         case SFZParser::Header::control:
         {
+            sampleDir = controlSampleDir(list, rootDir, sampleDir);
             for (const auto &oc : list)
             {
                 if (oc.name == "default_path")
                 {
-                    auto vv = oc.value;
-                    std::replace(vv.begin(), vv.end(), '\\', '/');
-                    sampleDir = rootDir / vv;
                     SCLOG("Control: Resetting sample dir to " << sampleDir);
-                    ;
                 }
                 else
                 {
@@ -0,0 +1,138 @@
+/*
+ * Shortcircuit XT - a Surge Synth Team product
+ *
+ * A fully featured creative sampler, available as a standalone
+ * and plugin for multiple platforms.
+ *
+ * Copyright 2019 - 2024, Various authors, as described in the github
+ * transaction log.
+ *
+ * ShortcircuitXT is released under the Gnu General Public Licence
+ * V3 or later (GPL-3.0-or-later). The license is found in the file
+ * "LICENSE" in the root of this repository or at
+ * https://www.gnu.org/licenses/gpl-3.0.en.html
+ *
+ * Individual sections of code which comprises ShortcircuitXT in this
+ * repository may also be used under an MIT license. Please see the
+ * section  "Licensing" in "README.md" for details.
+ *
+ * ShortcircuitXT is inspired by, and shares code with, the
+ * commercial product Shortcircuit 1 and 2, released by VemberTech
+ * in the mid 2000s. The code for Shortcircuit 2 was opensourced in
+ * 2020 at the outset of this project.
+ *
+ * All source for ShortcircuitXT is available at
+ * https://github.com/surge-synthesizer/shortcircuit-xt
+ */
+
+#include "shared_sample_store.h"
+
+#include <cassert>
+
+namespace scxt::sample
+{
+SharedSampleStore &SharedSampleStore::get()
+{
+    static SharedSampleStore store;
+    return store;
+}
+
+std::string SharedSampleStore::keyFor(const Sample::SampleFileAddress &a, bool packI24,
+                                      bool mapWavData)
+{
+    // The type follows from the path so we don't need it, which lets us look up before loading
+    return fmt::format("{}|{}|{}|{}|{}{}", a.path.u8string(), a.preset, a.instrument, a.region,
+                       packI24 ? "p" : "", mapWavData ? "m" : "");
+}
+
+std::shared_ptr<Sample> SharedSampleStore::find(const Sample::SampleFileAddress &a, bool packI24,
+                                                bool mapWavData) const
+{
+    auto key = keyFor(a, packI24, mapWavData);
+    std::lock_guard<std::mutex> g(mutex);
+    auto e = entries.find(key);
+    if (e == entries.end() || e->second.users <= 0)
+        return {};
+    return e->second.sample.lock();
+}
+
+bool SharedSampleStore::acquire(const std::shared_ptr<Sample> &s)
+{
+    std::lock_guard<std::mutex> g(mutex);
+    auto k = keyBySample.find(s.get());
+    if (k == keyBySample.end())
+        return false;
+    auto e = entries.find(k->second);
+    if (e == entries.end() || e->second.users <= 0)
+        return false;
+    e->second.users++;
+    hits++;
+    return true;
+}
+
+std::shared_ptr<Sample> SharedSampleStore::publish(const std::shared_ptr<Sample> &s)
+{
+    assert(!s->isDiskStreamed);
+    auto key = keyFor(s->getSampleFileAddress(), s->packI24, s->mapWavData);
+
+    std::lock_guard<std::mutex> g(mutex);
+    misses++;
+    auto e = entries.find(key);
+    if (e != entries.end() && e->second.users > 0)
+    {
+        auto theirs = e->second.sample.lock();
+        if (theirs && theirs->getMD5Sum() == s->getMD5Sum())
+        {
+            e->second.users++;
+            return theirs;
+        }
+        // A stale version of the file stays with the managers using it but leaves the store
+        if (theirs)
+            keyBySample.erase(theirs.get());
+    }
+    entries[key] = {s, 1};
+    keyBySample[s.get()] = key;
+    return s;
+}
+
+void SharedSampleStore::release(const Sample *s)
+{
+    std::lock_guard<std::mutex> g(mutex);
+    auto k = keyBySample.find(s);
+    if (k == keyBySample.end())
+        return;
+    auto e = entries.find(k->second);
+    if (e != entries.end() && --e->second.users <= 0)
+    {
+        entries.erase(e);
+        keyBySample.erase(k);
+    }
+}
+
+bool SharedSampleStore::tryMarkEvicting(const Sample *s)
+{
+    std::lock_guard<std::mutex> g(mutex);
+    auto k = keyBySample.find(s);
+    if (k == keyBySample.end())
+        return true;
+    auto e = entries.find(k->second);
+    if (e != entries.end())
+    {
+        if (e->second.users > 1)
+            return false;
+        entries.erase(e);
+    }
+    keyBySample.erase(k);
+    return true;
+}
+
+int32_t SharedSampleStore::usersOf(const Sample *s) const
+{
+    std::lock_guard<std::mutex> g(mutex);
+    auto k = keyBySample.find(s);
+    if (k == keyBySample.end())
+        return 0;
+    auto e = entries.find(k->second);
+    return e == entries.end() ? 0 : e->second.users;
+}
+} // namespace scxt::sample
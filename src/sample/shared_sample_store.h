@@ -0,0 +1,100 @@
+/*
+ * Shortcircuit XT - a Surge Synth Team product
+ *
+ * A fully featured creative sampler, available as a standalone
+ * and plugin for multiple platforms.
+ *
+ * Copyright 2019 - 2024, Various authors, as described in the github
+ * transaction log.
+ *
+ * ShortcircuitXT is released under the Gnu General Public Licence
+ * V3 or later (GPL-3.0-or-later). The license is found in the file
+ * "LICENSE" in the root of this repository or at
+ * https://www.gnu.org/licenses/gpl-3.0.en.html
+ *
+ * Individual sections of code which comprises ShortcircuitXT in this
+ * repository may also be used under an MIT license. Please see the
+ * section  "Licensing" in "README.md" for details.
+ *
+ * ShortcircuitXT is inspired by, and shares code with, the
+ * commercial product Shortcircuit 1 and 2, released by VemberTech
+ * in the mid 2000s. The code for Shortcircuit 2 was opensourced in
+ * 2020 at the outset of this project.
+ *
+ * All source for ShortcircuitXT is available at
+ * https://github.com/surge-synthesizer/shortcircuit-xt
+ */
+
+#ifndef SCXT_SRC_SAMPLE_SHARED_SAMPLE_STORE_H
+#define SCXT_SRC_SAMPLE_SHARED_SAMPLE_STORE_H
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+#include "utils.h"
+#include "sample.h"
+
+namespace scxt::sample
+{
+/**
+ * The SharedSampleStore lets every SampleManager in the process share decoded samples,
+ * so ten instances of the same piano in a project hold it once. Entries are keyed by
+ * the sample file address and the load options which change the in memory form (packed
+ * 24 bit, memory mapped). Each holds a weak reference to the sample and a count of the
+ * sample managers using it.
+ *
+ * A manager finds an entry before decoding and only acquires it if the md5 matches, so
+ * a file changed on disk loads afresh. On a miss it publishes what it decoded, and it
+ * releases its use when it drops the sample. Every call locks, but they are only made
+ * from serialization threads at load and purge time and never hold the lock over I/O.
+ *
+ * Disk streamed samples hold their own engine's streamer so are never shared.
+ */
+struct SharedSampleStore : MoveableOnly<SharedSampleStore>
+{
+    static SharedSampleStore &get();
+
+    // The live sample for this address and these options, if any. This doesn't count as a use.
+    std::shared_ptr<Sample> find(const Sample::SampleFileAddress &, bool packI24,
+                                 bool mapWavData) const;
+    // Count a use of a sample we found; false if it has left the store meanwhile
+    bool acquire(const std::shared_ptr<Sample> &);
+    /*
+     * Offer a freshly decoded sample with one use. If another manager published the same
+     * address meanwhile we acquire and return theirs instead, and the caller should
+     * drop its own copy.
+     */
+    std::shared_ptr<Sample> publish(const std::shared_ptr<Sample> &);
+    void release(const Sample *);
+
+    // How many sample managers use this sample; 0 if it isn't in the store
+    int32_t usersOf(const Sample *) const;
+
+    /*
+     * Before a manager evicts a sample it takes it out of the store, so no other engine
+     * can acquire it part way through. False, leaving it in place, if another manager
+     * uses it too. A sample which isn't in the store is the caller's alone anyway.
+     */
+    bool tryMarkEvicting(const Sample *);
+
+    std::atomic<uint64_t> hits{0}, misses{0};
+
+  private:
+    static std::string keyFor(const Sample::SampleFileAddress &, bool packI24, bool mapWavData);
+
+    struct Entry
+    {
+        std::weak_ptr<Sample> sample;
+        int32_t users{0};
+    };
+    mutable std::mutex mutex;
+    std::unordered_map<std::string, Entry> entries;
+    std::unordered_map<const Sample *, std::string> keyBySample;
+};
+} // namespace scxt::sample
+
+#endif // SCXT_SRC_SAMPLE_SHARED_SAMPLE_STORE_H
@@ -55,6 +55,7 @@ Voice::~Voice()
         SCLOG("WARNING: Destroying assigned voice. (OK in shutdown)");
     }
 #endif
+    releaseDiskStream();
     for (auto i = 0; i < engine::processorCount; ++i)
     {
         dsp::processor::unspawnProcessor(processors[i]);
@@ -69,6 +70,9 @@ void Voice::cleanupVoice()
     isVoiceAssigned = false;
     engine->voiceManagerResponder.doVoiceEndCallback(this);
     engine->activeVoices--;
+    engine->onVoiceCleanedUp(this);
+
+    releaseDiskStream();
 
     // We cleanup processors here since they may have, say,
     // memory pool resources checked out that others could
@@ -94,9 +98,21 @@ void Voice::voiceStarted()
     }
 
     startBeat = engine->transport.timeInBeats;
-    updateTransportPhasors();
+    double mul = 1 << ((numTransportPhasors - 1) / 2);
+    for (int i = 0; i < numTransportPhasors; ++i)
+    {
+        double rawBeat;
+        transportPhasorStart[i] = (float)std::modf(startBeat * mul, &rawBeat);
+        mul = mul / 2;
+    }
+    usesTransportPhasors = false;
+    for (const auto &vp : endpoints->sources.transportSources.voicePhasors)
+        usesTransportPhasors = usesTransportPhasors || zone->routingPlan.usesSource(vp);
+    // By definition we start at phase 0, whatever block the engine phasors are from
+    std::fill(std::begin(transportPhasors), std::end(transportPhasors), 0.f);
 
     // This order matters
+    modMatrix.routingPlan = &zone->routingPlan;
     endpoints->sources.bind(modMatrix, *zone, *this);
     modMatrix.prepare(zone->routingTable);
     endpoints->bindTargetBaseValues(modMatrix, *zone);
@@ -118,7 +134,7 @@ void Voice::voiceStarted()
             stepLfos[i].setSampleRate(sampleRate, sampleRateInv);
 
             stepLfos[i].assign(&zone->modulatorStorage[i], endpoints->lfo[i].rateP,
-                               &engine->transport, engine->rng);
+                               &engine->transport, zone->parentGroup->parentPart->rng);
         }
         else if (lfoEvaluator[i] == CURVE)
         {
@@ -146,7 +162,9 @@ void Voice::voiceStarted()
         aegOS.attackFrom(0.0);
     }
 
+    voiceStartOrder = engine->voiceStartCounter++;
     zone->addVoice(this);
+    engine->addVoiceToKeyIndex(this);
 }
 
 bool Voice::process()
@@ -164,6 +182,7 @@ template <bool OS> bool Voice::processWithOS()
     if (!isVoicePlaying || !isVoiceAssigned || !zone)
     {
         memset(output, 0, sizeof(output));
+        memset(outputStage.gain, 0, sizeof(outputStage.gain));
         return true;
     }
 
@@ -238,7 +257,8 @@ template <bool OS> bool Voice::processWithOS()
         eg2.processBlock(*eg2p.aP, *eg2p.hP, *eg2p.dP, *eg2p.sP, *eg2p.rP, *eg2p.asP, *eg2p.dsP,
                          *eg2p.rsP, envGate);
     }
-    updateTransportPhasors();
+    if (usesTransportPhasors)
+        updateTransportPhasors();
 
     // TODO and probably just want to process the envelopes here
     modMatrix.process();
@@ -263,19 +283,28 @@ template <bool OS> bool Voice::processWithOS()
         GD.playbackInvertedBounds =
             1.f / std::max(1, GD.playbackUpperBound - GD.playbackLowerBound);
     }
+    bool generated{false};
     if (!GD.isFinished && Generator)
     {
-        Generator(&GD, &GDIO);
+        if (sampleIndex >= 0 && zone->samplePointers[sampleIndex]->isDiskStreamed)
+        {
+            generated = runDiskStreamedGenerator();
+        }
+        else
+        {
+            Generator(&GD, &GDIO);
+            generated = true;
+        }
 
-        if (useOversampling && !OS)
+        if (generated && useOversampling && !OS)
         {
             halfRate.process_block_D2(output[0], output[1], blockSize << 1);
         }
     }
-    else
+    if (!generated)
         memset(output, 0, sizeof(output));
 
-    // TODO Ringout - this is obvioulsy wrong
+    // Processor tails past the end of the sample are handled by updateSilenceDetection
     if (GD.isFinished)
     {
         isGeneratorRunning = false;
@@ -411,17 +440,13 @@ template <bool OS> bool Voice::processWithOS()
             break;
         }
     }
-    /*
-     * Implement output pan
-     */
-    auto pvo = *endpoints->outputTarget.panP;
-    if (pvo != 0.f)
-    {
-        outputPan.set_target(pvo);
-        panOutputsBy(chainIsMono, outputPan);
-        chainIsMono = false;
-    }
 
+    if (engine->voiceSilenceEnergy > 0.f && (!isGated || !isGeneratorRunning))
+        updateSilenceDetection<OS>(chainIsMono);
+    else
+        silentSamples = 0;
+
+    auto pvo = *endpoints->outputTarget.panP;
     auto pao = *endpoints->outputTarget.ampP;
 
     auto velFac = zone->parentGroup->outputInfo.velocitySensitivity;
@@ -431,6 +456,27 @@ template <bool OS> bool Voice::processWithOS()
 
     pao *= velKeyFade;
 
+    if (deferOutputStage)
+    {
+        prepareOutputStage<OS>(chainIsMono, pvo, pao * pao * pao);
+        if (isBeingStolen)
+            applyStealFade<OS>(outputStage.gain, nullptr);
+        if (startOffset > 0)
+            applyStartOffset<OS>();
+        isVoicePlaying = isStillSounding();
+        return true;
+    }
+
+    /*
+     * Implement output pan
+     */
+    if (pvo != 0.f)
+    {
+        outputPan.set_target(pvo);
+        panOutputsBy(chainIsMono, outputPan);
+        chainIsMono = false;
+    }
+
     if constexpr (OS)
     {
         outputAmpOS.set_target(pao * pao * pao);
@@ -483,10 +529,16 @@ template <bool OS> bool Voice::processWithOS()
         }
     }
 
+    if (isBeingStolen)
+        applyStealFade<OS>(output[0], output[1]);
+
+    if (startOffset > 0)
+        applyStartOffset<OS>();
+
     /*
      * Finally do voice state update
      */
-    if (isAEGRunning)
+    if (isStillSounding())
         isVoicePlaying = true;
     else
         isVoicePlaying = false;
@@ -494,6 +546,164 @@ template <bool OS> bool Voice::processWithOS()
     return true;
 }
 
+template <bool OS> void Voice::applyStartOffset()
+{
+    constexpr int n = blockSize << (OS ? 1 : 0);
+    const int d = startOffset << (OS ? 1 : 0);
+    float tail alignas(16)[blockSize << 1];
+
+    auto shift = [&](float *buf, float *carry) {
+        memcpy(tail, buf + n - d, d * sizeof(float));
+        memmove(buf + d, buf, (n - d) * sizeof(float));
+        memcpy(buf, carry, d * sizeof(float));
+        memcpy(carry, tail, d * sizeof(float));
+    };
+    shift(output[0], startCarry[0]);
+    shift(output[1], startCarry[1]);
+    // The deferred output stage applies its gain line per sample, so it moves with us
+    if (deferOutputStage)
+        shift(outputStage.gain, startCarryGain);
+}
+
+template <bool OS> float Voice::chainEnergy(bool chainIsMono) const
+{
+    constexpr int n{blockSize << (OS ? 1 : 0)};
+    float e{0.f};
+    for (int i = 0; i < n; ++i)
+        e += output[0][i] * output[0][i];
+    if (!chainIsMono)
+    {
+        for (int i = 0; i < n; ++i)
+            e += output[1][i] * output[1][i];
+        e *= 0.5f;
+    }
+    return e / n;
+}
+
+template <bool OS> void Voice::updateSilenceDetection(bool chainIsMono)
+{
+    // The AEG scales the chain later, so a loud chain under a closed envelope is still quiet
+    auto ae = std::max(aeg.outputCache[0], aeg.outputCache[blockSize - 1]);
+    auto e = ae * ae;
+
+    // While the generator plays, a quiet chain may just be a lead-in or a gap in the sample
+    // with more to come, so then only the envelope itself closing counts as silence
+    if (!isGeneratorRunning)
+    {
+        e *= chainEnergy<OS>(chainIsMono);
+    }
+
+    if (e >= engine->voiceSilenceEnergy)
+    {
+        silentSamples = 0;
+        return;
+    }
+
+    // Stay silent for at least the longest processor tail so delays and reverbs ring out
+    auto hold = (int32_t)(sampleRate * engine::Engine::voiceSilenceMinHoldSeconds);
+    for (auto p : processors)
+    {
+        if (!p)
+            continue;
+        auto tl = p->tail_length();
+        if (tl < 0)
+        {
+            silentSamples = 0;
+            return;
+        }
+        hold = std::max(hold, (int32_t)tl);
+    }
+
+    silentSamples += blockSize;
+    if (silentSamples >= hold)
+        isRetiredBySilence = true;
+}
+
+void Voice::beginStealFade(float fadeSeconds)
+{
+    isBeingStolen = true;
+    isGated = false;
+    stealFadeLevel = 1.f;
+    stealFadeDelta = std::min(1.f, blockSize * sampleRateInv / std::max(fadeSeconds, 1e-4f));
+    stealFade.set_target_instant(1.f);
+    stealFadeOS.set_target_instant(1.f);
+}
+
+template <bool OS> void Voice::applyStealFade(float *L, float *R)
+{
+    // A linear ramp to zero, one block at a time, so the voice doesn't click off
+    stealFadeLevel = std::max(stealFadeLevel - stealFadeDelta, 0.f);
+    if constexpr (OS)
+    {
+        stealFadeOS.set_target(stealFadeLevel);
+        if (R)
+            stealFadeOS.multiply_2_blocks(L, R);
+        else
+            stealFadeOS.multiply_block(L);
+    }
+    else
+    {
+        stealFade.set_target(stealFadeLevel);
+        if (R)
+            stealFade.multiply_2_blocks(L, R);
+        else
+            stealFade.multiply_block(L);
+    }
+}
+
+template <bool OS>
+void Voice::prepareOutputStage(bool chainIsMono, float panTarget, float ampTarget)
+{
+    namespace mech = sst::basic_blocks::mechanics;
+    namespace pl = sst::basic_blocks::dsp::pan_laws;
+
+    auto &st = outputStage;
+    st.chainIsMono = chainIsMono;
+
+    // Same laws as panOutputsBy, just handed to the zone rather than applied here
+    pl::panmatrix_t pmat{1, 1, 0, 0};
+    if (panTarget != 0.f)
+    {
+        outputPan.set_target(panTarget);
+        auto pv = (std::clamp(panTarget, -1.f, 1.f) + 1) * 0.5;
+        if (chainIsMono)
+            pl::monoEqualPowerUnityGainAtExtrema(pv, pmat);
+        else
+            pl::stereoEqualPower(pv, pmat);
+    }
+    else if (chainIsMono)
+    {
+        // unpanned mono is just copied to both sides
+        pmat[3] = 1;
+    }
+
+    if (chainIsMono)
+    {
+        st.pan[0] = pmat[0];
+        st.pan[1] = 0;
+        st.pan[2] = 0;
+        st.pan[3] = pmat[3];
+    }
+    else
+    {
+        for (int i = 0; i < 4; ++i)
+            st.pan[i] = pmat[i];
+    }
+
+    if constexpr (OS)
+    {
+        mech::copy_from_to<blockSize << 1>(aegOS.outputCache, st.gain);
+        outputAmpOS.set_target(ampTarget);
+        outputAmpOS.multiply_block(st.gain);
+    }
+    else
+    {
+        mech::copy_from_to<blockSize>(aeg.outputCache, st.gain);
+        outputAmp.set_target(ampTarget);
+        outputAmp.multiply_block(st.gain);
+    }
+}
+
 void Voice::panOutputsBy(bool chainIsMono, const lipol &plip)
 {
     namespace pl = sst::basic_blocks::dsp::pan_laws;
@@ -541,24 +751,18 @@ void Voice::initializeGenerator()
     auto &s = zone->samplePointers[sampleIndex];
     auto &variantData = zone->variantData.variants[sampleIndex];
     assert(s);
+    engine->getSampleManager()->noteSampleStarted(s.get());
 
     GDIO.outputL = output[0];
     GDIO.outputR = output[1];
-    if (s->bitDepth == sample::Sample::BD_I16)
-    {
-        GDIO.sampleDataL = s->GetSamplePtrI16(0);
-        GDIO.sampleDataR = s->GetSamplePtrI16(1);
-    }
-    else if (s->bitDepth == sample::Sample::BD_F32)
-    {
-        GDIO.sampleDataL = s->GetSamplePtrF32(0);
-        GDIO.sampleDataR = s->GetSamplePtrF32(1);
-    }
-    else
+    setGeneratorSampleData();
+
+    if (s->isDiskStreamed && s->diskStreamer)
     {
-        assert(false);
+        // If we can't get a stream we will play the resident head and then underrun. The
+        // streamer counts and logs that.
+        diskStream = s->diskStreamer->acquire(s.get());
     }
-    GDIO.waveSize = s->sample_length;
 
     GD.samplePos = variantData.startSample;
     GD.sampleSubPos = 0;
@@ -593,14 +797,283 @@ void Voice::initializeGenerator()
     Generator = nullptr;
 
     monoGenerator = s->channels == 1;
-    Generator = dsp::GetFPtrGeneratorSample(!monoGenerator, s->bitDepth == sample::Sample::BD_F32,
-                                            variantData.loopActive,
+    auto sampleFormat = dsp::GSF_I16;
+    if (s->bitDepth == sample::Sample::BD_F32)
+        sampleFormat = dsp::GSF_F32;
+    else if (s->bitDepth == sample::Sample::BD_I24)
+        sampleFormat = dsp::GSF_I24;
+    Generator = dsp::GetFPtrGeneratorSample(!monoGenerator, sampleFormat, variantData.loopActive,
                                             variantData.loopDirection == engine::Zone::FORWARD_ONLY,
                                             variantData.loopMode == engine::Zone::LOOP_WHILE_GATED);
 
     GD.interpolationType = zone->variantData.interpolationType;
 }
 
+void Voice::setGeneratorSampleData()
+{
+    auto &s = zone->samplePointers[sampleIndex];
+    if (s->bitDepth == sample::Sample::BD_I16)
+    {
+        GDIO.sampleDataL = s->GetSamplePtrI16(0);
+        GDIO.sampleDataR = s->GetSamplePtrI16(1);
+    }
+    else if (s->bitDepth == sample::Sample::BD_F32)
+    {
+        GDIO.sampleDataL = s->GetSamplePtrF32(0);
+        GDIO.sampleDataR = s->GetSamplePtrF32(1);
+    }
+    else if (s->bitDepth == sample::Sample::BD_I24)
+    {
+        GDIO.sampleDataL = s->GetSamplePtrI24(0);
+        GDIO.sampleDataR = s->GetSamplePtrI24(1);
+    }
+    else
+    {
+        assert(false);
+    }
+    GDIO.waveSize = s->sample_length;
+    GDIO.unpadded = s->isMemoryMapped && !s->isFromDecodedCache;
+    GDIO.loopWrapDataL = nullptr;
+    GDIO.loopWrapDataR = nullptr;
+}
+
+void Voice::sampleResidencyChanged()
+{
+    // We were reloaded in full, which holds every frame a stream could give us
+    releaseDiskStream();
+    setGeneratorSampleData();
+}
+
+bool Voice::runDiskStreamedGenerator()
+{
+    // Run the generator over the block in pieces, each from one source
+    auto blockSize = GD.blockSize;
+    auto *outL = GDIO.outputL, *outR = GDIO.outputR;
+    int done{0};
+    while (done < blockSize && !GD.isFinished)
+    {
+        auto frames = updateDiskStreamSource(blockSize - done);
+        if (frames == 0)
+            break;
+
+        GD.blockSize = frames;
+        GDIO.outputL = outL + done;
+        GDIO.outputR = outR + done;
+        Generator(&GD, &GDIO);
+        done += frames;
+    }
+    GD.blockSize = blockSize;
+    GDIO.outputL = outL;
+    GDIO.outputR = outR;
+
+    if (done == 0)
+        return false;
+    for (int i = done; i < blockSize; ++i)
+    {
+        outL[i] = 0.f;
+        outR[i] = 0.f;
+    }
+    return true;
+}
+
+int Voice::updateDiskStreamSource(int frames)
+{
+    using ds_t = sample::DiskStreamer;
+    constexpr int64_t fo = dsp::FIRoffset;
+    constexpr int64_t window = ds_t::windowFrames;
+    constexpr int64_t overlap = ds_t::windowOverlap;
+
+    auto &s = zone->samplePointers[sampleIndex];
+    auto &vdata = zone->variantData.variants[sampleIndex];
+    auto &streamer = engine->getSampleManager()->getDiskStreamer();
+
+    // Somewhere holding [start, end) of the sample, which a run can read from if its
+    // reads lie in [coverLo, coverHi]
+    struct Source
+    {
+        void *__restrict const *data{nullptr};
+        int64_t start{0}, end{0}, coverLo{0}, coverHi{0};
+        int bank{-1};
+        bool covers(int64_t lo, int64_t hi) const
+        {
+            return data && lo >= coverLo && hi <= coverHi;
+        }
+    };
+    auto findResident = [&s](int64_t lo, int64_t hi, Source &src) {
+        if (lo >= hi || (lo >= -fo && hi <= (int64_t)s->residentHeadFrames))
+        {
+            auto hf = (int64_t)s->residentHeadFrames;
+            src = {s->sampleData, 0, hf, -fo, hf};
+            return true;
+        }
+        for (auto *r : {&s->residentLoop, &s->residentLoopEnd})
+        {
+            if (r->isValid() && lo >= r->start - fo && hi <= r->end + fo)
+            {
+                src = {r->data, r->start, r->end, r->start - fo, r->end + fo};
+                return true;
+            }
+        }
+        return false;
+    };
+    auto findInBank = [this](int bank, int64_t lo, int64_t hi, Source &src) {
+        if (!diskStream->bankCovers(bank, lo, hi))
+            return false;
+        auto bs = diskStream->bankStart[bank];
+        src = {diskStream->bankData[bank], bs, bs + window, bs - fo, bs + window + fo, bank};
+        return true;
+    };
+    auto dataFor = [&s](const Source &src, int c) -> void * {
+        if (c >= s->channels)
+            return nullptr;
+        // Offset so the generator can keep indexing by absolute sample position
+        auto off = (fo - src.start) * sample::Sample::bitDepthByteSize(s->bitDepth);
+        return (uint8_t *)src.data[c] + off;
+    };
+
+    int64_t pos = GD.samplePos;
+    int64_t ratio = std::abs((int64_t)GD.ratio);
+    int dir = GD.direction * (GD.ratio < 0 ? -1 : 1);
+    int64_t loopLen = std::max(1, GD.loopUpperBound - GD.loopLowerBound);
+
+    /*
+     * A forward loop jumps from its end back to its start (or the other way if we play
+     * backwards) and the two may be far apart, so we only run up to the wrap here and
+     * pick up from wherever holds the other side next time.
+     */
+    bool wrapping = vdata.loopActive && vdata.loopDirection == engine::Zone::FORWARD_ONLY &&
+                    (vdata.loopMode != engine::Zone::LOOP_WHILE_GATED || GD.gated);
+    if (wrapping)
+        frames = dsp::framesBeforeLoopWrap(&GD, frames);
+
+    /*
+     * What frames can this run read? Interpolation reads FIRoffset either side of the
+     * play point which moves at most adv frames in our direction, or either way if a
+     * bidirectional loop can turn us around.
+     */
+    int64_t adv = ((ratio * frames) >> 24) + 2;
+    bool canTurn = vdata.loopActive && !wrapping;
+    int64_t lo = pos - fo - (dir < 0 || canTurn ? adv : 0);
+    int64_t hi = pos + fo + (dir > 0 || canTurn ? adv : 0);
+    if (wrapping && dir > 0 && pos <= GD.loopUpperBound)
+        hi = std::min(hi, (int64_t)GD.loopUpperBound + fo);
+    if (wrapping && dir < 0 && pos >= GD.loopLowerBound)
+        lo = std::max(lo, (int64_t)GD.loopLowerBound - fo);
+
+    /*
+     * Near the end of a loop the generator also reads one loop length back, for the
+     * crossfade and to pad the loop end. That wants a source of its own when the loop
+     * start isn't in the one we play from.
+     */
+    int64_t wrapFrom = std::min((int64_t)GD.loopUpperBound - GD.loopFade,
+                                (int64_t)s->sample_length - (int64_t)dsp::FIRipol_N);
+    bool wrapReads =
+        vdata.loopActive && hi - fo >= wrapFrom && lo + fo <= (int64_t)GD.loopUpperBound;
+    int64_t wrapLo = std::max(lo, wrapFrom - fo) - loopLen;
+    int64_t wrapHi = std::min(hi, (int64_t)GD.loopUpperBound + fo) - loopLen;
+
+    lo = std::max(lo, -fo);
+    hi = std::min(hi, (int64_t)s->sample_length + fo);
+    wrapLo = std::max(wrapLo, -fo);
+
+    Source main, wrap;
+    bool found = findResident(lo, hi, main);
+    if (!found && diskStream)
+    {
+        if (!diskStream->frontCovers(lo, hi))
+            streamer->swapIfReady(diskStream);
+        found = diskStream->frontValid && findInBank(diskStream->front, lo, hi, main);
+    }
+
+    bool wrapFound{true};
+    if (found && wrapReads && !main.covers(wrapLo, wrapHi))
+    {
+        wrapFound = findResident(wrapLo, wrapHi, wrap);
+        if (!wrapFound && diskStream)
+        {
+            // The back bank is ours to read once it is ready, until we ask for another
+            wrapFound =
+                (diskStream->frontValid && findInBank(diskStream->front, wrapLo, wrapHi, wrap)) ||
+                (diskStream->backState.load(std::memory_order_acquire) == ds_t::Stream::READY &&
+                 findInBank(diskStream->back(), wrapLo, wrapHi, wrap));
+        }
+    }
+
+    if (!found || !wrapFound)
+    {
+        streamer->underrunCount++;
+        if (diskStream)
+        {
+            if (!found)
+                streamer->requestWindow(diskStream, dir < 0 ? hi - fo - window : lo + fo);
+            else
+                streamer->requestWindow(diskStream, wrapLo + fo);
+        }
+        return 0;
+    }
+
+    GDIO.sampleDataL = dataFor(main, 0);
+    GDIO.sampleDataR = dataFor(main, 1);
+    GDIO.loopWrapDataL = wrap.data ? dataFor(wrap, 0) : nullptr;
+    GDIO.loopWrapDataR = wrap.data ? dataFor(wrap, 1) : nullptr;
+
+    if (!diskStream)
+        return frames;
+
+    /*
+     * Now make sure the back bank holds the window we will need next. That's the one
+     * overlapping the end of our current source in our direction of play, unless a loop
+     * which fits in a window is coming up, in which case we want the whole loop, or we
+     * wrap before we leave this source, in which case we want what follows the far side
+     * of the wrap.
+     */
+    auto cs = main.start, ce = main.end;
+    int64_t loopLo = (int64_t)GD.loopLowerBound - GD.loopFade - fo;
+    int64_t loopHi = (int64_t)GD.loopUpperBound + fo;
+    int64_t next = dir < 0 ? cs + overlap - window : ce - overlap;
+    if (vdata.loopActive && loopHi - loopLo + 2 * overlap <= window)
+    {
+        if (dir >= 0 && pos <= GD.loopUpperBound && loopLo > cs && loopLo + fo < next)
+            next = loopLo + fo;
+        if (dir < 0 && pos >= GD.loopLowerBound && loopHi < ce && loopHi - fo - window > next)
+            next = loopHi - fo - window;
+    }
+    else if (wrapping)
+    {
+        Source after;
+        if (dir > 0 && pos <= GD.loopUpperBound && GD.loopUpperBound <= ce &&
+            GD.loopLowerBound - fo < cs)
+        {
+            auto l = (int64_t)GD.loopLowerBound;
+            next = findResident(l - fo, l + fo, after) ? after.end - overlap : loopLo + fo;
+        }
+        if (dir < 0 && pos >= GD.loopLowerBound && GD.loopLowerBound >= cs &&
+            GD.loopUpperBound + fo > ce)
+        {
+            auto u = (int64_t)GD.loopUpperBound;
+            next = findResident(u - fo, u + fo, after) ? after.start + overlap - window
+                                                        : loopHi - fo - window;
+        }
+    }
+
+    auto bs = diskStream->backState.load(std::memory_order_acquire);
+    if (wrap.bank != diskStream->back() &&
+        (bs == ds_t::Stream::IDLE ||
+         (bs == ds_t::Stream::READY && diskStream->bankStart[diskStream->back()] != next)))
+    {
+        streamer->requestWindow(diskStream, next);
+    }
+    return frames;
+}
+
+void Voice::releaseDiskStream()
+{
+    if (!diskStream)
+        return;
+    engine->getSampleManager()->getDiskStreamer()->release(diskStream);
+    diskStream = nullptr;
+}
+
 float Voice::calculateVoicePitch()
 {
     auto fpitch = key + *endpoints->mappingTarget.pitchOffsetP;
@@ -691,12 +1164,26 @@ void Voice::initializeProcessors()
         {
             processors[i] = nullptr;
         }
+
+        // If the memory pool is dry this processor sits this voice out
+        if (processors[i] && !processors[i]->holdReservedBlocks())
+        {
+            dsp::processor::unspawnProcessor(processors[i]);
+            processors[i] = nullptr;
+        }
+
         if (processors[i])
         {
             processors[i]->setSampleRate(sampleRate * (forceOversample ? 2 : 1));
             processors[i]->setTempoPointer(&(zone->getEngine()->transport.tempo));
 
             processors[i]->init();
+            if (processors[i]->memoryShortfall)
+            {
+                dsp::processor::unspawnProcessor(processors[i]);
+                processors[i] = nullptr;
+                continue;
+            }
             processors[i]->setKeytrack(zone->processorStorage[i].isKeytracked);
 
             processorConsumesMono[i] = monoGenerator && processors[i]->canProcessMono();
@@ -706,13 +1193,14 @@ void Voice::initializeProcessors()
 
 void Voice::updateTransportPhasors()
 {
-    auto bt = engine->transport.timeInBeats - startBeat;
-    float mul = 1 << ((numTransportPhasors - 1) / 2);
+    // frac(a - b) from frac(a) and frac(b), wrapped back into [0,1)
+    const auto &ep = engine->transportPhasors;
     for (int i = 0; i < numTransportPhasors; ++i)
     {
-        float rawBeat;
-        transportPhasors[i] = std::modf((float)(bt)*mul, &rawBeat);
-        mul = mul / 2;
+        auto p = ep[i] - transportPhasorStart[i];
+        p -= std::floor(p);
+        // A tiny negative difference rounds to exactly 1 above
+        transportPhasors[i] = p >= 1.f ? 0.f : p;
     }
 }
 } // namespace scxt::voice
@@ -33,6 +33,7 @@
 #include "dsp/data_tables.h"
 #include "dsp/generator.h"
 #include "dsp/processor/processor.h"
+#include "sample/disk_streamer.h"
 
 #include "modulation/voice_matrix.h"
 #include "modulation/has_modulators.h"
@@ -52,6 +53,11 @@ struct alignas(16) Voice : MoveableOnly<Voice>,
     // I do *not* own these. The engine guarantees it outlives the voice
     engine::Zone *zone{nullptr};
     engine::Engine *engine{nullptr};
+    // Intrusive links in our zone's voice list. See Zone::firstVoice
+    Voice *prevZoneVoice{nullptr}, *nextZoneVoice{nullptr};
+    // Our slot in the engine voice array and links in its (channel, key) index
+    int16_t voiceSlot{-1};
+    Voice *prevKeyVoice{nullptr}, *nextKeyVoice{nullptr};
     engine::Engine::pathToZone_t zonePath{};
     int8_t sampleIndex{0}; // int since - == no sample
 
@@ -92,7 +98,14 @@ struct alignas(16) Voice : MoveableOnly<Voice>,
     template <typename ET, int EB, typename ER>
     friend struct sst::basic_blocks::modulators::ADSREnvelope;
 
-    float transportPhasors[scxt::numTransportPhasors];
+    /*
+     * Voice transport phasors run from the voice start. The engine computes its phasors
+     * once a block, so we hold our starting phase and derive ours from those, and only
+     * when the routing table actually reads a voice phasor.
+     */
+    float transportPhasors[scxt::numTransportPhasors]{};
+    float transportPhasorStart[scxt::numTransportPhasors]{};
+    bool usesTransportPhasors{false};
     double startBeat{0.f};
     void updateTransportPhasors();
 
@@ -117,6 +130,32 @@ struct alignas(16) Voice : MoveableOnly<Voice>,
      */
     void initializeGenerator();
 
+    /**
+     * Disk streaming. If our sample is disk streamed we hold a stream and pick the
+     * generator source (resident head, resident loop or streamed window) for each run
+     * of the generator. A block is one run unless a forward loop wraps in it, in which
+     * case we run up to the wrap and again from the other side.
+     * updateDiskStreamSource returns how many of frames the next run can make, or 0 on
+     * an underrun, in which case we output silence for the rest of the block and stay
+     * where we are.
+     */
+    sample::DiskStreamer::Stream *diskStream{nullptr};
+    bool runDiskStreamedGenerator();
+    int updateDiskStreamSource(int frames);
+    void releaseDiskStream();
+
+    /*
+     * Memory budget residency. The engine swaps sample data only between blocks, evicting
+     * samples no voice plays; when it reloads one in full, voices playing it come off
+     * their streams and point the generator at the full data.
+     */
+    bool playsSample(const sample::Sample *s) const
+    {
+        return sampleIndex >= 0 && zone && zone->samplePointers[sampleIndex].get() == s;
+    }
+    void sampleResidencyChanged();
+    void setGeneratorSampleData();
+
     /**
      * Calculates the pitch of this voice with modulation, MPE, tuning etc in
      */
@@ -149,6 +188,57 @@ struct alignas(16) Voice : MoveableOnly<Voice>,
 
     void panOutputsBy(bool inputIsMono, const lipol &pv);
 
+    /**
+     * Packed output stage. When deferOutputStage is set the voice stops after its
+     * processors and leaves output pan, output amp and AEG scaling as a pan matrix and a
+     * per-sample gain line here. The zone then applies them for up to voiceLaneWidth
+     * voices in lockstep while mixing into its destination (see voice_lanes.h).
+     */
+    struct OutputStage
+    {
+        bool chainIsMono{false};
+        float pan[4]{1, 1, 0, 0}; // L = p0 l + p2 r, R = p1 r + p3 l
+        float gain alignas(16)[blockSize << 1]{};
+    } outputStage;
+    bool deferOutputStage{false};
+    template <bool OS> void prepareOutputStage(bool chainIsMono, float panTarget, float ampTarget);
+
+    /**
+     * Sample accurate starts. The engine renders whole blocks, so a note landing part way
+     * into one starts at the top of it and the voice holds its output back startOffset
+     * frames for its whole life, carrying the overhang into its next block.
+     */
+    int16_t startOffset{0};
+    float startCarry alignas(16)[2][blockSize << 1]{};
+    float startCarryGain alignas(16)[blockSize << 1]{};
+    template <bool OS> void applyStartOffset();
+
+    /**
+     * Voice stealing. voiceStartOrder orders voices by start for the stealing
+     * heuristics and a stolen voice ramps stealFade to zero over a few ms then finishes.
+     * See Engine::stealVoice.
+     */
+    uint64_t voiceStartOrder{0};
+    bool isBeingStolen{false};
+    float stealFadeLevel{1.f}, stealFadeDelta{0.f};
+    lipol stealFade;
+    lipolOS stealFadeOS;
+    void beginStealFade(float fadeSeconds);
+    template <bool OS> void applyStealFade(float *L, float *R);
+
+    /**
+     * Silence detection. Once a voice is released or its generator has finished we
+     * measure the post chain energy, scaled by the AEG, each block and retire the voice
+     * when it stays under Engine::voiceSilenceEnergy for the longest processor
+     * tail_length (or a short minimum hold). Until the generator finishes only the AEG
+     * level counts, since the sample may still be in a quiet stretch. A processor with
+     * an infinite tail keeps the voice running until the AEG completes as before.
+     */
+    int32_t silentSamples{0};
+    bool isRetiredBySilence{false};
+    template <bool OS> void updateSilenceDetection(bool chainIsMono);
+    template <bool OS> float chainEnergy(bool chainIsMono) const;
+
     lipol processorMix[engine::processorCount];
     lipolOS processorMixOS[engine::processorCount];
 
@@ -183,6 +273,10 @@ struct alignas(16) Voice : MoveableOnly<Voice>,
     }
     void release() { isGated = false; }
     void cleanupVoice();
+    bool isStillSounding() const
+    {
+        return isAEGRunning && !isRetiredBySilence && !(isBeingStolen && stealFadeLevel <= 0.f);
+    }
 };
 } // namespace scxt::voice
 
@@ -0,0 +1,85 @@
+/*
+ * Shortcircuit XT - a Surge Synth Team product
+ *
+ * A fully featured creative sampler, available as a standalone
+ * and plugin for multiple platforms.
+ *
+ * Copyright 2019 - 2024, Various authors, as described in the github
+ * transaction log.
+ *
+ * ShortcircuitXT is released under the Gnu General Public Licence
+ * V3 or later (GPL-3.0-or-later). The license is found in the file
+ * "LICENSE" in the root of this repository or at
+ * https://www.gnu.org/licenses/gpl-3.0.en.html
+ *
+ * Individual sections of code which comprises ShortcircuitXT in this
+ * repository may also be used under an MIT license. Please see the
+ * section  "Licensing" in "README.md" for details.
+ *
+ * ShortcircuitXT is inspired by, and shares code with, the
+ * commercial product Shortcircuit 1 and 2, released by VemberTech
+ * in the mid 2000s. The code for Shortcircuit 2 was opensourced in
+ * 2020 at the outset of this project.
+ *
+ * All source for ShortcircuitXT is available at
+ * https://github.com/surge-synthesizer/shortcircuit-xt
+ */
+
+#ifndef SCXT_SRC_VOICE_VOICE_LANES_H
+#define SCXT_SRC_VOICE_VOICE_LANES_H
+
+#include <cassert>
+#include "voice.h"
+#include "infrastructure/sse_include.h"
+
+namespace scxt::voice
+{
+/*
+ * Mix the deferred output stage (see Voice::OutputStage) of up to voiceLaneWidth voices
+ * of one zone onto a destination. The voices run in lockstep: for each group of four
+ * samples every lane applies its gain line and pan matrix and the lanes are summed in
+ * registers, so each voice buffer is read once and the destination is read and written
+ * once per lane group rather than once per voice for each of pan, amp, AEG and mix.
+ */
+template <size_t N>
+inline void mixOutputStageLanes(Voice *const *lanes, size_t nLanes, float *__restrict dL,
+                                float *__restrict dR)
+{
+    static_assert(N % 4 == 0);
+    assert(nLanes <= voiceLaneWidth);
+
+    __m128 p0[voiceLaneWidth], p1[voiceLaneWidth], p2[voiceLaneWidth], p3[voiceLaneWidth];
+    const float *inL[voiceLaneWidth], *inR[voiceLaneWidth], *gain[voiceLaneWidth];
+    for (size_t v = 0; v < nLanes; ++v)
+    {
+        const auto &st = lanes[v]->outputStage;
+        p0[v] = _mm_set1_ps(st.pan[0]);
+        p1[v] = _mm_set1_ps(st.pan[1]);
+        p2[v] = _mm_set1_ps(st.pan[2]);
+        p3[v] = _mm_set1_ps(st.pan[3]);
+        inL[v] = lanes[v]->output[0];
+        // A mono chain has nothing meaningful in the right channel; the pan matrix zeroes
+        // the right hand terms so just read the left twice
+        inR[v] = st.chainIsMono ? lanes[v]->output[0] : lanes[v]->output[1];
+        gain[v] = st.gain;
+    }
+
+    for (size_t i = 0; i < N; i += 4)
+    {
+        auto accL = _mm_load_ps(dL + i);
+        auto accR = _mm_load_ps(dR + i);
+        for (size_t v = 0; v < nLanes; ++v)
+        {
+            auto g = _mm_load_ps(gain[v] + i);
+            auto l = _mm_mul_ps(_mm_load_ps(inL[v] + i), g);
+            auto r = _mm_mul_ps(_mm_load_ps(inR[v] + i), g);
+            accL = _mm_add_ps(accL, _mm_add_ps(_mm_mul_ps(p0[v], l), _mm_mul_ps(p2[v], r)));
+            accR = _mm_add_ps(accR, _mm_add_ps(_mm_mul_ps(p1[v], r), _mm_mul_ps(p3[v], l)));
+        }
+        _mm_store_ps(dL + i, accL);
+        _mm_store_ps(dR + i, accR);
+    }
+}
+} // namespace scxt::voice
+
+#endif // SCXT_SRC_VOICE_VOICE_LANES_H
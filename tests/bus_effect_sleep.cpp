@@ -0,0 +1,88 @@
+/*
+ * Shortcircuit XT - a Surge Synth Team product
+ *
+ * A fully featured creative sampler, available as a standalone
+ * and plugin for multiple platforms.
+ *
+ * Copyright 2019 - 2024, Various authors, as described in the github
+ * transaction log.
+ *
+ * ShortcircuitXT is released under the Gnu General Public Licence
+ * V3 or later (GPL-3.0-or-later). The license is found in the file
+ * "LICENSE" in the root of this repository or at
+ * https://www.gnu.org/licenses/gpl-3.0.en.html
+ *
+ * Individual sections of code which comprises ShortcircuitXT in this
+ * repository may also be used under an MIT license. Please see the
+ * section  "Licensing" in "README.md" for details.
+ *
+ * ShortcircuitXT is inspired by, and shares code with, the
+ * commercial product Shortcircuit 1 and 2, released by VemberTech
+ * in the mid 2000s. The code for Shortcircuit 2 was opensourced in
+ * 2020 at the outset of this project.
+ *
+ * All source for ShortcircuitXT is available at
+ * https://github.com/surge-synthesizer/shortcircuit-xt
+ */
+
+#include "catch2/catch2.hpp"
+#include "engine/engine.h"
+
+#include <cmath>
+
+using namespace scxt;
+
+TEST_CASE("Bus Effects Sleep On Silence", "[bus]")
+{
+    auto engine = std::make_unique<engine::Engine>();
+    engine->prepareToPlay(48000);
+
+    auto &bus = engine->getPatch()->busses.auxBusses[0];
+    bus.setBusEffectType(*engine, 0, engine::AvailableBusEffects::phaser);
+    REQUIRE(bus.busEffects[0]);
+    auto tail = bus.busEffects[0]->tailLength();
+    REQUIRE(tail >= 0);
+
+    // Feed one block at the bus input and process it, as the engine does
+    int32_t frame{0};
+    auto runBlock = [&](float amp) {
+        bus.clear();
+        for (int i = 0; i < blockSize; ++i)
+        {
+            auto v = amp * std::sin((frame + i) * 0.05f);
+            bus.output[0][i] = v;
+            bus.output[1][i] = v;
+        }
+        frame += blockSize;
+        bus.process();
+    };
+
+    for (int b = 0; b < 200; ++b)
+        runBlock(0.5f);
+    REQUIRE(!bus.effectSleep[0].asleep);
+
+    // The effect stays awake through its tail, then sleeps once its output decays
+    int32_t silent{0};
+    while (!bus.effectSleep[0].asleep && silent < tail + 48000 * 5)
+    {
+        runBlock(0.f);
+        silent += blockSize;
+        if (silent < tail)
+            REQUIRE(!bus.effectSleep[0].asleep);
+    }
+    REQUIRE(bus.effectSleep[0].asleep);
+    REQUIRE(silent >= tail);
+    REQUIRE(bus.sleepingEffectCount() == 1);
+
+    // A sleeping effect passes its silent input through
+    runBlock(0.f);
+    REQUIRE(bus.effectSleep[0].asleep);
+    for (int i = 0; i < blockSize; ++i)
+        REQUIRE(bus.output[0][i] == 0.f);
+
+    // and the first block with signal wakes it
+    runBlock(0.5f);
+    REQUIRE(!bus.effectSleep[0].asleep);
+    REQUIRE(bus.effectSleep[0].silentInputSamples == 0);
+    REQUIRE(bus.sleepingEffectCount() == 0);
+}
@@ -0,0 +1,126 @@
+/*
+ * Shortcircuit XT - a Surge Synth Team product
+ *
+ * A fully featured creative sampler, available as a standalone
+ * and plugin for multiple platforms.
+ *
+ * Copyright 2019 - 2024, Various authors, as described in the github
+ * transaction log.
+ *
+ * ShortcircuitXT is released under the Gnu General Public Licence
+ * V3 or later (GPL-3.0-or-later). The license is found in the file
+ * "LICENSE" in the root of this repository or at
+ * https://www.gnu.org/licenses/gpl-3.0.en.html
+ *
+ * Individual sections of code which comprises ShortcircuitXT in this
+ * repository may also be used under an MIT license. Please see the
+ * section  "Licensing" in "README.md" for details.
+ *
+ * ShortcircuitXT is inspired by, and shares code with, the
+ * commercial product Shortcircuit 1 and 2, released by VemberTech
+ * in the mid 2000s. The code for Shortcircuit 2 was opensourced in
+ * 2020 at the outset of this project.
+ *
+ * All source for ShortcircuitXT is available at
+ * https://github.com/surge-synthesizer/shortcircuit-xt
+ */
+
+#include "catch2/catch2.hpp"
+#include "sample/sample.h"
+#include "test_wav_writer.h"
+
+#include <cmath>
+#include <fstream>
+
+using namespace scxt;
+
+namespace
+{
+// Overwrite a field in the cache file header, at a byte offset
+template <typename T> void patchHeader(const fs::path &p, std::streamoff at, T value)
+{
+    std::fstream f(p, std::ios::binary | std::ios::in | std::ios::out);
+    f.seekp(at);
+    f.write((const char *)&value, sizeof(value));
+}
+} // namespace
+
+TEST_CASE("Decoded Sample Cache File", "[sample]")
+{
+    static constexpr uint32_t frames{30000};
+    auto source = fs::temp_directory_path() / "scxt-test-decoded-cache.wav";
+    auto cache = fs::temp_directory_path() / "scxt-test-decoded-cache.scxtpcm";
+    REQUIRE(tests::writeTestWav(source, 2, 16, frames, [](uint32_t f, int c) {
+        return (int32_t)(std::sin(f * 0.011 + c) * 0.6 * INT32_MAX);
+    }));
+
+    auto decoded = std::make_shared<sample::Sample>();
+    REQUIRE(decoded->load(source));
+    REQUIRE(decoded->writeDecodedCacheFile(cache));
+
+    SECTION("Round Trips")
+    {
+        auto cached = std::make_shared<sample::Sample>();
+        REQUIRE(cached->loadDecodedCacheFile(cache, source));
+        REQUIRE(cached->isMemoryMapped);
+        REQUIRE(cached->isFromDecodedCache);
+        REQUIRE(cached->getSampleLength() == frames);
+        REQUIRE(cached->channels == 2);
+        REQUIRE(cached->bitDepth == decoded->bitDepth);
+        REQUIRE(cached->sample_rate == decoded->sample_rate);
+
+        for (int c = 0; c < 2; ++c)
+        {
+            auto *a = decoded->GetSamplePtrI16(c);
+            auto *b = cached->GetSamplePtrI16(c);
+            REQUIRE(b);
+            // Including the zero padding either side, which the generator reads
+            for (int64_t i = -(int64_t)dsp::FIRoffset; i < frames + dsp::FIRoffset; ++i)
+                REQUIRE(a[i] == b[i]);
+        }
+    }
+
+    // magic[8], then version, sampleRate, sampleLength, channels, bitDepth, firOffset as
+    // uint32s, then dataOffset and channelStride as uint64s
+    SECTION("Rejects A Different Version")
+    {
+        patchHeader(cache, 8, (uint32_t)1000);
+        auto cached = std::make_shared<sample::Sample>();
+        REQUIRE(!cached->loadDecodedCacheFile(cache, source));
+    }
+
+    SECTION("Rejects Different Padding")
+    {
+        patchHeader(cache, 28, (uint32_t)dsp::FIRoffset * 2);
+        auto cached = std::make_shared<sample::Sample>();
+        REQUIRE(!cached->loadDecodedCacheFile(cache, source));
+    }
+
+    SECTION("Rejects Misaligned Data")
+    {
+        patchHeader(cache, 32, (uint64_t)56);
+        auto cached = std::make_shared<sample::Sample>();
+        REQUIRE(!cached->loadDecodedCacheFile(cache, source));
+    }
+
+    SECTION("Rejects Data Past The End")
+    {
+        patchHeader(cache, 32, (uint64_t)1 << 40);
+        auto cached = std::make_shared<sample::Sample>();
+        REQUIRE(!cached->loadDecodedCacheFile(cache, source));
+
+        patchHeader(cache, 32, (uint64_t)64);
+        patchHeader(cache, 40, ~(uint64_t)63);
+        REQUIRE(!cached->loadDecodedCacheFile(cache, source));
+    }
+
+    SECTION("Rejects A Truncated File")
+    {
+        fs::resize_file(cache, fs::file_size(cache) / 2);
+        auto cached = std::make_shared<sample::Sample>();
+        REQUIRE(!cached->loadDecodedCacheFile(cache, source));
+    }
+
+    fs::remove(cache);
+    fs::remove(source);
+}
@@ -0,0 +1,328 @@
+/*
+ * Shortcircuit XT - a Surge Synth Team product
+ *
+ * A fully featured creative sampler, available as a standalone
+ * and plugin for multiple platforms.
+ *
+ * Copyright 2019 - 2024, Various authors, as described in the github
+ * transaction log.
+ *
+ * ShortcircuitXT is released under the Gnu General Public Licence
+ * V3 or later (GPL-3.0-or-later). The license is found in the file
+ * "LICENSE" in the root of this repository or at
+ * https://www.gnu.org/licenses/gpl-3.0.en.html
+ *
+ * Individual sections of code which comprises ShortcircuitXT in this
+ * repository may also be used under an MIT license. Please see the
+ * section  "Licensing" in "README.md" for details.
+ *
+ * ShortcircuitXT is inspired by, and shares code with, the
+ * commercial product Shortcircuit 1 and 2, released by VemberTech
+ * in the mid 2000s. The code for Shortcircuit 2 was opensourced in
+ * 2020 at the outset of this project.
+ *
+ * All source for ShortcircuitXT is available at
+ * https://github.com/surge-synthesizer/shortcircuit-xt
+ */
+
+#include "catch2/catch2.hpp"
+#include "sample/sample.h"
+#include "sample/disk_streamer.h"
+#include "dsp/generator.h"
+#include "dsp/sample_analytics.h"
+#include "test_wav_writer.h"
+
+#include <chrono>
+#include <cmath>
+#include <thread>
+
+using namespace scxt;
+
+namespace
+{
+int32_t testSignal(uint32_t f, int)
+{
+    return (int32_t)(std::sin(f * 0.0137) * 0.7 * INT32_MAX) + (int32_t)((f % 97) << 16);
+}
+
+// The generator wants a source offset so it can index by absolute sample position
+int16_t *regionSource(const sample::Sample::ResidentRegion &r)
+{
+    return (int16_t *)r.data[0] + dsp::FIRoffset - r.start;
+}
+} // namespace
+
+TEST_CASE("Disk Streamed Loops", "[sample]")
+{
+    static constexpr uint32_t frames{1 << 18};
+    static constexpr int32_t loopStart{20000}, loopEnd{230000};
+
+    auto path = fs::temp_directory_path() / "scxt-test-streamed-loop.wav";
+    REQUIRE(tests::writeTestWav(path, 1, 16, frames, testSignal, loopStart, loopEnd - 1));
+
+    auto full = std::make_shared<sample::Sample>();
+    REQUIRE(full->load(path));
+    REQUIRE(!full->isDiskStreamed);
+
+    auto streamed = std::make_shared<sample::Sample>();
+    streamed->diskStreamHeadFrames = 8192;
+    REQUIRE(streamed->load(path));
+    REQUIRE(streamed->isDiskStreamed);
+    REQUIRE(streamed->meta.loop_start == loopStart);
+    REQUIRE(streamed->meta.loop_end == loopEnd);
+
+    auto &startRegion = streamed->residentLoop;
+    auto &endRegion = streamed->residentLoopEnd;
+
+    SECTION("A long loop keeps both sides of the wrap")
+    {
+        REQUIRE(startRegion.isValid());
+        REQUIRE(endRegion.isValid());
+        REQUIRE(startRegion.start <= loopStart - (int64_t)sample::Sample::diskStreamLoopPreroll);
+        REQUIRE(startRegion.end >= loopStart + (int64_t)sample::Sample::diskStreamLoopWrapFrames);
+        REQUIRE(endRegion.start <= loopEnd - (int64_t)sample::Sample::diskStreamLoopWrapFrames);
+        REQUIRE(endRegion.end == loopEnd);
+
+        auto *ref = full->GetSamplePtrI16(0);
+        for (auto *r : {&startRegion, &endRegion})
+        {
+            auto *src = regionSource(*r);
+            for (auto p = r->start; p < r->end; p += 101)
+                REQUIRE(src[p] == ref[p]);
+        }
+    }
+
+    SECTION("Frames before the wrap")
+    {
+        dsp::GeneratorState gd;
+        gd.direction = 1;
+        gd.loopLowerBound = loopStart;
+        gd.loopUpperBound = loopEnd;
+        gd.ratio = 1 << 24;
+        gd.samplePos = loopEnd - 10;
+        gd.sampleSubPos = 0;
+        REQUIRE(dsp::framesBeforeLoopWrap(&gd, 64) == 11);
+        REQUIRE(dsp::framesBeforeLoopWrap(&gd, 8) == 8);
+
+        gd.ratio = 2 << 24;
+        REQUIRE(dsp::framesBeforeLoopWrap(&gd, 64) == 6);
+
+        gd.samplePos = loopEnd + 3;
+        REQUIRE(dsp::framesBeforeLoopWrap(&gd, 64) == 1);
+
+        gd.direction = -1;
+        gd.ratio = 1 << 24;
+        gd.samplePos = loopStart + 4;
+        gd.sampleSubPos = 1 << 23;
+        REQUIRE(dsp::framesBeforeLoopWrap(&gd, 64) == 5);
+    }
+
+    SECTION("Playing across the wrap from the resident sides matches the full sample")
+    {
+        REQUIRE(startRegion.isValid());
+        REQUIRE(endRegion.isValid());
+
+        for (auto ratio : {1.0, 1.37, 0.61, 5.3})
+        {
+            INFO("Playback ratio " << ratio);
+            dsp::GeneratorState ref, tst;
+            for (auto *g : {&ref, &tst})
+            {
+                g->direction = 1;
+                g->directionAtOutset = 1;
+                g->samplePos = loopEnd - 3000;
+                g->sampleSubPos = 0;
+                g->playbackLowerBound = 0;
+                g->playbackUpperBound = frames - 1;
+                g->loopLowerBound = loopStart;
+                g->loopUpperBound = loopEnd;
+                g->loopFade = 1000;
+                g->ratio = (int32_t)(ratio * (1 << 24));
+                g->isFinished = false;
+                g->interpolationType = dsp::InterpolationTypes::Linear;
+            }
+            auto gen = dsp::GetFPtrGeneratorSample(false, dsp::GSF_I16, true, true, false);
+
+            float refOut[blockSize], tstOut[blockSize], unused[blockSize];
+            dsp::GeneratorIO refIO;
+            refIO.outputL = refOut;
+            refIO.outputR = unused;
+            refIO.sampleDataL = full->GetSamplePtrI16(0);
+            refIO.waveSize = frames;
+
+            // Play until we are well into the start side, splitting at the wrap as a
+            // streamed voice does, with the start side serving the crossfade
+            int blocks = (int)(12000 / (ratio * blockSize));
+            bool wrapped{false};
+            for (int b = 0; b < blocks; ++b)
+            {
+                gen(&ref, &refIO);
+
+                int done{0};
+                while (done < blockSize)
+                {
+                    auto n = dsp::framesBeforeLoopWrap(&tst, blockSize - done);
+                    auto *side = tst.samplePos > loopEnd - 8192 ? &endRegion : &startRegion;
+                    wrapped = wrapped || side == &startRegion;
+
+                    dsp::GeneratorIO io;
+                    io.outputL = tstOut + done;
+                    io.outputR = unused;
+                    io.sampleDataL = regionSource(*side);
+                    io.loopWrapDataL = regionSource(startRegion);
+                    io.waveSize = frames;
+                    tst.blockSize = n;
+                    gen(&tst, &io);
+                    done += n;
+                }
+
+                REQUIRE(tst.samplePos == ref.samplePos);
+                for (int i = 0; i < blockSize; ++i)
+                    REQUIRE(tstOut[i] == Approx(refOut[i]).margin(1e-6));
+            }
+            REQUIRE(wrapped);
+        }
+    }
+
+    fs::remove(path);
+}
+
+TEST_CASE("Disk Streamed Analytics", "[sample]")
+{
+    // Quiet through the resident head and loud after it
+    auto path = fs::temp_directory_path() / "scxt-test-streamed-analytics.wav";
+    REQUIRE(tests::writeTestWav(path, 2, 16, 100000, [](uint32_t f, int c) {
+        auto amp = f < 20000 ? 0.1 : 0.8;
+        return (int32_t)(std::sin(f * 0.03 + c) * amp * INT32_MAX);
+    }));
+
+    auto full = std::make_shared<sample::Sample>();
+    REQUIRE(full->load(path));
+    auto streamed = std::make_shared<sample::Sample>();
+    streamed->diskStreamHeadFrames = 8192;
+    REQUIRE(streamed->load(path));
+    REQUIRE(streamed->isDiskStreamed);
+
+    auto peak = dsp::sample_analytics::computePeak(full);
+    auto rms = dsp::sample_analytics::computeRMS(full);
+    REQUIRE(peak > 0.75f);
+    REQUIRE(dsp::sample_analytics::computePeak(streamed) == Approx(peak));
+    REQUIRE(dsp::sample_analytics::computeRMS(streamed) == Approx(rms));
+
+    fs::remove(path);
+}
+
+TEST_CASE("Sample Residency Swap", "[sample]")
+{
+    static constexpr uint32_t frames{100000};
+    auto path = fs::temp_directory_path() / "scxt-test-residency-swap.wav";
+    REQUIRE(tests::writeTestWav(path, 2, 16, frames, testSignal));
+
+    // What the memory budget does: evict a full sample to a streamed head, then reload it
+    auto smp = std::make_shared<sample::Sample>();
+    REQUIRE(smp->load(path));
+    auto head = std::make_shared<sample::Sample>();
+    head->diskStreamHeadFrames = 8192;
+    REQUIRE(head->load(path));
+    REQUIRE(head->isDiskStreamed);
+
+    auto peak = dsp::sample_analytics::computePeak(smp);
+    auto full = smp->getResidentSnapshot();
+    REQUIRE(full.frames == frames);
+    REQUIRE(full.data[0] == smp->sampleData[0]);
+
+    smp->swapResidentData(*head);
+    REQUIRE(smp->isDiskStreamed);
+
+    auto evicted = smp->getResidentSnapshot();
+    REQUIRE(evicted.frames == smp->getResidentSampleLength());
+    REQUIRE(evicted.frames < frames);
+    REQUIRE(evicted.data[0] == smp->sampleData[0]);
+    REQUIRE(evicted.data[1] == smp->sampleData[1]);
+
+    // A reader still holding the old snapshot sees the full data and its length, which
+    // the retired sample now owns
+    auto retired = head->getResidentSnapshot();
+    REQUIRE(retired.frames == frames);
+    REQUIRE(retired.data[0] == full.data[0]);
+    REQUIRE(retired.data[1] == full.data[1]);
+
+    for (int c = 0; c < 2; ++c)
+    {
+        auto *e = evicted.channel<int16_t>(c);
+        auto *f = full.channel<int16_t>(c);
+        for (size_t i = 0; i < evicted.frames; i += 37)
+            REQUIRE(e[i] == f[i]);
+    }
+    REQUIRE(dsp::sample_analytics::computePeak(smp) == Approx(peak));
+
+    smp->swapResidentData(*head);
+    REQUIRE(!smp->isDiskStreamed);
+    auto reloaded = smp->getResidentSnapshot();
+    REQUIRE(reloaded.frames == frames);
+    REQUIRE(reloaded.data[0] == full.data[0]);
+    REQUIRE(head->getResidentSnapshot().frames == evicted.frames);
+
+    fs::remove(path);
+}
+
+TEST_CASE("Memory Mapped 24 Bit WAV", "[sample]")
+{
+    // A plain 44 byte header leaves the data off any multiple of 3 bytes, which is fine
+    // for packed 24 bit data since it is read a byte at a time
+    static constexpr uint32_t frames{20000};
+    auto path = fs::temp_directory_path() / "scxt-test-mapped-24.wav";
+    REQUIRE(tests::writeTestWav(path, 1, 24, frames, testSignal));
+
+    auto copied = std::make_shared<sample::Sample>();
+    copied->packI24 = true;
+    REQUIRE(copied->load(path));
+    REQUIRE(!copied->isMemoryMapped);
+
+    auto mapped = std::make_shared<sample::Sample>();
+    mapped->packI24 = true;
+    mapped->mapWavData = true;
+    REQUIRE(mapped->load(path));
+    REQUIRE(mapped->isMemoryMapped);
+    REQUIRE(mapped->bitDepth == sample::Sample::BD_I24);
+    REQUIRE(mapped->getResidentDataSize() == 0);
+
+    auto *m = mapped->GetSamplePtrI24(0);
+    auto *c = copied->GetSamplePtrI24(0);
+    REQUIRE(m);
+    REQUIRE(c);
+    for (uint32_t i = 0; i < frames; i += 7)
+        REQUIRE(m[i].toInt() == c[i].toInt());
+
+    fs::remove(path);
+}
+
+TEST_CASE("Disk Streamer Pool", "[sample]")
+{
+    using namespace std::chrono_literals;
+    sample::DiskStreamer streamer;
+    sample::Sample smp;
+
+    SECTION("Starts with a chunk of streams")
+    {
+        REQUIRE(streamer.allocatedStreams == sample::DiskStreamer::streamsPerChunk);
+    }
+
+    SECTION("Grows to a stream for every voice")
+    {
+        std::vector<sample::DiskStreamer::Stream *> held;
+        for (int tries = 0; tries < 2000 && held.size() < maxVoices; ++tries)
+        {
+            auto *s = streamer.acquire(&smp);
+            if (s)
+                held.push_back(s);
+            else
+                std::this_thread::sleep_for(1ms);
+        }
+        REQUIRE(held.size() == maxVoices);
+        REQUIRE(streamer.allocatedStreams <= sample::DiskStreamer::maxStreams);
+
+        for (auto *s : held)
+            streamer.release(s);
+    }
+}
@@ -0,0 +1,139 @@
+/*
+ * Shortcircuit XT - a Surge Synth Team product
+ *
+ * A fully featured creative sampler, available as a standalone
+ * and plugin for multiple platforms.
+ *
+ * Copyright 2019 - 2024, Various authors, as described in the github
+ * transaction log.
+ *
+ * ShortcircuitXT is released under the Gnu General Public Licence
+ * V3 or later (GPL-3.0-or-later). The license is found in the file
+ * "LICENSE" in the root of this repository or at
+ * https://www.gnu.org/licenses/gpl-3.0.en.html
+ *
+ * Individual sections of code which comprises ShortcircuitXT in this
+ * repository may also be used under an MIT license. Please see the
+ * section  "Licensing" in "README.md" for details.
+ *
+ * ShortcircuitXT is inspired by, and shares code with, the
+ * commercial product Shortcircuit 1 and 2, released by VemberTech
+ * in the mid 2000s. The code for Shortcircuit 2 was opensourced in
+ * 2020 at the outset of this project.
+ *
+ * All source for ShortcircuitXT is available at
+ * https://github.com/surge-synthesizer/shortcircuit-xt
+ */
+
+#include "catch2/catch2.hpp"
+#include "engine/memory_pool.h"
+
+#include <thread>
+#include <vector>
+
+using namespace scxt;
+
+namespace
+{
+// Run f as the audio thread would, so the pool may not grow
+template <typename F> void onRealtimeThread(F &&f)
+{
+    std::thread t([&f]() {
+        engine::MemoryPool::isRealtimeThread = true;
+        f();
+    });
+    t.join();
+}
+} // namespace
+
+TEST_CASE("Memory Pool Realtime Checkout", "[memory]")
+{
+    static constexpr size_t blockSize{4000};
+    engine::MemoryPool pool;
+    int refillRequests{0};
+    pool.requestRefill = [&refillRequests]() { refillRequests++; };
+
+    SECTION("Pre-Reserve Fills Off The Audio Thread")
+    {
+        pool.preReservePool(blockSize);
+        auto st = pool.getStats();
+        REQUIRE(st.size() == 1);
+        REQUIRE(st[0].allocated == engine::MemoryPool::initialPoolSize);
+
+        // A second reserve of the same size with a full class costs nothing
+        pool.preReservePool(blockSize);
+        REQUIRE(pool.getStats()[0].allocated == engine::MemoryPool::initialPoolSize);
+    }
+
+    SECTION("Checkout And Return Never Grow On The Audio Thread")
+    {
+        pool.preReservePool(blockSize);
+
+        std::vector<uint8_t *> blocks;
+        onRealtimeThread([&]() {
+            for (auto i = 0U; i < engine::MemoryPool::initialPoolSize; ++i)
+                blocks.push_back(pool.checkoutBlock(blockSize));
+        });
+        for (auto *b : blocks)
+            REQUIRE(b);
+
+        auto st = pool.getStats()[0];
+        REQUIRE(st.allocated == engine::MemoryPool::initialPoolSize);
+        REQUIRE(st.inUse == engine::MemoryPool::initialPoolSize);
+        REQUIRE(st.shortfalls == 0);
+        // We went under the low water mark, but a realtime thread (perhaps a part render
+        // worker) only flags that. The audio thread sends it once its workers are done.
+        REQUIRE(refillRequests == 0);
+        onRealtimeThread([&]() {
+            pool.dispatchRefillRequest();
+            pool.dispatchRefillRequest();
+        });
+        REQUIRE(refillRequests == 1);
+
+        onRealtimeThread([&]() {
+            for (auto *b : blocks)
+                pool.returnBlock(b, blockSize);
+        });
+        blocks.clear();
+        REQUIRE(pool.getStats()[0].inUse == 0);
+        REQUIRE(pool.getRetiredBlockCount() == 0);
+
+        // and the serialization thread does the growing
+        pool.refillPools();
+        REQUIRE(pool.getStats()[0].allocated == engine::MemoryPool::initialPoolSize);
+    }
+
+    SECTION("Running Dry Returns Null And Records A Shortfall")
+    {
+        pool.preReservePool(blockSize);
+
+        std::vector<uint8_t *> blocks;
+        uint8_t *dry{reinterpret_cast<uint8_t *>(1)};
+        onRealtimeThread([&]() {
+            for (auto i = 0U; i < engine::MemoryPool::initialPoolSize; ++i)
+                blocks.push_back(pool.checkoutBlock(blockSize));
+            // The class is empty, and the audio thread may not allocate
+            dry = pool.checkoutBlock(blockSize);
+        });
+        REQUIRE(dry == nullptr);
+
+        auto st = pool.getStats()[0];
+        REQUIRE(st.shortfalls == 1);
+        REQUIRE(st.allocated == engine::MemoryPool::initialPoolSize);
+        REQUIRE(st.inUse == engine::MemoryPool::initialPoolSize);
+
+        onRealtimeThread([&]() {
+            pool.dispatchRefillRequest();
+            for (auto *b : blocks)
+                pool.returnBlock(b, blockSize);
+        });
+        blocks.clear();
+        REQUIRE(refillRequests == 1);
+
+        // The refill reports the shortfall and doubles the class
+        pool.refillPools();
+        st = pool.getStats()[0];
+        REQUIRE(st.inUse == 0);
+        REQUIRE(st.allocated == 2 * engine::MemoryPool::initialPoolSize);
+    }
+}
@@ -0,0 +1,62 @@
+/*
+ * Shortcircuit XT - a Surge Synth Team product
+ *
+ * A fully featured creative sampler, available as a standalone
+ * and plugin for multiple platforms.
+ *
+ * Copyright 2019 - 2024, Various authors, as described in the github
+ * transaction log.
+ *
+ * ShortcircuitXT is released under the Gnu General Public Licence
+ * V3 or later (GPL-3.0-or-later). The license is found in the file
+ * "LICENSE" in the root of this repository or at
+ * https://www.gnu.org/licenses/gpl-3.0.en.html
+ *
+ * Individual sections of code which comprises ShortcircuitXT in this
+ * repository may also be used under an MIT license. Please see the
+ * section  "Licensing" in "README.md" for details.
+ *
+ * ShortcircuitXT is inspired by, and shares code with, the
+ * commercial product Shortcircuit 1 and 2, released by VemberTech
+ * in the mid 2000s. The code for Shortcircuit 2 was opensourced in
+ * 2020 at the outset of this project.
+ *
+ * All source for ShortcircuitXT is available at
+ * https://github.com/surge-synthesizer/shortcircuit-xt
+ */
+
+#include "catch2/catch2.hpp"
+#include "engine/zone.h"
+
+using namespace scxt;
+
+TEST_CASE("Zone Routing Plan Depth Scales", "[modulation]")
+{
+    engine::Zone z;
+    auto tg = modulation::shared::TargetIdentifier{'proc', 'fp01', 0};
+    z.routingTable.routes[0].target = tg;
+    z.onRoutingChanged();
+
+    auto *pt = z.routingPlan.findTarget(tg);
+    REQUIRE(pt);
+    REQUIRE(!pt->depthScaleKnown);
+
+    // As if a voice had bound the target and cached its range
+    pt->depthScale = 2.f;
+    pt->depthScaleKnown = true;
+
+    SECTION("Re-describing a processor drops the cached ranges")
+    {
+        // Keytrack and consistency changes re-describe without changing the type
+        z.setupProcessorControlDescriptions(0, dsp::processor::proct_none, nullptr, true);
+        REQUIRE(!pt->depthScaleKnown);
+    }
+
+    SECTION("Recompiling the plan drops the cached ranges")
+    {
+        z.onRoutingChanged();
+        pt = z.routingPlan.findTarget(tg);
+        REQUIRE(pt);
+        REQUIRE(!pt->depthScaleKnown);
+    }
+}
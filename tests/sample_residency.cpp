@@ -0,0 +1,120 @@
+/*
+ * Shortcircuit XT - a Surge Synth Team product
+ *
+ * A fully featured creative sampler, available as a standalone
+ * and plugin for multiple platforms.
+ *
+ * Copyright 2019 - 2024, Various authors, as described in the github
+ * transaction log.
+ *
+ * ShortcircuitXT is released under the Gnu General Public Licence
+ * V3 or later (GPL-3.0-or-later). The license is found in the file
+ * "LICENSE" in the root of this repository or at
+ * https://www.gnu.org/licenses/gpl-3.0.en.html
+ *
+ * Individual sections of code which comprises ShortcircuitXT in this
+ * repository may also be used under an MIT license. Please see the
+ * section  "Licensing" in "README.md" for details.
+ *
+ * ShortcircuitXT is inspired by, and shares code with, the
+ * commercial product Shortcircuit 1 and 2, released by VemberTech
+ * in the mid 2000s. The code for Shortcircuit 2 was opensourced in
+ * 2020 at the outset of this project.
+ *
+ * All source for ShortcircuitXT is available at
+ * https://github.com/surge-synthesizer/shortcircuit-xt
+ */
+
+#include "catch2/catch2.hpp"
+#include "sample/sample_manager.h"
+#include "sample/shared_sample_store.h"
+#include "test_wav_writer.h"
+
+#include <chrono>
+#include <cmath>
+#include <thread>
+
+using namespace scxt;
+
+namespace
+{
+/*
+ * Run the residency scan until a change comes back and apply it as the engine does on
+ * the audio thread (we have no voices to check). False if nothing was evicted in time.
+ */
+bool evictWithin(sample::SampleManager &sm, std::chrono::milliseconds wait)
+{
+    auto until = std::chrono::steady_clock::now() + wait;
+    while (std::chrono::steady_clock::now() < until)
+    {
+        auto changes = sm.updateResidency();
+        for (const auto &c : changes)
+        {
+            c.sample->swapResidentData(*c.replacement);
+            c.sample->diskStreamer = sm.getDiskStreamer().get();
+            c.sample->isEvicted = true;
+            sm.residencyChangeDone(c);
+        }
+        if (!changes.empty())
+            return true;
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    }
+    return false;
+}
+} // namespace
+
+TEST_CASE("Shared Samples Evict Under A Budget", "[sample]")
+{
+    static constexpr uint32_t frames{sample::SampleManager::diskStreamHeadFrames * 4};
+    auto path = fs::temp_directory_path() / "scxt-test-shared-residency.wav";
+    REQUIRE(tests::writeTestWav(path, 1, 16, frames, [](uint32_t f, int) {
+        return (int32_t)(std::sin(f * 0.013) * 0.5 * INT32_MAX);
+    }));
+
+    ThreadingChecker checker;
+    checker.registerAsSerialThread();
+    auto &store = sample::SharedSampleStore::get();
+
+    // Load fully resident into the shared store, then allow streaming so we can evict
+    auto load = [&](sample::SampleManager &sm) {
+        sm.useSharedSampleStore = true;
+        auto id = sm.loadSampleByPath(path);
+        REQUIRE(id.has_value());
+        sm.enableDiskStreaming();
+        return sm.getSample(*id);
+    };
+
+    SECTION("A Sample Only We Use Evicts")
+    {
+        sample::SampleManager sm(checker);
+        auto s = load(sm);
+        REQUIRE(store.usersOf(s.get()) == 1);
+
+        sm.setMemoryBudget(1);
+        REQUIRE(evictWithin(sm, std::chrono::seconds(10)));
+        REQUIRE(s->isEvicted);
+        REQUIRE(sm.residencyStats.evictions == 1);
+        // and it left the store as it went, so no one else can pick it up
+        REQUIRE(store.usersOf(s.get()) == 0);
+    }
+
+    SECTION("A Sample Another Engine Uses Stays")
+    {
+        sample::SampleManager sm(checker), other(checker);
+        auto s = load(sm);
+        REQUIRE(load(other) == s);
+        REQUIRE(store.usersOf(s.get()) == 2);
+
+        sm.setMemoryBudget(1);
+        REQUIRE(!evictWithin(sm, std::chrono::milliseconds(600)));
+        REQUIRE(!s->isEvicted);
+
+        // Once they let go it is ours alone
+        other.reset();
+        REQUIRE(store.usersOf(s.get()) == 1);
+        REQUIRE(evictWithin(sm, std::chrono::seconds(10)));
+        REQUIRE(s->isEvicted);
+    }
+
+    fs::remove(path);
+}
@@ -0,0 +1,108 @@
+/*
+ * Shortcircuit XT - a Surge Synth Team product
+ *
+ * A fully featured creative sampler, available as a standalone
+ * and plugin for multiple platforms.
+ *
+ * Copyright 2019 - 2024, Various authors, as described in the github
+ * transaction log.
+ *
+ * ShortcircuitXT is released under the Gnu General Public Licence
+ * V3 or later (GPL-3.0-or-later). The license is found in the file
+ * "LICENSE" in the root of this repository or at
+ * https://www.gnu.org/licenses/gpl-3.0.en.html
+ *
+ * Individual sections of code which comprises ShortcircuitXT in this
+ * repository may also be used under an MIT license. Please see the
+ * section  "Licensing" in "README.md" for details.
+ *
+ * ShortcircuitXT is inspired by, and shares code with, the
+ * commercial product Shortcircuit 1 and 2, released by VemberTech
+ * in the mid 2000s. The code for Shortcircuit 2 was opensourced in
+ * 2020 at the outset of this project.
+ *
+ * All source for ShortcircuitXT is available at
+ * https://github.com/surge-synthesizer/shortcircuit-xt
+ */
+
+#ifndef SCXT_TESTS_TEST_WAV_WRITER_H
+#define SCXT_TESTS_TEST_WAV_WRITER_H
+
+#include <cstdint>
+#include <cstdio>
+#include <functional>
+#include <vector>
+
+#include "filesystem/import.h"
+
+namespace scxt::tests
+{
+/*
+ * Write an integer PCM WAV file to path for the sample tests. value(frame, channel) gives
+ * each sample as a full scale int32, which we cut down to bitsPerSample. If loopStart is
+ * non-negative we add a smpl chunk with one forward loop over [loopStart, loopEnd].
+ */
+inline bool writeTestWav(const fs::path &path, int channels, int bitsPerSample,
+                         uint32_t frameCount, const std::function<int32_t(uint32_t, int)> &value,
+                         int32_t loopStart = -1, int32_t loopEnd = -1)
+{
+    std::vector<uint8_t> d;
+    auto put = [&d](uint32_t v, int bytes) {
+        for (int i = 0; i < bytes; ++i)
+            d.push_back((v >> (8 * i)) & 0xFF);
+    };
+    auto tag = [&d](const char *t) { d.insert(d.end(), t, t + 4); };
+
+    auto bytes = bitsPerSample / 8;
+    auto dataBytes = frameCount * channels * bytes;
+    auto smplBytes = loopStart >= 0 ? 36 + 24 : 0;
+
+    tag("RIFF");
+    put(4 + 8 + 16 + 8 + dataBytes + (smplBytes ? 8 + smplBytes : 0), 4);
+    tag("WAVE");
+
+    tag("fmt ");
+    put(16, 4);
+    put(1, 2); // WAVE_FORMAT_PCM
+    put(channels, 2);
+    put(48000, 4);
+    put(48000 * channels * bytes, 4);
+    put(channels * bytes, 2);
+    put(bitsPerSample, 2);
+
+    tag("data");
+    put(dataBytes, 4);
+    for (uint32_t f = 0; f < frameCount; ++f)
+        for (int c = 0; c < channels; ++c)
+            put((uint32_t)value(f, c) >> (32 - bitsPerSample), bytes);
+
+    if (smplBytes)
+    {
+        tag("smpl");
+        put(smplBytes, 4);
+        for (int i = 0; i < 3; ++i)
+            put(0, 4);
+        put(60, 4); // unity note
+        for (int i = 0; i < 3; ++i)
+            put(0, 4);
+        put(1, 4); // one loop
+        put(0, 4);
+
+        put(0, 4); // identifier
+        put(0, 4); // forward
+        put(loopStart, 4);
+        put(loopEnd, 4);
+        put(0, 4);
+        put(0, 4);
+    }
+
+    auto *f = fopen(path.u8string().c_str(), "wb");
+    if (!f)
+        return false;
+    auto written = fwrite(d.data(), 1, d.size(), f);
+    fclose(f);
+    return written == d.size();
+}
+} // namespace scxt::tests
+
+#endif // SCXT_TESTS_TEST_WAV_WRITER_H
@@ -0,0 +1,94 @@
+/*
+ * Shortcircuit XT - a Surge Synth Team product
+ *
+ * A fully featured creative sampler, available as a standalone
+ * and plugin for multiple platforms.
+ *
+ * Copyright 2019 - 2024, Various authors, as described in the github
+ * transaction log.
+ *
+ * ShortcircuitXT is released under the Gnu General Public Licence
+ * V3 or later (GPL-3.0-or-later). The license is found in the file
+ * "LICENSE" in the root of this repository or at
+ * https://www.gnu.org/licenses/gpl-3.0.en.html
+ *
+ * Individual sections of code which comprises ShortcircuitXT in this
+ * repository may also be used under an MIT license. Please see the
+ * section  "Licensing" in "README.md" for details.
+ *
+ * ShortcircuitXT is inspired by, and shares code with, the
+ * commercial product Shortcircuit 1 and 2, released by VemberTech
+ * in the mid 2000s. The code for Shortcircuit 2 was opensourced in
+ * 2020 at the outset of this project.
+ *
+ * All source for ShortcircuitXT is available at
+ * https://github.com/surge-synthesizer/shortcircuit-xt
+ */
+
+#include "catch2/catch2.hpp"
+#include "engine/engine.h"
+#include "messaging/messaging.h"
+#include "sst/voicemanager/midi1_to_voicemanager.h"
+#include "test_wav_writer.h"
+
+#include <cmath>
+
+using namespace scxt;
+
+TEST_CASE("Silence Retirement Waits For The Sample", "[voice]")
+{
+    static constexpr double sr{48000};
+    // Loud, then a gap far longer than the silence hold, then loud again
+    static constexpr uint32_t gapStart{4800}, gapEnd{24000}, frames{36000};
+    auto path = fs::temp_directory_path() / "scxt-test-silence-gap.wav";
+    REQUIRE(tests::writeTestWav(path, 1, 16, frames, [](uint32_t f, int) {
+        if (f >= gapStart && f < gapEnd)
+            return (int32_t)0;
+        return (int32_t)(std::sin(f * 0.05) * 0.5 * INT32_MAX);
+    }));
+
+    auto engine = std::make_unique<engine::Engine>();
+    engine->prepareToPlay(sr);
+    engine->setVoiceSilenceThresholdDb(-90.f);
+
+    // Load as the serialization thread, like scxt-render does
+    auto &cont = engine->getMessageController();
+    cont->stop();
+    cont->threadingChecker.registerAsSerialThread();
+    engine->loadSampleIntoSelectedPartAndGroup(path, 60, {0, 127}, {0, 127});
+    cont->start();
+    cont->threadingChecker.registerAsAudioThread();
+
+    const auto &zone = engine->getPatch()->getPart(0)->getGroup(0)->getZone(0);
+    REQUIRE(zone);
+    // A one shot keeps its AEG open until the sample ends, however early the key lifts
+    zone->variantData.variants[0].playMode = engine::Zone::ONE_SHOT;
+
+    const auto &mainBus = engine->getPatch()->busses.mainBus;
+    auto runTo = [&](uint32_t frame, uint32_t &at) {
+        double energy{0};
+        for (; at < frame; at += blockSize)
+        {
+            engine->processAudio();
+            for (int i = 0; i < blockSize; ++i)
+                energy += mainBus.output[0][i] * mainBus.output[0][i];
+        }
+        return energy;
+    };
+
+    uint32_t at{0};
+    uint8_t noteOn[3]{0x90, 60, 100}, noteOff[3]{0x80, 60, 0};
+    sst::voicemanager::applyMidi1Message(engine->voiceManager, 0, noteOn);
+    REQUIRE(runTo(gapStart / 2, at) > 0);
+
+    // Let go in the middle of the gap and wait well past the silence hold
+    runTo((gapStart + gapEnd) / 2, at);
+    sst::voicemanager::applyMidi1Message(engine->voiceManager, 0, noteOff);
+    REQUIRE(runTo(gapEnd - 1000, at) < 1e-8);
+    REQUIRE(engine->activeVoices == 1);
+
+    // The material after the gap still plays
+    REQUIRE(runTo(gapEnd + 4000, at) > 0);
+
+    fs::remove(path);
+}